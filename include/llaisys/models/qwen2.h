@@ -29,6 +29,73 @@ __C {
         llaisysTensor_t *mlp_down_w;
     };
 
+    // Physical layout of each layer's K/V cache.
+    typedef enum {
+        LLAISYS_KV_LAYOUT_TOKEN_MAJOR = 0, // [maxseq, nkvh, dh]
+        LLAISYS_KV_LAYOUT_HEAD_MAJOR = 1,  // [nkvh, maxseq, dh], one contiguous stream per head
+    } llaisysKVCacheLayout_t;
+
+    // NUMA placement of the weights (CPU).
+    typedef enum {
+        LLAISYS_NUMA_LOCAL = 0,      // all on the model device's node
+        LLAISYS_NUMA_INTERLEAVE = 1, // pages round-robin over all nodes
+        LLAISYS_NUMA_PARTITION = 2,  // projection rows split into one block per node, matching
+                                     // the threads llaisysCpuPinThreads puts there; rest interleaved
+    } llaisysNumaPlacement_t;
+
+    // How llaisysQwen2ModelLoadSafetensors pages the mapped files in.
+    typedef enum {
+        LLAISYS_WEIGHT_PREFETCH_NONE = 0,     // on first touch
+        LLAISYS_WEIGHT_PREFETCH_ASYNC = 1,    // readahead started in the background (MADV_WILLNEED)
+        LLAISYS_WEIGHT_PREFETCH_POPULATE = 2, // all read in before the call returns (MADV_POPULATE_READ)
+    } llaisysWeightPrefetch_t;
+
+    struct LlaisysWeightLoadStats {
+        uint64_t mapped;       // weights bound to the file mapping without a copy
+        uint64_t copied;       // weights copied (dtype conversion, misaligned data, or a non-CPU device)
+        uint64_t mapped_bytes;
+        uint64_t copied_bytes;
+        double load_ms;
+    };
+
+    // Latency/volume counters of the KV swap tier.
+    struct LlaisysKVSwapStats {
+        uint64_t swap_out_count;
+        uint64_t swap_in_count;
+        uint64_t swap_out_bytes;
+        uint64_t swap_in_bytes;
+        double last_swap_out_ms;
+        double last_swap_in_ms;
+        double total_swap_out_ms;
+        double total_swap_in_ms;
+    };
+
+    // Decode-step graph counters (see llaisysQwen2ModelSetDecodeGraph).
+    struct LlaisysDecodeGraphStats {
+        uint64_t captures; // single-token steps run eagerly while recording
+        uint64_t replays;  // single-token steps replayed from the recording
+        uint64_t nodes;    // kernel calls in the current recording
+        uint64_t depth;    // calls on its longest dependency chain; the rest can overlap on the thread pool
+    };
+
+    // Activation workspace plan (see llaisysQwen2ModelReserveWorkspace).
+    struct LlaisysWorkspaceStats {
+        uint64_t tokens;          // longest call the plan covers (0: not planned yet)
+        uint64_t bytes;           // arena size
+        uint64_t unplanned_bytes; // sum of the buffer sizes, i.e. the arena without any sharing
+    };
+
+    // Token sampling, applied in this order: penalties over the tokens fed so far, temperature,
+    // top-k, top-p, then a draw from the renormalized survivors.
+    struct LlaisysSamplingParams {
+        float temperature;        // <= 0: greedy (argmax after penalties)
+        int64_t top_k;            // <= 0: keep the whole vocabulary
+        float top_p;              // >= 1: disabled
+        float repetition_penalty; // 1: disabled; positive logits are divided by it, negative ones multiplied
+        float frequency_penalty;  // 0: disabled; subtracted once per occurrence
+        float presence_penalty;   // 0: disabled; subtracted once per distinct token
+    };
+
     struct LlaisysQwen2Model;
 
     __export struct LlaisysQwen2Model *llaisysQwen2ModelCreate(const LlaisysQwen2Meta *meta, llaisysDeviceType_t device, int *device_ids, int ndevice);
@@ -37,6 +104,98 @@ __C {
 
     __export struct LlaisysQwen2Weights *llaisysQwen2ModelWeights(struct LlaisysQwen2Model * model);
 
+    // For checkpoints with tie_word_embeddings: out_embed shares in_embed's storage and its own
+    // [voc, di] buffer is released. Loading either weight afterwards writes the shared storage.
+    __export void llaisysQwen2ModelTieEmbeddings(struct LlaisysQwen2Model * model);
+
+    // Loads the weights from .safetensors files (Hugging Face Qwen2 tensor names; others are
+    // ignored). On CPU, weights stored in the model dtype are bound to a read-only mapping of
+    // the file instead of being copied, so they cost no memory beyond the page cache (and
+    // cannot be written with tensorLoad afterwards); F32/F16/BF16 weights of another dtype
+    // are converted into the model's buffers. With tied embeddings (call
+    // llaisysQwen2ModelTieEmbeddings first) lm_head.weight is optional and ignored. `stats`
+    // (may be NULL) is filled on success. Returns 0, or -1 (with a message on stderr) if a
+    // file cannot be read or parsed, or a model weight is missing or does not fit the model
+    // in shape or dtype. These checks all run before any weight changes, so a checkpoint
+    // failing them leaves the model as it was.
+    __export int llaisysQwen2ModelLoadSafetensors(struct LlaisysQwen2Model * model, const char *const *paths, size_t npath, llaisysWeightPrefetch_t prefetch, struct LlaisysWeightLoadStats *stats);
+
+    // CPU only: mlocks all weight buffers so they are never swapped out. Call after loading (and
+    // tying); weights mapped by llaisysQwen2ModelLoadSafetensors are pinned in the page cache
+    // without being copied. Weights rebound by a later load stay locked, and the buffers they
+    // replace are unlocked. Returns 0 on success, -1 if the kernel refused some of it (see
+    // RLIMIT_MEMLOCK).
+    __export int llaisysQwen2ModelLockWeights(struct LlaisysQwen2Model * model);
+
+    // Migrates the weights to the given NUMA placement. A no-op on single-node hosts.
+    __export void llaisysQwen2ModelPlaceWeights(struct LlaisysQwen2Model * model, llaisysNumaPlacement_t placement);
+
+    // Re-allocates the KV cache in the given layout. Cached positions are discarded.
+    __export void llaisysQwen2ModelSetKVCacheLayout(struct LlaisysQwen2Model * model, llaisysKVCacheLayout_t layout);
+
+    // Keeps the residual stream and norm outputs in `dtype` (the model dtype, or LLAISYS_DTYPE_F32
+    // for full-precision residuals over half-precision weights). Takes effect on the next infer.
+    __export void llaisysQwen2ModelSetResidualDtype(struct LlaisysQwen2Model * model, llaisysDataType_t dtype);
+
+    // Plans the per-step activation workspace for calls of up to `ntoken` tokens (clamped to
+    // maxseq). Inference grows it on demand, so this only moves the allocation out of the
+    // first long prefill; once reserved, decode steps allocate no device memory.
+    __export void llaisysQwen2ModelReserveWorkspace(struct LlaisysQwen2Model * model, size_t ntoken);
+
+    __export void llaisysQwen2ModelWorkspaceStats(struct LlaisysQwen2Model * model, struct LlaisysWorkspaceStats * stats);
+
+    // CPU: single-token infer calls record their kernel sequence once (with checks and dispatch
+    // resolved) and replay it on later positions, skipping per-op validation. Prefill and other
+    // multi-token calls always run eagerly. Enabled by default; changing the enable state, KV
+    // layout, residual dtype, workspace or tied embeddings drops the recording.
+    __export void llaisysQwen2ModelSetDecodeGraph(struct LlaisysQwen2Model * model, uint8_t enable);
+
+    __export void llaisysQwen2ModelDecodeGraphStats(struct LlaisysQwen2Model * model, struct LlaisysDecodeGraphStats * stats);
+
+    // Writes the first `npos` cached positions of every layer to an mmap-backed file at `path`
+    // and releases the in-memory KV cache.
+    __export void llaisysQwen2ModelKVSwapOut(struct LlaisysQwen2Model * model, const char *path, size_t npos);
+
+    // Starts restoring a swapped-out KV cache in the background. The next infer waits for it,
+    // and swaps in synchronously if this was never called. The swap file is removed afterwards.
+    __export void llaisysQwen2ModelKVSwapIn(struct LlaisysQwen2Model * model);
+
+    __export void llaisysQwen2ModelKVSwapStats(struct LlaisysQwen2Model * model, struct LlaisysKVSwapStats * stats);
+
+    // Saves the first `pos` cached positions of every layer, plus the model metadata, to `path`.
+    __export void llaisysQwen2ModelSaveSession(struct LlaisysQwen2Model * model, const char *path, size_t pos);
+
+    // Restores a snapshot written by llaisysQwen2ModelSaveSession. Returns the number of cached
+    // positions (the `pos` to continue from), or -1 if the file cannot be read or is not a valid
+    // snapshot for this model's LlaisysQwen2Meta.
+    __export int64_t llaisysQwen2ModelLoadSession(struct LlaisysQwen2Model * model, const char *path);
+
     __export int64_t llaisysQwen2ModelInfer(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t pos);
+
+    // Seeds the model's sampling RNG; a fresh model is seeded non-deterministically.
+    __export void llaisysQwen2ModelSetSamplingSeed(struct LlaisysQwen2Model * model, uint64_t seed);
+
+    // Like llaisysQwen2ModelInfer, but draws the next token with `params` (NULL: argmax).
+    // Penalties cover every token fed at positions [0, pos + ntoken) through this model.
+    __export int64_t llaisysQwen2ModelInferSampled(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t pos, const struct LlaisysSamplingParams *params);
+
+    // A session is one conversation over the model's weights: its own KV cache, token history,
+    // sampler, activation workspace and decode graph. The weights are shared and only read, so
+    // different sessions may run inference concurrently on different threads; a single session
+    // must not be used by two threads at once. The llaisysQwen2Model* calls above drive the
+    // model's built-in default session.
+    struct LlaisysQwen2Session;
+
+    // Starts with the default session's KV layout, residual dtype and decode-graph setting.
+    // Finish loading and tying the weights first; destroy every session before the model.
+    __export struct LlaisysQwen2Session *llaisysQwen2SessionCreate(struct LlaisysQwen2Model * model);
+
+    __export void llaisysQwen2SessionDestroy(struct LlaisysQwen2Session * session);
+
+    __export int64_t llaisysQwen2SessionInfer(struct LlaisysQwen2Session * session, int64_t * token_ids, size_t ntoken, size_t pos);
+
+    __export int64_t llaisysQwen2SessionInferSampled(struct LlaisysQwen2Session * session, int64_t * token_ids, size_t ntoken, size_t pos, const struct LlaisysSamplingParams *params);
+
+    __export void llaisysQwen2SessionSetSamplingSeed(struct LlaisysQwen2Session * session, uint64_t seed);
 }
 #endif // LLAISYS_MODELS_QWEN2_H
\ No newline at end of file
@@ -5,12 +5,18 @@
 
 __C {
     __export void llaisysAdd(llaisysTensor_t c, llaisysTensor_t a, llaisysTensor_t b);
+    __export void llaisysAddRmsNorm(llaisysTensor_t out, llaisysTensor_t res_out, llaisysTensor_t a, llaisysTensor_t b, llaisysTensor_t weight, float eps);
     __export void llaisysArgmax(llaisysTensor_t max_idx, llaisysTensor_t max_val, llaisysTensor_t vals);
+    __export void llaisysCast(llaisysTensor_t out, llaisysTensor_t in);
     __export void llaisysEmbedding(llaisysTensor_t out, llaisysTensor_t index, llaisysTensor_t weight);
     __export void llaisysLinear(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, llaisysTensor_t bias);
+    __export void llaisysLmHeadTopK(llaisysTensor_t out_idx, llaisysTensor_t out_val, llaisysTensor_t lse, llaisysTensor_t hidden, llaisysTensor_t weight);
     __export void llaisysRearrange(llaisysTensor_t out, llaisysTensor_t in);
     __export void llaisysRmsNorm(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, float eps);
     __export void llaisysROPE(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, float theta);
+    // RoPE from precomputed F32 cos/sin tables ([npos, d / 2]) filled by llaisysROPETable
+    __export void llaisysROPECached(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, llaisysTensor_t cos_table, llaisysTensor_t sin_table);
+    __export void llaisysROPETable(llaisysTensor_t cos_table, llaisysTensor_t sin_table, float theta);
     __export void llaisysSelfAttention(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v, float scale);
     __export void llaisysSwiGLU(llaisysTensor_t out, llaisysTensor_t gate, llaisysTensor_t up);
 }
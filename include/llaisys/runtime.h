@@ -21,6 +21,15 @@ __C {
     // Memory copy
     typedef void (*memcpy_sync_api)(void *, const void *, size_t, llaisysMemcpyKind_t);
     typedef void (*memcpy_async_api)(void *, const void *, size_t, llaisysMemcpyKind_t, llaisysStream_t);
+    // Event: marks the work enqueued on a stream so far
+    typedef llaisysEvent_t (*create_event_api)();
+    typedef void (*destroy_event_api)(llaisysEvent_t);
+    typedef void (*event_record_api)(llaisysEvent_t, llaisysStream_t);
+    typedef void (*event_synchronize_api)(llaisysEvent_t);
+    typedef uint8_t (*event_query_api)(llaisysEvent_t);
+    typedef void (*stream_wait_event_api)(llaisysStream_t, llaisysEvent_t);
+    // Runs fn(arg) on the stream, in order with its other work
+    typedef void (*launch_host_func_api)(llaisysStream_t, void (*)(void *), void *);
 
     struct LlaisysRuntimeAPI {
         get_device_count_api get_device_count;
@@ -35,13 +44,84 @@ __C {
         free_host_api free_host;
         memcpy_sync_api memcpy_sync;
         memcpy_async_api memcpy_async;
+        create_event_api create_event;
+        destroy_event_api destroy_event;
+        event_record_api event_record;
+        event_synchronize_api event_synchronize;
+        event_query_api event_query;
+        stream_wait_event_api stream_wait_event;
+        launch_host_func_api launch_host_func;
     };
 
+    // Device memory allocator counters. Sizes are after rounding to the allocation granularity.
+    struct LlaisysAllocatorStats {
+        uint64_t hits;              // allocations served from cached memory
+        uint64_t misses;            // allocations that reserved a new segment from the device
+        uint64_t bytes_reserved;    // held from the device, cached or in use
+        uint64_t bytes_in_use;      // handed out to live storages
+        uint64_t peak_bytes_in_use;
+        uint64_t segments;          // device allocations currently held
+    };
+
+    // Host memory of the CPU runtime. Buffers of 2 MB or more are mapped 2 MB aligned and
+    // backed by huge pages when the kernel allows it (hugetlbfs first, then transparent).
+    struct LlaisysCpuMemoryReport {
+        uint64_t mapped_bytes;    // large buffers currently mapped
+        uint64_t huge_page_bytes; // of those, backed by huge pages
+        uint64_t locked_bytes;    // process-wide mlocked memory (VmLck)
+    };
+
+    // A NUMA node of the host. CPU device ids index these nodes in order; large buffers
+    // allocated under device i are bound to node i.
+    struct LlaisysNumaNodeReport {
+        int32_t node;            // kernel node id
+        int32_t ncpu;            // CPUs this process may use on the node
+        uint64_t mem_total_bytes;
+        uint64_t resident_bytes; // pages of the runtime's large buffers placed on the node
+        double read_gbps;        // local sequential read bandwidth, 0 unless measured
+    };
+
+    // Where the CPU kernel threads may run.
+    typedef enum {
+        LLAISYS_THREAD_AFFINITY_NONE = 0, // left to the OS scheduler
+        LLAISYS_THREAD_AFFINITY_NUMA = 1, // node i runs threads [i * T / n, (i + 1) * T / n)
+        LLAISYS_THREAD_AFFINITY_CORE = 2, // thread t on the t-th allowed CPU
+    } llaisysThreadAffinity_t;
+
     // Llaisys API for getting the runtime APIs
     __export const LlaisysRuntimeAPI *llaisysGetRuntimeAPI(llaisysDeviceType_t);
 
     // Llaisys API for switching device context
     __export void llaisysSetContextRuntime(llaisysDeviceType_t, int);
+
+    // Llaisys API for the device allocator of a runtime (switches the context to it)
+    __export void llaisysAllocatorStats(llaisysDeviceType_t, int, struct LlaisysAllocatorStats *);
+    // Returns cached segments with nothing in use back to the device.
+    __export void llaisysAllocatorTrim(llaisysDeviceType_t, int);
+
+    __export void llaisysCpuMemoryReport(struct LlaisysCpuMemoryReport *);
+
+    // mlocks host memory; returns 0, or -1 if the kernel refuses (RLIMIT_MEMLOCK). Locks nest:
+    // a page stays locked until every lock covering it has been matched by an unlock.
+    __export int llaisysCpuLockMemory(const void *ptr, size_t size);
+    __export void llaisysCpuUnlockMemory(const void *ptr, size_t size);
+
+    // Fills up to `n` entries and returns the node count. Measuring bandwidth streams a
+    // 256 MB buffer on every node and takes a moment.
+    __export size_t llaisysCpuNumaReport(struct LlaisysNumaNodeReport *reports, size_t n, uint8_t measure_bandwidth);
+
+    // CPU kernels share one process-wide work-stealing pool. Its defaults come from the
+    // LLAISYS_NUM_THREADS and LLAISYS_THREAD_AFFINITY (none | numa | core) environment
+    // variables. This restarts it with `nthreads` threads, the calling thread included
+    // (0: the default), pinning the caller as thread 0 under an affinity. Not while kernels run.
+    __export void llaisysSetThreadPool(size_t nthreads, llaisysThreadAffinity_t affinity);
+
+    __export size_t llaisysGetNumThreads(void);
+
+    // Pins the CPU worker threads node by node, so each runs next to the weight rows that
+    // LLAISYS_NUMA_PARTITION placed for it. Same as LLAISYS_THREAD_AFFINITY_NUMA at the
+    // current thread count.
+    __export void llaisysCpuPinThreads(void);
 }
 
 #endif // LLAISYS_RUNTIME_H
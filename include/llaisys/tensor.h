@@ -49,6 +49,12 @@ __C {
         llaisysTensor_t tensor,
         const void *data);
 
+    // Loads host data stored as `dtype`, converting it to the tensor's dtype (F32/F16/BF16).
+    __export void tensorLoadAs(
+        llaisysTensor_t tensor,
+        const void *data,
+        llaisysDataType_t dtype);
+
     __export llaisysTensor_t tensorView(
         llaisysTensor_t tensor,
         size_t * shape,
@@ -63,6 +69,22 @@ __C {
         size_t dim,
         size_t start,
         size_t end);
+
+    // Returns the tensor itself (a view) when already contiguous, otherwise a contiguous copy.
+    __export llaisysTensor_t tensorContiguous(
+        llaisysTensor_t tensor);
+
+    // Returns a view when the new shape can share the storage, otherwise a contiguous copy.
+    __export llaisysTensor_t tensorReshape(
+        llaisysTensor_t tensor,
+        size_t * shape,
+        size_t ndim);
+
+    // Copies the tensor to another device. A negative device id means the default one.
+    __export llaisysTensor_t tensorTo(
+        llaisysTensor_t tensor,
+        llaisysDeviceType_t device_type,
+        int device_id);
 }
 
 #endif // LLAISYS_TENSOR_H
@@ -5,14 +5,18 @@ from pathlib import Path
 
 from .runtime import load_runtime
 from .runtime import LlaisysRuntimeAPI
+from .runtime import LlaisysAllocatorStats
+from .runtime import LlaisysCpuMemoryReport
+from .runtime import LlaisysNumaNodeReport
 from .llaisys_types import llaisysDeviceType_t, DeviceType
 from .llaisys_types import llaisysDataType_t, DataType
 from .llaisys_types import llaisysMemcpyKind_t, MemcpyKind
-from .llaisys_types import llaisysStream_t
+from .llaisys_types import llaisysStream_t, llaisysEvent_t
 from .tensor import llaisysTensor_t
 from .tensor import load_tensor
 from .ops import load_ops
-from .models import load_models, LlaisysQwen2Meta, LlaisysQwen2Weights
+from .models import load_models, LlaisysQwen2Meta, LlaisysQwen2Weights, LlaisysKVSwapStats, LlaisysDecodeGraphStats
+from .models import LlaisysSamplingParams, LlaisysWeightLoadStats
 
 def load_shared_library():
     lib_dir = Path(__file__).parent
@@ -43,7 +47,11 @@ load_models(LIB_LLAISYS)
 __all__ = [
     "LIB_LLAISYS",
     "LlaisysRuntimeAPI",
+    "LlaisysAllocatorStats",
+    "LlaisysCpuMemoryReport",
+    "LlaisysNumaNodeReport",
     "llaisysStream_t",
+    "llaisysEvent_t",
     "llaisysTensor_t",
     "llaisysDataType_t",
     "DataType",
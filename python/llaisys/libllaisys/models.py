@@ -39,7 +39,73 @@ class LlaisysQwen2Weights(ctypes.Structure):
         ("mlp_down_w", ctypes.POINTER(llaisysTensor_t)),
     ]
 
+# 2.1 KV swap tier counters
+class LlaisysKVSwapStats(ctypes.Structure):
+    _fields_ = [
+        ("swap_out_count", ctypes.c_uint64),
+        ("swap_in_count", ctypes.c_uint64),
+        ("swap_out_bytes", ctypes.c_uint64),
+        ("swap_in_bytes", ctypes.c_uint64),
+        ("last_swap_out_ms", ctypes.c_double),
+        ("last_swap_in_ms", ctypes.c_double),
+        ("total_swap_out_ms", ctypes.c_double),
+        ("total_swap_in_ms", ctypes.c_double),
+    ]
+
+# 2.2 Decode-step graph counters
+class LlaisysDecodeGraphStats(ctypes.Structure):
+    _fields_ = [
+        ("captures", ctypes.c_uint64),
+        ("replays", ctypes.c_uint64),
+        ("nodes", ctypes.c_uint64),
+        ("depth", ctypes.c_uint64),
+    ]
+
+# 2.2.1 Activation workspace plan
+class LlaisysWorkspaceStats(ctypes.Structure):
+    _fields_ = [
+        ("tokens", ctypes.c_uint64),
+        ("bytes", ctypes.c_uint64),
+        ("unplanned_bytes", ctypes.c_uint64),
+    ]
+
+# 2.3 Weight loading counters
+class LlaisysWeightLoadStats(ctypes.Structure):
+    _fields_ = [
+        ("mapped", ctypes.c_uint64),
+        ("copied", ctypes.c_uint64),
+        ("mapped_bytes", ctypes.c_uint64),
+        ("copied_bytes", ctypes.c_uint64),
+        ("load_ms", ctypes.c_double),
+    ]
+
+# 2.4 Sampling parameters
+class LlaisysSamplingParams(ctypes.Structure):
+    _fields_ = [
+        ("temperature", ctypes.c_float),
+        ("top_k", ctypes.c_int64),
+        ("top_p", ctypes.c_float),
+        ("repetition_penalty", ctypes.c_float),
+        ("frequency_penalty", ctypes.c_float),
+        ("presence_penalty", ctypes.c_float),
+    ]
+
+# KV cache layouts (llaisysKVCacheLayout_t)
+KV_LAYOUT_TOKEN_MAJOR = 0
+KV_LAYOUT_HEAD_MAJOR = 1
+
+# NUMA weight placements (llaisysNumaPlacement_t)
+NUMA_LOCAL = 0
+NUMA_INTERLEAVE = 1
+NUMA_PARTITION = 2
+
+# Weight file prefetch modes (llaisysWeightPrefetch_t)
+WEIGHT_PREFETCH_NONE = 0
+WEIGHT_PREFETCH_ASYNC = 1
+WEIGHT_PREFETCH_POPULATE = 2
+
 llaisysQwen2Model_t = ctypes.c_void_p
+llaisysQwen2Session_t = ctypes.c_void_p
 
 # 3. 注册函数签名的加载函数
 def load_models(lib):
@@ -61,6 +127,72 @@ def load_models(lib):
         # 关键修复：指定返回类型为指针，而不是默认的 int
         lib.llaisysQwen2ModelWeights.restype = ctypes.POINTER(LlaisysQwen2Weights)
 
+    if hasattr(lib, 'llaisysQwen2ModelTieEmbeddings'):
+        lib.llaisysQwen2ModelTieEmbeddings.argtypes = [llaisysQwen2Model_t]
+        lib.llaisysQwen2ModelTieEmbeddings.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelLoadSafetensors'):
+        lib.llaisysQwen2ModelLoadSafetensors.argtypes = [
+            llaisysQwen2Model_t,
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_size_t,
+            ctypes.c_int,
+            ctypes.POINTER(LlaisysWeightLoadStats),
+        ]
+        lib.llaisysQwen2ModelLoadSafetensors.restype = ctypes.c_int
+
+    if hasattr(lib, 'llaisysQwen2ModelLockWeights'):
+        lib.llaisysQwen2ModelLockWeights.argtypes = [llaisysQwen2Model_t]
+        lib.llaisysQwen2ModelLockWeights.restype = ctypes.c_int
+
+    if hasattr(lib, 'llaisysQwen2ModelPlaceWeights'):
+        lib.llaisysQwen2ModelPlaceWeights.argtypes = [llaisysQwen2Model_t, ctypes.c_int]
+        lib.llaisysQwen2ModelPlaceWeights.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelSetKVCacheLayout'):
+        lib.llaisysQwen2ModelSetKVCacheLayout.argtypes = [llaisysQwen2Model_t, ctypes.c_int]
+        lib.llaisysQwen2ModelSetKVCacheLayout.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelSetResidualDtype'):
+        lib.llaisysQwen2ModelSetResidualDtype.argtypes = [llaisysQwen2Model_t, llaisysDataType_t]
+        lib.llaisysQwen2ModelSetResidualDtype.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelReserveWorkspace'):
+        lib.llaisysQwen2ModelReserveWorkspace.argtypes = [llaisysQwen2Model_t, ctypes.c_size_t]
+        lib.llaisysQwen2ModelReserveWorkspace.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelWorkspaceStats'):
+        lib.llaisysQwen2ModelWorkspaceStats.argtypes = [llaisysQwen2Model_t, ctypes.POINTER(LlaisysWorkspaceStats)]
+        lib.llaisysQwen2ModelWorkspaceStats.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelKVSwapOut'):
+        lib.llaisysQwen2ModelKVSwapOut.argtypes = [llaisysQwen2Model_t, ctypes.c_char_p, ctypes.c_size_t]
+        lib.llaisysQwen2ModelKVSwapOut.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelKVSwapIn'):
+        lib.llaisysQwen2ModelKVSwapIn.argtypes = [llaisysQwen2Model_t]
+        lib.llaisysQwen2ModelKVSwapIn.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelSetDecodeGraph'):
+        lib.llaisysQwen2ModelSetDecodeGraph.argtypes = [llaisysQwen2Model_t, ctypes.c_uint8]
+        lib.llaisysQwen2ModelSetDecodeGraph.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelDecodeGraphStats'):
+        lib.llaisysQwen2ModelDecodeGraphStats.argtypes = [llaisysQwen2Model_t, ctypes.POINTER(LlaisysDecodeGraphStats)]
+        lib.llaisysQwen2ModelDecodeGraphStats.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelKVSwapStats'):
+        lib.llaisysQwen2ModelKVSwapStats.argtypes = [llaisysQwen2Model_t, ctypes.POINTER(LlaisysKVSwapStats)]
+        lib.llaisysQwen2ModelKVSwapStats.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelSaveSession'):
+        lib.llaisysQwen2ModelSaveSession.argtypes = [llaisysQwen2Model_t, ctypes.c_char_p, ctypes.c_size_t]
+        lib.llaisysQwen2ModelSaveSession.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelLoadSession'):
+        lib.llaisysQwen2ModelLoadSession.argtypes = [llaisysQwen2Model_t, ctypes.c_char_p]
+        lib.llaisysQwen2ModelLoadSession.restype = ctypes.c_int64
+
     if hasattr(lib, 'llaisysQwen2ModelInfer'):
         lib.llaisysQwen2ModelInfer.argtypes = [
             llaisysQwen2Model_t, 
@@ -68,4 +200,49 @@ def load_models(lib):
             ctypes.c_size_t, 
             ctypes.c_size_t # pos 参数
         ]
-        lib.llaisysQwen2ModelInfer.restype = ctypes.c_int64
\ No newline at end of file
+        lib.llaisysQwen2ModelInfer.restype = ctypes.c_int64
+
+    if hasattr(lib, 'llaisysQwen2ModelSetSamplingSeed'):
+        lib.llaisysQwen2ModelSetSamplingSeed.argtypes = [llaisysQwen2Model_t, ctypes.c_uint64]
+        lib.llaisysQwen2ModelSetSamplingSeed.restype = None
+
+    if hasattr(lib, 'llaisysQwen2ModelInferSampled'):
+        lib.llaisysQwen2ModelInferSampled.argtypes = [
+            llaisysQwen2Model_t,
+            ctypes.POINTER(ctypes.c_int64),
+            ctypes.c_size_t,
+            ctypes.c_size_t,
+            ctypes.POINTER(LlaisysSamplingParams),
+        ]
+        lib.llaisysQwen2ModelInferSampled.restype = ctypes.c_int64
+
+    if hasattr(lib, 'llaisysQwen2SessionCreate'):
+        lib.llaisysQwen2SessionCreate.argtypes = [llaisysQwen2Model_t]
+        lib.llaisysQwen2SessionCreate.restype = llaisysQwen2Session_t
+
+    if hasattr(lib, 'llaisysQwen2SessionDestroy'):
+        lib.llaisysQwen2SessionDestroy.argtypes = [llaisysQwen2Session_t]
+        lib.llaisysQwen2SessionDestroy.restype = None
+
+    if hasattr(lib, 'llaisysQwen2SessionInfer'):
+        lib.llaisysQwen2SessionInfer.argtypes = [
+            llaisysQwen2Session_t,
+            ctypes.POINTER(ctypes.c_int64),
+            ctypes.c_size_t,
+            ctypes.c_size_t,
+        ]
+        lib.llaisysQwen2SessionInfer.restype = ctypes.c_int64
+
+    if hasattr(lib, 'llaisysQwen2SessionInferSampled'):
+        lib.llaisysQwen2SessionInferSampled.argtypes = [
+            llaisysQwen2Session_t,
+            ctypes.POINTER(ctypes.c_int64),
+            ctypes.c_size_t,
+            ctypes.c_size_t,
+            ctypes.POINTER(LlaisysSamplingParams),
+        ]
+        lib.llaisysQwen2SessionInferSampled.restype = ctypes.c_int64
+
+    if hasattr(lib, 'llaisysQwen2SessionSetSamplingSeed'):
+        lib.llaisysQwen2SessionSetSamplingSeed.argtypes = [llaisysQwen2Session_t, ctypes.c_uint64]
+        lib.llaisysQwen2SessionSetSamplingSeed.restype = None
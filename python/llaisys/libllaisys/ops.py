@@ -5,15 +5,37 @@ def load_ops(lib):
     lib.llaisysAdd.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysAdd.restype = None
 
+    lib.llaisysAddRmsNorm.argtypes = [
+        llaisysTensor_t,  # out
+        llaisysTensor_t,  # res_out
+        llaisysTensor_t,  # a
+        llaisysTensor_t,  # b
+        llaisysTensor_t,  # weight
+        c_float    # eps
+    ]
+    lib.llaisysAddRmsNorm.restype = None
+
     lib.llaisysArgmax.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysArgmax.restype = None
 
+    lib.llaisysCast.argtypes = [llaisysTensor_t, llaisysTensor_t]
+    lib.llaisysCast.restype = None
+
     lib.llaisysEmbedding.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysEmbedding.restype = None
 
     lib.llaisysLinear.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysLinear.restype = None
 
+    lib.llaisysLmHeadTopK.argtypes = [
+        llaisysTensor_t,
+        llaisysTensor_t,
+        llaisysTensor_t,
+        llaisysTensor_t,
+        llaisysTensor_t,
+    ]
+    lib.llaisysLmHeadTopK.restype = None
+
     lib.llaisysRearrange.argtypes = [llaisysTensor_t, llaisysTensor_t]
     lib.llaisysRearrange.restype = None
 
@@ -23,6 +45,18 @@ def load_ops(lib):
     lib.llaisysROPE.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, c_float]
     lib.llaisysROPE.restype = None
 
+    lib.llaisysROPECached.argtypes = [
+        llaisysTensor_t,  # out
+        llaisysTensor_t,  # in
+        llaisysTensor_t,  # pos_ids
+        llaisysTensor_t,  # cos_table
+        llaisysTensor_t,  # sin_table
+    ]
+    lib.llaisysROPECached.restype = None
+
+    lib.llaisysROPETable.argtypes = [llaisysTensor_t, llaisysTensor_t, c_float]
+    lib.llaisysROPETable.restype = None
+
     lib.llaisysSelfAttention.argtypes = [
         llaisysTensor_t,  # attn_val
         llaisysTensor_t,  # q
@@ -19,6 +19,15 @@ free_host_api = CFUNCTYPE(None, c_void_p)
 memcpy_sync_api = CFUNCTYPE(None, c_void_p, c_void_p, c_size_t, llaisysMemcpyKind_t)
 memcpy_async_api = CFUNCTYPE(None, c_void_p, c_void_p, c_size_t, llaisysMemcpyKind_t, llaisysStream_t)
 
+create_event_api = CFUNCTYPE(llaisysEvent_t)
+destroy_event_api = CFUNCTYPE(None, llaisysEvent_t)
+event_record_api = CFUNCTYPE(None, llaisysEvent_t, llaisysStream_t)
+event_synchronize_api = CFUNCTYPE(None, llaisysEvent_t)
+event_query_api = CFUNCTYPE(ctypes.c_uint8, llaisysEvent_t)
+stream_wait_event_api = CFUNCTYPE(None, llaisysStream_t, llaisysEvent_t)
+host_func_t = CFUNCTYPE(None, c_void_p)
+launch_host_func_api = CFUNCTYPE(None, llaisysStream_t, host_func_t, c_void_p)
+
 
 # Define the struct matching LlaisysRuntimeAPI
 class LlaisysRuntimeAPI(Structure):
@@ -35,9 +44,54 @@ class LlaisysRuntimeAPI(Structure):
         ("free_host", free_host_api),
         ("memcpy_sync", memcpy_sync_api),
         ("memcpy_async", memcpy_async_api),
+        ("create_event", create_event_api),
+        ("destroy_event", destroy_event_api),
+        ("event_record", event_record_api),
+        ("event_synchronize", event_synchronize_api),
+        ("event_query", event_query_api),
+        ("stream_wait_event", stream_wait_event_api),
+        ("launch_host_func", launch_host_func_api),
+    ]
+
+
+# Define the struct matching LlaisysAllocatorStats
+class LlaisysAllocatorStats(Structure):
+    _fields_ = [
+        ("hits", ctypes.c_uint64),
+        ("misses", ctypes.c_uint64),
+        ("bytes_reserved", ctypes.c_uint64),
+        ("bytes_in_use", ctypes.c_uint64),
+        ("peak_bytes_in_use", ctypes.c_uint64),
+        ("segments", ctypes.c_uint64),
+    ]
+
+
+# Define the struct matching LlaisysCpuMemoryReport
+class LlaisysCpuMemoryReport(Structure):
+    _fields_ = [
+        ("mapped_bytes", ctypes.c_uint64),
+        ("huge_page_bytes", ctypes.c_uint64),
+        ("locked_bytes", ctypes.c_uint64),
+    ]
+
+
+# Define the struct matching LlaisysNumaNodeReport
+class LlaisysNumaNodeReport(Structure):
+    _fields_ = [
+        ("node", ctypes.c_int32),
+        ("ncpu", ctypes.c_int32),
+        ("mem_total_bytes", ctypes.c_uint64),
+        ("resident_bytes", ctypes.c_uint64),
+        ("read_gbps", ctypes.c_double),
     ]
 
 
+# CPU thread affinities (llaisysThreadAffinity_t)
+THREAD_AFFINITY_NONE = 0
+THREAD_AFFINITY_NUMA = 1
+THREAD_AFFINITY_CORE = 2
+
+
 # Load shared library
 def load_runtime(lib):
     # Declare API function prototypes
@@ -46,3 +100,30 @@ def load_runtime(lib):
 
     lib.llaisysSetContextRuntime.argtypes = [llaisysDeviceType_t, c_int]
     lib.llaisysSetContextRuntime.restype = None
+
+    lib.llaisysAllocatorStats.argtypes = [llaisysDeviceType_t, c_int, ctypes.POINTER(LlaisysAllocatorStats)]
+    lib.llaisysAllocatorStats.restype = None
+
+    lib.llaisysAllocatorTrim.argtypes = [llaisysDeviceType_t, c_int]
+    lib.llaisysAllocatorTrim.restype = None
+
+    lib.llaisysCpuMemoryReport.argtypes = [ctypes.POINTER(LlaisysCpuMemoryReport)]
+    lib.llaisysCpuMemoryReport.restype = None
+
+    lib.llaisysCpuLockMemory.argtypes = [c_void_p, c_size_t]
+    lib.llaisysCpuLockMemory.restype = c_int
+
+    lib.llaisysCpuUnlockMemory.argtypes = [c_void_p, c_size_t]
+    lib.llaisysCpuUnlockMemory.restype = None
+
+    lib.llaisysCpuNumaReport.argtypes = [ctypes.POINTER(LlaisysNumaNodeReport), ctypes.c_size_t, ctypes.c_uint8]
+    lib.llaisysCpuNumaReport.restype = ctypes.c_size_t
+
+    lib.llaisysSetThreadPool.argtypes = [c_size_t, c_int]
+    lib.llaisysSetThreadPool.restype = None
+
+    lib.llaisysGetNumThreads.argtypes = []
+    lib.llaisysGetNumThreads.restype = c_size_t
+
+    lib.llaisysCpuPinThreads.argtypes = []
+    lib.llaisysCpuPinThreads.restype = None
@@ -59,6 +59,10 @@ def load_tensor(lib):
     lib.tensorLoad.argtypes = [llaisysTensor_t, c_void_p]
     lib.tensorLoad.restype = None
 
+    # Function: tensorLoadAs
+    lib.tensorLoadAs.argtypes = [llaisysTensor_t, c_void_p, llaisysDataType_t]
+    lib.tensorLoadAs.restype = None
+
     # Function: tensorView(llaisysTensor_t tensor, size_t *shape);
     lib.tensorView.argtypes = [llaisysTensor_t, POINTER(c_size_t), c_size_t]
     lib.tensorView.restype = llaisysTensor_t
@@ -76,3 +80,15 @@ def load_tensor(lib):
         c_size_t,  # end  : exclusive
     ]
     lib.tensorSlice.restype = llaisysTensor_t
+
+    # Function: tensorContiguous(llaisysTensor_t tensor);
+    lib.tensorContiguous.argtypes = [llaisysTensor_t]
+    lib.tensorContiguous.restype = llaisysTensor_t
+
+    # Function: tensorReshape(llaisysTensor_t tensor, size_t *shape, size_t ndim);
+    lib.tensorReshape.argtypes = [llaisysTensor_t, POINTER(c_size_t), c_size_t]
+    lib.tensorReshape.restype = llaisysTensor_t
+
+    # Function: tensorTo(llaisysTensor_t tensor, llaisysDeviceType_t device_type, int device_id);
+    lib.tensorTo.argtypes = [llaisysTensor_t, llaisysDeviceType_t, c_int]
+    lib.tensorTo.restype = llaisysTensor_t
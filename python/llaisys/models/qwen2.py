@@ -1,17 +1,27 @@
 from typing import Sequence
 from ..libllaisys import LIB_LLAISYS
 from ..libllaisys import DeviceType, DataType
-from ..libllaisys.models import LlaisysQwen2Meta, LlaisysQwen2Weights
-from ..tensor import Tensor
+from ..libllaisys.models import LlaisysQwen2Meta, LlaisysQwen2Weights, LlaisysKVSwapStats
+from ..libllaisys.models import LlaisysDecodeGraphStats, LlaisysWorkspaceStats
+from ..libllaisys.models import LlaisysSamplingParams, LlaisysWeightLoadStats
+from ..libllaisys.models import WEIGHT_PREFETCH_ASYNC
 import ctypes
 from pathlib import Path
-import safetensors
 import json
-import torch
+import struct
 import time
 
+
+def _safetensors_names(file):
+    """Tensor names in a .safetensors file, read from its JSON header alone."""
+    with open(file, "rb") as f:
+        (header_len,) = struct.unpack("<Q", f.read(8))
+        header = json.loads(f.read(header_len))
+    return [name for name in header if name != "__metadata__"]
+
+
 class Qwen2:
-    def __init__(self, model_path, device: DeviceType = DeviceType.CPU):
+    def __init__(self, model_path, device: DeviceType = DeviceType.CPU, prefetch: int = WEIGHT_PREFETCH_ASYNC):
         self.model_path = Path(model_path)
         self.device = device
         
@@ -46,55 +56,98 @@ class Qwen2:
         # 4. Get Weights Structure
         self._weights = LIB_LLAISYS.llaisysQwen2ModelWeights(self._model).contents
 
+        # Tied checkpoints (tie_word_embeddings, or no lm_head.weight at all) share one
+        # [voc, di] buffer between the input embedding and the LM head
+        files = sorted(self.model_path.glob("*.safetensors"))
+        has_lm_head = any("lm_head.weight" in _safetensors_names(file) for file in files)
+        self.tie_word_embeddings = config.get("tie_word_embeddings", False) or not has_lm_head
+        if self.tie_word_embeddings:
+            LIB_LLAISYS.llaisysQwen2ModelTieEmbeddings(self._model)
+
         # 5. Load Weights
         print("Loading weights...", flush=True)
-        self._load_weights()
-        print("Weights loaded.", flush=True)
-
-    def _load_weights(self):
-        for file in sorted(self.model_path.glob("*.safetensors")):
-            with safetensors.safe_open(file, framework="pt", device="cpu") as f:
-                for name in f.keys():
-                    data = f.get_tensor(name)
-                    self._load_tensor(name, data)
-
-    def _load_tensor(self, name, data):
-        tensor_ptr = None
-        
-        if "lm_head.weight" in name:
-            tensor_ptr = self._weights.out_embed
-        elif "model.embed_tokens.weight" in name:
-            tensor_ptr = self._weights.in_embed
-        elif "model.norm.weight" in name:
-            tensor_ptr = self._weights.out_norm_w
-        elif "layers" in name:
-            parts = name.split(".")
-            idx = int(parts[2])
-            
-            if "input_layernorm.weight" in name:
-                tensor_ptr = self._weights.attn_norm_w[idx]
-            elif "post_attention_layernorm.weight" in name:
-                tensor_ptr = self._weights.mlp_norm_w[idx]
-            elif "self_attn" in name:
-                if "q_proj.weight" in name: tensor_ptr = self._weights.attn_q_w[idx]
-                elif "q_proj.bias" in name: tensor_ptr = self._weights.attn_q_b[idx]
-                elif "k_proj.weight" in name: tensor_ptr = self._weights.attn_k_w[idx]
-                elif "k_proj.bias" in name: tensor_ptr = self._weights.attn_k_b[idx]
-                elif "v_proj.weight" in name: tensor_ptr = self._weights.attn_v_w[idx]
-                elif "v_proj.bias" in name: tensor_ptr = self._weights.attn_v_b[idx]
-                elif "o_proj.weight" in name: tensor_ptr = self._weights.attn_o_w[idx]
-            elif "mlp" in name:
-                if "gate_proj.weight" in name: tensor_ptr = self._weights.mlp_gate_w[idx]
-                elif "up_proj.weight" in name: tensor_ptr = self._weights.mlp_up_w[idx]
-                elif "down_proj.weight" in name: tensor_ptr = self._weights.mlp_down_w[idx]
-
-        if tensor_ptr:
-            t = Tensor(tensor=tensor_ptr)
-            if not data.is_contiguous():
-                data = data.contiguous()
-            ptr = ctypes.c_void_p(data.data_ptr())
-            t.load(ptr)
-            t._tensor = None 
+        self.load_stats = self._load_weights(files, prefetch)
+        print(
+            f"Weights loaded: {self.load_stats.mapped} mapped, {self.load_stats.copied} copied, "
+            f"{self.load_stats.load_ms:.2f} ms",
+            flush=True,
+        )
+
+    def _load_weights(self, files, prefetch: int) -> LlaisysWeightLoadStats:
+        # Weights in the model dtype are mapped straight from the files (CPU); others are
+        # converted by the library
+        paths = (ctypes.c_char_p * len(files))(*[str(file).encode() for file in files])
+        stats = LlaisysWeightLoadStats()
+        if LIB_LLAISYS.llaisysQwen2ModelLoadSafetensors(self._model, paths, len(files), prefetch, ctypes.byref(stats)) != 0:
+            raise RuntimeError(f"failed to load the weights from {self.model_path}")
+        return stats
+
+    def lock_weights(self) -> bool:
+        """mlock the weights (CPU) so they are never swapped out; False if RLIMIT_MEMLOCK refused."""
+        return LIB_LLAISYS.llaisysQwen2ModelLockWeights(self._model) == 0
+
+    def place_weights(self, placement: int):
+        """Migrate the weights to a NUMA placement (libllaisys.models.NUMA_*); pair
+        NUMA_PARTITION with RuntimeAPI.pin_threads()."""
+        LIB_LLAISYS.llaisysQwen2ModelPlaceWeights(self._model, placement)
+
+    def set_kv_cache_layout(self, layout: int):
+        """Re-allocate the KV cache as libllaisys.models.KV_LAYOUT_*; cached positions are dropped."""
+        LIB_LLAISYS.llaisysQwen2ModelSetKVCacheLayout(self._model, layout)
+
+    def set_residual_dtype(self, dtype: DataType):
+        """Keep the residual stream and norm outputs in `dtype` (the model dtype or DataType.F32)."""
+        LIB_LLAISYS.llaisysQwen2ModelSetResidualDtype(self._model, dtype)
+
+    def reserve_workspace(self, ntoken: int):
+        """Preplan activation buffers for calls of up to `ntoken` tokens."""
+        LIB_LLAISYS.llaisysQwen2ModelReserveWorkspace(self._model, ntoken)
+
+    def workspace_stats(self) -> LlaisysWorkspaceStats:
+        stats = LlaisysWorkspaceStats()
+        LIB_LLAISYS.llaisysQwen2ModelWorkspaceStats(self._model, ctypes.byref(stats))
+        return stats
+
+    def set_decode_graph(self, enable: bool):
+        """Replay a recorded decode step instead of dispatching each op (on by default)."""
+        LIB_LLAISYS.llaisysQwen2ModelSetDecodeGraph(self._model, 1 if enable else 0)
+
+    def decode_graph_stats(self) -> LlaisysDecodeGraphStats:
+        stats = LlaisysDecodeGraphStats()
+        LIB_LLAISYS.llaisysQwen2ModelDecodeGraphStats(self._model, ctypes.byref(stats))
+        return stats
+
+    def kv_swap_out(self, path, npos: int):
+        """Spill the first `npos` cached positions to `path` and free the KV cache."""
+        LIB_LLAISYS.llaisysQwen2ModelKVSwapOut(self._model, str(path).encode(), npos)
+
+    def kv_swap_in(self):
+        """Start restoring the swapped-out KV cache; the next inference waits for it."""
+        LIB_LLAISYS.llaisysQwen2ModelKVSwapIn(self._model)
+
+    def kv_swap_stats(self) -> LlaisysKVSwapStats:
+        stats = LlaisysKVSwapStats()
+        LIB_LLAISYS.llaisysQwen2ModelKVSwapStats(self._model, ctypes.byref(stats))
+        return stats
+
+    def save_session(self, path, pos: int):
+        """Snapshot the first `pos` cached positions so a later call can resume from them."""
+        LIB_LLAISYS.llaisysQwen2ModelSaveSession(self._model, str(path).encode(), pos)
+
+    def load_session(self, path) -> int:
+        """Restore a snapshot; returns the position to continue from, or -1 if it is unreadable or does not match."""
+        return LIB_LLAISYS.llaisysQwen2ModelLoadSession(self._model, str(path).encode())
+
+    def set_sampling_seed(self, seed: int):
+        """Seed the sampling RNG so that sampled generations are reproducible."""
+        LIB_LLAISYS.llaisysQwen2ModelSetSamplingSeed(self._model, seed)
+
+    def _infer_sampled(self, tokens_buf, ntoken: int, pos: int, params: LlaisysSamplingParams) -> int:
+        return LIB_LLAISYS.llaisysQwen2ModelInferSampled(self._model, tokens_buf, ntoken, pos, ctypes.byref(params))
+
+    def create_session(self) -> "Qwen2Session":
+        """A new conversation over these weights; sessions may run on different threads at once."""
+        return Qwen2Session(self)
 
     def generate(
         self,
@@ -103,10 +156,24 @@ class Qwen2:
         top_k: int = 1,
         top_p: float = 0.8,
         temperature: float = 0.8,
+        repetition_penalty: float = 1.0,
+        frequency_penalty: float = 0.0,
+        presence_penalty: float = 0.0,
+        seed: int = None,
+        session: "Qwen2Session" = None,
     ):
         # 修正：结果列表必须包含输入的 prompt tokens，以匹配 HF 的行为
         result = list(inputs)
         current_pos = 0 
+
+        # Sampling runs in the library; top_k=1 or temperature=0 is greedy
+        params = LlaisysSamplingParams(
+            temperature, top_k, top_p, repetition_penalty, frequency_penalty, presence_penalty
+        )
+        # Without a session, the model's default one is used
+        target = session or self
+        if seed is not None:
+            target.set_sampling_seed(seed)
         
         # Prefill
         tokens_buf = (ctypes.c_int64 * len(inputs))(*inputs)
@@ -114,7 +181,7 @@ class Qwen2:
         print(f"Start Prefill ({len(inputs)} tokens)...", end=" ", flush=True)
         t0 = time.time()
         # Prefill 阶段处理整个 prompt，返回第一个生成的 token
-        next_token = LIB_LLAISYS.llaisysQwen2ModelInfer(self._model, tokens_buf, len(inputs), current_pos)
+        next_token = target._infer_sampled(tokens_buf, len(inputs), current_pos, params)
         t1 = time.time()
         print(f"Done. Time: {(t1-t0)*1000:.2f} ms", flush=True)
         
@@ -131,7 +198,7 @@ class Qwen2:
             tokens_buf = (ctypes.c_int64 * 1)(next_token)
             
             t0 = time.time()
-            next_token = LIB_LLAISYS.llaisysQwen2ModelInfer(self._model, tokens_buf, 1, current_pos)
+            next_token = target._infer_sampled(tokens_buf, 1, current_pos, params)
             t1 = time.time()
             
             print(f"\r[Decode] Step {i+1}/{max_new_tokens-1}: {(t1-t0)*1000:.2f} ms", end="", flush=True)
@@ -140,4 +207,34 @@ class Qwen2:
             current_pos += 1
         
         print("\nGeneration finished.", flush=True)
-        return result
\ No newline at end of file
+        return result
+
+
+class Qwen2Session:
+    """One conversation (KV cache, token history, sampler) over a Qwen2's shared weights."""
+
+    def __init__(self, model: Qwen2):
+        self._owner = model  # the weights must outlive the session
+        self._session = LIB_LLAISYS.llaisysQwen2SessionCreate(model._model)
+
+    def __del__(self):
+        self.close()
+
+    def close(self):
+        if getattr(self, "_session", None):
+            LIB_LLAISYS.llaisysQwen2SessionDestroy(self._session)
+            self._session = None
+
+    def infer(self, tokens: Sequence[int], pos: int, params: LlaisysSamplingParams = None) -> int:
+        """Feed `tokens` at positions [pos, pos + len(tokens)) and return the next token (argmax without params)."""
+        buf = (ctypes.c_int64 * len(tokens))(*tokens)
+        if params is None:
+            return LIB_LLAISYS.llaisysQwen2SessionInfer(self._session, buf, len(tokens), pos)
+        return self._infer_sampled(buf, len(tokens), pos, params)
+
+    def set_sampling_seed(self, seed: int):
+        LIB_LLAISYS.llaisysQwen2SessionSetSamplingSeed(self._session, seed)
+
+    def _infer_sampled(self, tokens_buf, ntoken: int, pos: int, params: LlaisysSamplingParams) -> int:
+        return LIB_LLAISYS.llaisysQwen2SessionInferSampled(self._session, tokens_buf, ntoken, pos, ctypes.byref(params))
+
@@ -8,10 +8,25 @@ class Ops:
     def add(c: Tensor, a: Tensor, b: Tensor):
         LIB_LLAISYS.llaisysAdd(c.lib_tensor(), a.lib_tensor(), b.lib_tensor())
 
+    @staticmethod
+    def add_rms_norm(out: Tensor, res_out: Tensor, a: Tensor, b: Tensor, weight: Tensor, eps: float):
+        LIB_LLAISYS.llaisysAddRmsNorm(
+            out.lib_tensor(),
+            res_out.lib_tensor(),
+            a.lib_tensor(),
+            b.lib_tensor(),
+            weight.lib_tensor(),
+            c_float(eps),
+        )
+
     @staticmethod
     def argmax(max_idx: Tensor, max_val: Tensor, vals: Tensor):
         LIB_LLAISYS.llaisysArgmax(max_idx.lib_tensor(), max_val.lib_tensor(), vals.lib_tensor())
 
+    @staticmethod
+    def cast(out: Tensor, inp: Tensor):
+        LIB_LLAISYS.llaisysCast(out.lib_tensor(), inp.lib_tensor())
+
     @staticmethod
     def embedding(out: Tensor, index: Tensor, weight: Tensor):
         LIB_LLAISYS.llaisysEmbedding(
@@ -24,6 +39,18 @@ class Ops:
             out.lib_tensor(), inp.lib_tensor(), weight.lib_tensor(), bias.lib_tensor()
         )
 
+    @staticmethod
+    def lm_head_topk(
+        out_idx: Tensor, out_val: Tensor, lse: Tensor, hidden: Tensor, weight: Tensor
+    ):
+        LIB_LLAISYS.llaisysLmHeadTopK(
+            out_idx.lib_tensor(),
+            out_val.lib_tensor(),
+            lse.lib_tensor() if lse is not None else None,
+            hidden.lib_tensor(),
+            weight.lib_tensor(),
+        )
+
     @staticmethod
     def rearrange(out: Tensor, inp: Tensor):
         LIB_LLAISYS.llaisysRearrange(out.lib_tensor(), inp.lib_tensor())
@@ -40,6 +67,20 @@ class Ops:
             out.lib_tensor(), inp.lib_tensor(), pos_ids.lib_tensor(), c_float(theta)
         )
 
+    @staticmethod
+    def rope_cached(out: Tensor, inp: Tensor, pos_ids: Tensor, cos_table: Tensor, sin_table: Tensor):
+        LIB_LLAISYS.llaisysROPECached(
+            out.lib_tensor(),
+            inp.lib_tensor(),
+            pos_ids.lib_tensor(),
+            cos_table.lib_tensor(),
+            sin_table.lib_tensor(),
+        )
+
+    @staticmethod
+    def rope_table(cos_table: Tensor, sin_table: Tensor, theta: float):
+        LIB_LLAISYS.llaisysROPETable(cos_table.lib_tensor(), sin_table.lib_tensor(), c_float(theta))
+
     @staticmethod
     def self_attention(attn_val: Tensor, q: Tensor, k: Tensor, v: Tensor, scale: float):
         LIB_LLAISYS.llaisysSelfAttention(
@@ -1,10 +1,11 @@
 from . import libllaisys
 from .libllaisys import LIB_LLAISYS
-from ctypes import c_void_p
+from ctypes import c_void_p, byref
 
 
 class RuntimeAPI:
     def __init__(self, device_type: libllaisys.DeviceType):
+        self._device_type = device_type
         self._api = LIB_LLAISYS.llaisysGetRuntimeAPI(
             libllaisys.llaisysDeviceType_t(device_type)
         )
@@ -66,3 +67,73 @@ class RuntimeAPI:
         self._api.contents.memcpy_async(
             dst, src, size, libllaisys.llaisysMemcpyKind_t(kind), stream
         )
+
+    def create_event(self) -> libllaisys.llaisysEvent_t:
+        return self._api.contents.create_event()
+
+    def destroy_event(self, event: libllaisys.llaisysEvent_t) -> None:
+        self._api.contents.destroy_event(event)
+
+    def event_record(
+        self, event: libllaisys.llaisysEvent_t, stream: libllaisys.llaisysStream_t
+    ) -> None:
+        """Mark the work enqueued on `stream` so far."""
+        self._api.contents.event_record(event, stream)
+
+    def event_synchronize(self, event: libllaisys.llaisysEvent_t) -> None:
+        self._api.contents.event_synchronize(event)
+
+    def event_query(self, event: libllaisys.llaisysEvent_t) -> bool:
+        return bool(self._api.contents.event_query(event))
+
+    def stream_wait_event(
+        self, stream: libllaisys.llaisysStream_t, event: libllaisys.llaisysEvent_t
+    ) -> None:
+        """Make later work on `stream` wait for `event` without blocking the caller."""
+        self._api.contents.stream_wait_event(stream, event)
+
+    def allocator_stats(self, device_id: int = 0) -> libllaisys.LlaisysAllocatorStats:
+        stats = libllaisys.LlaisysAllocatorStats()
+        LIB_LLAISYS.llaisysAllocatorStats(
+            libllaisys.llaisysDeviceType_t(self._device_type), device_id, byref(stats)
+        )
+        return stats
+
+    def allocator_trim(self, device_id: int = 0) -> None:
+        """Return cached device memory that no tensor is using."""
+        LIB_LLAISYS.llaisysAllocatorTrim(
+            libllaisys.llaisysDeviceType_t(self._device_type), device_id
+        )
+
+    def cpu_memory_report(self) -> libllaisys.LlaisysCpuMemoryReport:
+        """Large CPU buffers mapped by the runtime, how much of them sit on huge pages, and locked bytes."""
+        report = libllaisys.LlaisysCpuMemoryReport()
+        LIB_LLAISYS.llaisysCpuMemoryReport(byref(report))
+        return report
+
+    def lock_memory(self, ptr: c_void_p, size: int) -> bool:
+        """mlock host memory; False if RLIMIT_MEMLOCK refused. Each lock needs its own unlock."""
+        return LIB_LLAISYS.llaisysCpuLockMemory(ptr, size) == 0
+
+    def unlock_memory(self, ptr: c_void_p, size: int) -> None:
+        LIB_LLAISYS.llaisysCpuUnlockMemory(ptr, size)
+
+    def numa_report(self, measure_bandwidth: bool = False) -> list:
+        """Per NUMA node (= CPU device id): CPUs, memory, runtime bytes placed there and,
+        optionally, local read bandwidth in GB/s."""
+        n = LIB_LLAISYS.llaisysCpuNumaReport(None, 0, 0)
+        reports = (libllaisys.LlaisysNumaNodeReport * n)()
+        LIB_LLAISYS.llaisysCpuNumaReport(reports, n, int(measure_bandwidth))
+        return list(reports)
+
+    def pin_threads(self) -> None:
+        """Pin the CPU worker threads node by node (see NUMA_PARTITION)."""
+        LIB_LLAISYS.llaisysCpuPinThreads()
+
+    def set_thread_pool(self, num_threads: int = 0, affinity: int = 0) -> None:
+        """Restart the CPU kernel thread pool with `num_threads` threads, the caller included
+        (0: LLAISYS_NUM_THREADS or every allowed CPU), and a libllaisys.runtime.THREAD_AFFINITY_*."""
+        LIB_LLAISYS.llaisysSetThreadPool(num_threads, affinity)
+
+    def num_threads(self) -> int:
+        return LIB_LLAISYS.llaisysGetNumThreads()
@@ -14,6 +14,9 @@ public:
     virtual ~MemoryAllocator() = default;
     virtual std::byte *allocate(size_t size) = 0;
     virtual void release(std::byte *memory) = 0;
+    // Returns cached but unused memory to the device; no-op for non-caching allocators.
+    virtual void trim() {}
+    virtual LlaisysAllocatorStats stats() const { return {}; }
 };
 
 } // namespace llaisys::core
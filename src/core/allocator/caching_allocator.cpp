@@ -0,0 +1,168 @@
+#include "caching_allocator.hpp"
+
+#include "../runtime/runtime.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <new>
+
+namespace llaisys::core::allocators {
+// 分配粒度 512 B；不超过 1 MB 的请求从 2 MB 的小段里切，更大的请求按 2 MB 取整单独成段
+static constexpr size_t ROUND = 512;
+static constexpr size_t SMALL_MAX = 1 << 20;
+static constexpr size_t SMALL_SEGMENT = 2 << 20;
+static constexpr size_t LARGE_ROUND = 2 << 20;
+// 大块剩余不足 1 MB 时不再切分，避免大池里堆积碎片
+static constexpr size_t LARGE_SPLIT_MIN = SMALL_MAX;
+
+static size_t round_up(size_t size, size_t unit) {
+    return (size + unit - 1) / unit * unit;
+}
+
+static size_t bin_index(size_t size) {
+    return 63 - static_cast<size_t>(__builtin_clzll(size));
+}
+
+CachingAllocator::CachingAllocator(const LlaisysRuntimeAPI *runtime_api) : MemoryAllocator(runtime_api), _stats{} {
+}
+
+CachingAllocator::~CachingAllocator() {
+    // Segments with blocks still in use are leaked rather than freed under a live storage.
+    trim_locked();
+}
+
+void CachingAllocator::insert_free(Block *block) {
+    bins(block->small)[bin_index(block->size)].insert(block);
+}
+
+void CachingAllocator::erase_free(Block *block) {
+    bins(block->small)[bin_index(block->size)].erase(block);
+}
+
+CachingAllocator::Block *CachingAllocator::find_free(size_t size, bool small) {
+    Bins &pool = bins(small);
+    Block key{nullptr, size, small, false, nullptr, nullptr};
+    for (size_t i = bin_index(size); i < NUM_BINS; ++i) {
+        auto it = pool[i].lower_bound(&key);
+        if (it != pool[i].end()) {
+            Block *block = *it;
+            pool[i].erase(it);
+            return block;
+        }
+    }
+    return nullptr;
+}
+
+CachingAllocator::Block *CachingAllocator::reserve_segment(size_t size, bool small) {
+    size_t bytes = small ? SMALL_SEGMENT : round_up(size, LARGE_ROUND);
+    auto ptr = static_cast<std::byte *>(_api->malloc_device(bytes));
+    if (ptr == nullptr) {
+        // Hand cached segments back and retry once before giving up
+        trim_locked();
+        ptr = static_cast<std::byte *>(_api->malloc_device(bytes));
+    }
+    if (ptr == nullptr) {
+        std::cerr << "[ERROR] CachingAllocator: out of memory reserving " << bytes << " bytes ("
+                  << _stats.bytes_reserved << " reserved, " << _stats.bytes_in_use << " in use)." << std::endl;
+        throw std::bad_alloc();
+    }
+    _stats.bytes_reserved += bytes;
+    _stats.segments += 1;
+    return new Block{ptr, bytes, small, false, nullptr, nullptr};
+}
+
+std::byte *CachingAllocator::allocate(size_t size) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size = round_up(std::max<size_t>(size, 1), ROUND);
+    bool small = size <= SMALL_MAX;
+
+    Block *block = find_free(size, small);
+    if (block) {
+        _stats.hits += 1;
+    } else {
+        _stats.misses += 1;
+        block = reserve_segment(size, small);
+    }
+
+    // Split off the tail if it is worth keeping as a separate free block
+    size_t remain = block->size - size;
+    if (remain >= (small ? ROUND : LARGE_SPLIT_MIN)) {
+        Block *tail = new Block{block->ptr + size, remain, small, false, block, block->next};
+        if (block->next) {
+            block->next->prev = tail;
+        }
+        block->next = tail;
+        block->size = size;
+        insert_free(tail);
+    }
+
+    block->allocated = true;
+    _allocated[block->ptr] = block;
+    _stats.bytes_in_use += block->size;
+    _stats.peak_bytes_in_use = std::max(_stats.peak_bytes_in_use, _stats.bytes_in_use);
+    return block->ptr;
+}
+
+void CachingAllocator::release(std::byte *memory) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _allocated.find(memory);
+    ASSERT(it != _allocated.end(),
+           "CachingAllocator: releasing unknown pointer " << static_cast<void *>(memory));
+    Block *block = it->second;
+    _allocated.erase(it);
+    block->allocated = false;
+    _stats.bytes_in_use -= block->size;
+
+    // Coalesce with free neighbours in the same segment
+    if (Block *next = block->next; next && !next->allocated) {
+        erase_free(next);
+        block->size += next->size;
+        block->next = next->next;
+        if (next->next) {
+            next->next->prev = block;
+        }
+        delete next;
+    }
+    if (Block *prev = block->prev; prev && !prev->allocated) {
+        erase_free(prev);
+        prev->size += block->size;
+        prev->next = block->next;
+        if (block->next) {
+            block->next->prev = prev;
+        }
+        delete block;
+        block = prev;
+    }
+    insert_free(block);
+}
+
+void CachingAllocator::trim() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    trim_locked();
+}
+
+void CachingAllocator::trim_locked() {
+    // A free block with no neighbours spans a whole segment
+    for (Bins *pool : {&_small_bins, &_large_bins}) {
+        for (auto &bin : *pool) {
+            for (auto it = bin.begin(); it != bin.end();) {
+                Block *block = *it;
+                if (block->prev == nullptr && block->next == nullptr) {
+                    _api->free_device(block->ptr);
+                    _stats.bytes_reserved -= block->size;
+                    _stats.segments -= 1;
+                    delete block;
+                    it = bin.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+}
+
+LlaisysAllocatorStats CachingAllocator::stats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+} // namespace llaisys::core::allocators
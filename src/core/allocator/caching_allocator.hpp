@@ -0,0 +1,58 @@
+#pragma once
+
+#include "allocator.hpp"
+
+#include <array>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace llaisys::core::allocators {
+// Caches device memory instead of returning it on every release. Memory is reserved
+// in segments (2 MB for small requests, rounded-up exact size for large ones) and
+// handed out as blocks: a request takes the best-fitting free block from size-class
+// bins and splits off the remainder; a released block is merged with free neighbours
+// of the same segment. Segments go back to the device only on trim().
+class CachingAllocator : public MemoryAllocator {
+public:
+    CachingAllocator(const LlaisysRuntimeAPI *runtime_api);
+    ~CachingAllocator();
+    std::byte *allocate(size_t size) override;
+    void release(std::byte *memory) override;
+    void trim() override;
+    LlaisysAllocatorStats stats() const override;
+
+private:
+    struct Block {
+        std::byte *ptr;
+        size_t size;
+        bool small; // pool the block belongs to
+        bool allocated;
+        Block *prev; // neighbours within the same segment
+        Block *next;
+    };
+
+    struct BlockLess {
+        bool operator()(const Block *a, const Block *b) const {
+            return a->size != b->size ? a->size < b->size : a->ptr < b->ptr;
+        }
+    };
+
+    // Bin i holds free blocks of size [2^i, 2^(i+1)); small and large pools never mix
+    static constexpr size_t NUM_BINS = 64;
+    using Bins = std::array<std::set<Block *, BlockLess>, NUM_BINS>;
+
+    Bins &bins(bool small) { return small ? _small_bins : _large_bins; }
+    void insert_free(Block *block);
+    void erase_free(Block *block);
+    Block *find_free(size_t size, bool small);
+    Block *reserve_segment(size_t size, bool small);
+    void trim_locked();
+
+    mutable std::mutex _mutex;
+    Bins _small_bins;
+    Bins _large_bins;
+    std::unordered_map<std::byte *, Block *> _allocated;
+    LlaisysAllocatorStats _stats;
+};
+} // namespace llaisys::core::allocators
@@ -1,23 +1,23 @@
 #include "runtime.hpp"
 
 #include "../../device/runtime_api.hpp"
-#include "../allocator/naive_allocator.hpp"
+#include "../allocator/caching_allocator.hpp"
 
 namespace llaisys::core {
 Runtime::Runtime(llaisysDeviceType_t device_type, int device_id)
-    : _device_type(device_type), _device_id(device_id), _is_active(false) {
+    : _device_type(device_type), _device_id(device_id), _is_active(false), _stream(nullptr) {
     _api = llaisys::device::getRuntimeAPI(_device_type);
-    _stream = _api->create_stream();
-    _allocator = new allocators::NaiveAllocator(_api);
+    _allocator = std::make_shared<allocators::CachingAllocator>(_api);
 }
 
 Runtime::~Runtime() {
     if (!_is_active) {
         std::cerr << "Mallicious destruction of inactive runtime." << std::endl;
     }
-    delete _allocator;
-    _allocator = nullptr;
-    _api->destroy_stream(_stream);
+    _allocator.reset();
+    if (_stream != nullptr) {
+        _api->destroy_stream(_stream);
+    }
     _api = nullptr;
 }
 
@@ -47,27 +47,36 @@ const LlaisysRuntimeAPI *Runtime::api() const {
 }
 
 storage_t Runtime::allocateDeviceStorage(size_t size) {
-    return std::shared_ptr<Storage>(new Storage(_allocator->allocate(size), size, *this, false));
+    return std::shared_ptr<Storage>(
+        new Storage(_allocator->allocate(size), size, _device_type, _device_id, _api, _allocator, false));
 }
 
 storage_t Runtime::allocateHostStorage(size_t size) {
-    return std::shared_ptr<Storage>(new Storage((std::byte *)_api->malloc_host(size), size, *this, true));
+    return std::shared_ptr<Storage>(
+        new Storage((std::byte *)_api->malloc_host(size), size, _device_type, _device_id, _api, _allocator, true));
 }
 
-void Runtime::freeStorage(Storage *storage) {
-    if (storage->isHost()) {
-        _api->free_host(storage->memory());
-    } else {
-        _allocator->release(storage->memory());
-    }
+LlaisysAllocatorStats Runtime::allocatorStats() const {
+    return _allocator->stats();
+}
+
+void Runtime::trimAllocator() {
+    _allocator->trim();
 }
 
+// Created on first use: every thread gets a context, and a CPU stream costs a worker thread
 llaisysStream_t Runtime::stream() const {
+    if (_stream == nullptr) {
+        _stream = _api->create_stream();
+    }
     return _stream;
 }
 
 void Runtime::synchronize() const {
-    _api->stream_synchronize(_stream);
+    // Nothing can be pending on a stream that was never created
+    if (_stream != nullptr) {
+        _api->stream_synchronize(_stream);
+    }
 }
 
 } // namespace llaisys::core
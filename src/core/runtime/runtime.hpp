@@ -10,11 +10,11 @@ private:
     llaisysDeviceType_t _device_type;
     int _device_id;
     const LlaisysRuntimeAPI *_api;
-    MemoryAllocator *_allocator;
+    std::shared_ptr<MemoryAllocator> _allocator; // shared with the storages it handed out
     bool _is_active;
     void _activate();
     void _deactivate();
-    llaisysStream_t _stream;
+    mutable llaisysStream_t _stream; // created lazily by stream()
     Runtime(llaisysDeviceType_t device_type, int device_id);
 
 public:
@@ -39,7 +39,9 @@ public:
     storage_t allocateDeviceStorage(size_t size);
     ;
     storage_t allocateHostStorage(size_t size);
-    void freeStorage(Storage *storage);
+
+    LlaisysAllocatorStats allocatorStats() const;
+    void trimAllocator();
 
     llaisysStream_t stream() const;
     void synchronize() const;
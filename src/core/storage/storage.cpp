@@ -1,13 +1,28 @@
 #include "storage.hpp"
 
-#include "../runtime/runtime.hpp"
+#include "../allocator/allocator.hpp"
 
 namespace llaisys::core {
-Storage::Storage(std::byte *memory, size_t size, Runtime &runtime, bool is_host)
-    : _memory(memory), _size(size), _runtime(runtime), _is_host(is_host) {}
+Storage::Storage(std::byte *memory, size_t size, llaisysDeviceType_t device_type, int device_id,
+                 const LlaisysRuntimeAPI *api, std::shared_ptr<MemoryAllocator> allocator, bool is_host)
+    : _memory(memory), _size(size), _device_type(device_type), _device_id(device_id), _api(api),
+      _allocator(std::move(allocator)), _is_host(is_host) {}
+
+storage_t Storage::wrap(std::byte *memory, size_t size, std::shared_ptr<void> owner) {
+    storage_t storage(new Storage(memory, size, LLAISYS_DEVICE_CPU, 0, nullptr, nullptr, true));
+    storage->_owner = std::move(owner);
+    return storage;
+}
 
 Storage::~Storage() {
-    _runtime.freeStorage(this);
+    if (_owner) {
+        return;
+    }
+    if (_is_host) {
+        _api->free_host(_memory);
+    } else {
+        _allocator->release(_memory);
+    }
 }
 
 std::byte *Storage::memory() const {
@@ -22,7 +37,7 @@ llaisysDeviceType_t Storage::deviceType() const {
     if (isHost()) {
         return LLAISYS_DEVICE_CPU;
     } else {
-        return _runtime.deviceType();
+        return _device_type;
     }
 }
 
@@ -30,11 +45,15 @@ int Storage::deviceId() const {
     if (isHost()) {
         return 0;
     } else {
-        return _runtime.deviceId();
+        return _device_id;
     }
 }
 
 bool Storage::isHost() const {
     return _is_host;
 }
-} // namespace llaisys::core
\ No newline at end of file
+
+bool Storage::isReadOnly() const {
+    return _owner != nullptr;
+}
+} // namespace llaisys::core
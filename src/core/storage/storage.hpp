@@ -1,5 +1,6 @@
 #pragma once
 #include "llaisys.h"
+#include "llaisys/runtime.h"
 
 #include "../core.hpp"
 
@@ -10,19 +11,31 @@ class Storage {
 private:
     std::byte *_memory;
     size_t _size;
-    Runtime &_runtime;
+    llaisysDeviceType_t _device_type;
+    int _device_id;
+    const LlaisysRuntimeAPI *_api;
+    // Keeps the allocator alive past the Runtime that created this storage: runtimes are
+    // per thread, and a buffer allocated on one thread may outlive it.
+    std::shared_ptr<MemoryAllocator> _allocator;
+    std::shared_ptr<void> _owner; // set for wrapped memory, which is never freed or written here
     bool _is_host;
-    Storage(std::byte *memory, size_t size, Runtime &runtime, bool is_host);
+    Storage(std::byte *memory, size_t size, llaisysDeviceType_t device_type, int device_id,
+            const LlaisysRuntimeAPI *api, std::shared_ptr<MemoryAllocator> allocator, bool is_host);
 
 public:
     friend class Runtime;
     ~Storage();
 
+    // Read-only CPU memory owned by someone else (e.g. a file mapping); `owner` is held until
+    // the storage goes away.
+    static storage_t wrap(std::byte *memory, size_t size, std::shared_ptr<void> owner);
+
     std::byte *memory() const;
     size_t size() const;
     llaisysDeviceType_t deviceType() const;
     int deviceId() const;
     bool isHost() const;
+    bool isReadOnly() const;
 };
 
 }; // namespace llaisys::core
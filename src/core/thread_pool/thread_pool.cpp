@@ -0,0 +1,278 @@
+#include "thread_pool.hpp"
+
+#include "../../device/cpu/cpu_numa.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace llaisys::core {
+// Pause iterations an idle thread spins before parking (a few tens of microseconds)
+static constexpr int SPIN_ITERS = 1 << 11;
+
+static thread_local size_t tl_index = 0;
+static thread_local const ThreadPool *tl_pool = nullptr;
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+static size_t default_threads() {
+    if (const char *env = std::getenv("LLAISYS_NUM_THREADS")) {
+        long n = std::strtol(env, nullptr, 10);
+        if (n > 0) {
+            return static_cast<size_t>(n);
+        }
+    }
+    size_t ncpu = 0;
+    for (const auto &node : device::cpu::numaNodes()) {
+        ncpu += node.cpus.size();
+    }
+    return std::max<size_t>(ncpu, 1);
+}
+
+static llaisysThreadAffinity_t default_affinity() {
+    const char *env = std::getenv("LLAISYS_THREAD_AFFINITY");
+    if (env && std::strcmp(env, "numa") == 0) {
+        return LLAISYS_THREAD_AFFINITY_NUMA;
+    }
+    if (env && std::strcmp(env, "core") == 0) {
+        return LLAISYS_THREAD_AFFINITY_CORE;
+    }
+    return LLAISYS_THREAD_AFFINITY_NONE;
+}
+
+// Pins the calling thread as thread `t` of `nthreads`
+static void apply_affinity(llaisysThreadAffinity_t affinity, size_t t, size_t nthreads) {
+    switch (affinity) {
+    case LLAISYS_THREAD_AFFINITY_NUMA:
+        device::cpu::pinThreadToNode(static_cast<int>(t), static_cast<int>(nthreads));
+        break;
+    case LLAISYS_THREAD_AFFINITY_CORE:
+        device::cpu::pinThreadToCpu(static_cast<int>(t));
+        break;
+    default:
+        break;
+    }
+}
+
+TaskGroup::TaskGroup(ThreadPool &pool) : _pool(pool), _pending(0) {}
+
+TaskGroup::TaskGroup() : TaskGroup(ThreadPool::instance()) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    runOn(tl_pool == &_pool ? tl_index : 0, std::move(task));
+}
+
+void TaskGroup::runOn(size_t t, std::function<void()> task) {
+    _pending.fetch_add(1);
+    _pool.push_(t, {std::move(task), this});
+}
+
+void TaskGroup::wait() {
+    size_t self = tl_pool == &_pool ? tl_index : 0;
+    while (_pending.load() > 0) {
+        ThreadPool::Job job;
+        if (_pool.pop_(self, job)) {
+            _pool.execute_(job);
+            continue;
+        }
+        _pool.idle_([this] { return _pending.load() == 0; });
+    }
+    std::lock_guard<std::mutex> lock(_error_mutex);
+    if (_error) {
+        std::exception_ptr error = std::move(_error);
+        _error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+ThreadPool &ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool()
+    : _nthreads(default_threads()), _affinity(default_affinity()), _queued(0), _epoch(0), _sleepers(0),
+      _stop(false) {
+    start_();
+}
+
+ThreadPool::~ThreadPool() {
+    stop_();
+}
+
+void ThreadPool::configure(size_t nthreads, llaisysThreadAffinity_t affinity) {
+    stop_();
+    _nthreads = nthreads > 0 ? nthreads : default_threads();
+    if (_affinity != LLAISYS_THREAD_AFFINITY_NONE && affinity == LLAISYS_THREAD_AFFINITY_NONE) {
+        device::cpu::unpinThread();
+    }
+    _affinity = affinity;
+    start_();
+}
+
+size_t ThreadPool::threadIndex() {
+    return tl_index;
+}
+
+void ThreadPool::start_() {
+    _stop = false;
+    _deques.clear();
+    for (size_t t = 0; t < _nthreads; ++t) {
+        _deques.push_back(std::make_unique<Deque>());
+    }
+    apply_affinity(_affinity, 0, _nthreads);
+    for (size_t t = 1; t < _nthreads; ++t) {
+        _workers.emplace_back([this, t] { worker_(t); });
+    }
+}
+
+void ThreadPool::stop_() {
+    _stop = true;
+    {
+        std::lock_guard<std::mutex> lock(_park_mutex);
+        _epoch++;
+    }
+    _park_cv.notify_all();
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+    _workers.clear();
+}
+
+void ThreadPool::worker_(size_t t) {
+    tl_index = t;
+    tl_pool = this;
+    apply_affinity(_affinity, t, _nthreads);
+    if (_affinity == LLAISYS_THREAD_AFFINITY_NUMA) {
+        // Scratch a task allocates lands on the node the thread runs on
+        device::cpu::setCurrentNumaDevice(
+            device::cpu::threadNumaDevice(static_cast<int>(t), static_cast<int>(_nthreads)));
+    }
+    while (true) {
+        Job job;
+        if (pop_(t, job)) {
+            execute_(job);
+            continue;
+        }
+        if (_stop.load()) {
+            return;
+        }
+        idle_([this] { return _stop.load(); });
+    }
+}
+
+void ThreadPool::push_(size_t t, Job job) {
+    Deque &d = *_deques[t];
+    {
+        std::lock_guard<std::mutex> lock(d.mutex);
+        d.jobs.push_back(std::move(job));
+    }
+    _queued.fetch_add(1);
+    notify_();
+}
+
+bool ThreadPool::pop_(size_t self, Job &job) {
+    if (_queued.load() == 0) {
+        return false;
+    }
+    // Own deque from the back (most recently queued, still in cache), then steal the
+    // oldest job of the others, starting with the next thread.
+    for (size_t i = 0; i < _nthreads; ++i) {
+        Deque &d = *_deques[(self + i) % _nthreads];
+        std::lock_guard<std::mutex> lock(d.mutex);
+        if (d.jobs.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            job = std::move(d.jobs.back());
+            d.jobs.pop_back();
+        } else {
+            job = std::move(d.jobs.front());
+            d.jobs.pop_front();
+        }
+        _queued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::execute_(Job &job) {
+    TaskGroup *group = job.group;
+    try {
+        job.fn();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(group->_error_mutex);
+        if (!group->_error) {
+            group->_error = std::current_exception();
+        }
+    }
+    job.fn = nullptr;
+    // The group may be destroyed as soon as its count reaches zero: do not touch it after.
+    if (group->_pending.fetch_sub(1) == 1) {
+        notify_();
+    }
+}
+
+void ThreadPool::idle_(const std::function<bool()> &done) {
+    for (int i = 0; i < SPIN_ITERS; ++i) {
+        if (done() || _queued.load() > 0) {
+            return;
+        }
+        cpu_relax();
+    }
+    // Work queued after `seen` is read bumps the epoch, so the wait below cannot miss it.
+    uint64_t seen = _epoch.load();
+    if (done() || _queued.load() > 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(_park_mutex);
+    _sleepers.fetch_add(1);
+    _park_cv.wait(lock, [&] { return _epoch.load() != seen || done(); });
+    _sleepers.fetch_sub(1);
+}
+
+void ThreadPool::notify_() {
+    _epoch.fetch_add(1);
+    if (_sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(_park_mutex);
+        _park_cv.notify_all();
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+    if (n == 0) {
+        return;
+    }
+    const size_t nchunk = grain == 0 ? std::min(_nthreads, n) : (n + grain - 1) / grain;
+    if (_nthreads == 1 || nchunk == 1) {
+        fn(0, n);
+        return;
+    }
+    TaskGroup group(*this);
+    if (grain == 0) {
+        for (size_t c = 1; c < nchunk; ++c) {
+            group.runOn(c, [&fn, n, nchunk, c] { fn(n * c / nchunk, n * (c + 1) / nchunk); });
+        }
+        fn(0, n / nchunk);
+    } else {
+        for (size_t c = nchunk; c-- > 1;) {
+            group.run([&fn, n, grain, c] { fn(c * grain, std::min(n, (c + 1) * grain)); });
+        }
+        fn(0, grain);
+    }
+    group.wait();
+}
+} // namespace llaisys::core
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "llaisys/runtime.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace llaisys::core {
+class ThreadPool;
+
+// A set of tasks to wait for. Tasks may themselves run groups (nested parallelism): a
+// waiting thread executes queued work instead of blocking.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool &pool);
+    TaskGroup();
+    // Waits for the tasks still pending; an exception left unobserved is dropped
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    // Queues `task` on the calling thread's deque, where idle threads can steal it
+    void run(std::function<void()> task);
+    // Queues `task` on thread `t`'s deque (t < pool size; 0 is the shared outside queue)
+    void runOn(size_t t, std::function<void()> task);
+    // Runs queued work until every task of the group has finished, then rethrows the
+    // first exception one of them threw.
+    void wait();
+
+private:
+    friend class ThreadPool;
+    ThreadPool &_pool;
+    std::atomic<size_t> _pending;
+    std::mutex _error_mutex;
+    std::exception_ptr _error;
+};
+
+// Process-wide work-stealing pool that runs the CPU kernels.
+//
+// Thread 0 is whichever thread submits work; threads 1..size()-1 are workers, each owning
+// a deque. A thread pops its own deque from the back and steals from the front of the
+// others; outside threads share deque 0. Idle workers spin briefly, then park until work
+// is queued. Tasks receive raw pointers and never touch core::context(), so workers carry
+// no per-thread runtime state.
+class ThreadPool {
+public:
+    // Created on first use with LLAISYS_NUM_THREADS threads (default: every CPU this process
+    // may run on) and LLAISYS_THREAD_AFFINITY = none | numa | core (default none).
+    static ThreadPool &instance();
+
+    ~ThreadPool();
+
+    // Restarts the workers. `nthreads` counts the calling thread (0: the default above).
+    // With an affinity the calling thread is pinned as thread 0. Not to be called while
+    // work is in flight.
+    void configure(size_t nthreads, llaisysThreadAffinity_t affinity);
+
+    size_t size() const { return _nthreads; }
+    llaisysThreadAffinity_t affinity() const { return _affinity; }
+
+    // 1..size()-1 on this pool's workers, 0 on any other thread
+    static size_t threadIndex();
+
+    // Runs fn(begin, end) over contiguous chunks covering [0, n) and returns when all are
+    // done. grain == 0: one chunk per thread, chunk t queued to thread t, i.e. the same
+    // partition as an OpenMP schedule(static) loop (which NUMA row placement relies on).
+    // grain > 0: chunks of `grain` items, balanced dynamically by stealing.
+    void parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+private:
+    friend class TaskGroup;
+
+    struct Job {
+        std::function<void()> fn;
+        TaskGroup *group;
+    };
+    struct Deque {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    ThreadPool();
+    void start_();
+    void stop_();
+    void worker_(size_t t);
+    void push_(size_t t, Job job);
+    bool pop_(size_t self, Job &job);
+    void execute_(Job &job);
+    // Spins, then sleeps until work is queued or `done` holds
+    void idle_(const std::function<bool()> &done);
+    void notify_();
+
+    size_t _nthreads;
+    llaisysThreadAffinity_t _affinity;
+    std::vector<std::unique_ptr<Deque>> _deques; // one per thread; [0] is shared by outside threads
+    std::vector<std::thread> _workers;
+    std::atomic<size_t> _queued;
+    std::atomic<uint64_t> _epoch; // bumped whenever work is queued or a group completes
+    std::atomic<size_t> _sleepers;
+    std::atomic<bool> _stop;
+    std::mutex _park_mutex;
+    std::condition_variable _park_cv;
+};
+
+// parallelFor on the process-wide pool
+inline void parallel_for(size_t n, const std::function<void(size_t, size_t)> &fn, size_t grain = 0) {
+    ThreadPool::instance().parallelFor(n, grain, fn);
+}
+} // namespace llaisys::core
@@ -0,0 +1,282 @@
+#include "cpu_numa.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace llaisys::device::cpu {
+
+#if defined(__linux__)
+// From <linux/mempolicy.h>; called through syscall() so libnuma is not needed.
+static constexpr int MPOL_BIND_ = 2;
+static constexpr int MPOL_INTERLEAVE_ = 3;
+static constexpr unsigned MPOL_MF_MOVE_ = 1u << 1;
+
+// Parses a sysfs list such as "0-3,8-11"
+static std::vector<int> parse_list(const std::string &text) {
+    std::vector<int> ids;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty() || item == "\n") {
+            continue;
+        }
+        size_t dash = item.find('-');
+        int lo = std::stoi(item.substr(0, dash));
+        int hi = dash == std::string::npos ? lo : std::stoi(item.substr(dash + 1));
+        for (int i = lo; i <= hi; ++i) {
+            ids.push_back(i);
+        }
+    }
+    return ids;
+}
+
+static std::string read_line(const std::string &path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+static std::vector<NumaNode> detect_nodes() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    ::sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    std::vector<NumaNode> nodes;
+    const std::string root = "/sys/devices/system/node/";
+    for (int id : parse_list(read_line(root + "online"))) {
+        NumaNode node{id, {}, 0};
+        std::string dir = root + "node" + std::to_string(id) + "/";
+        for (int c : parse_list(read_line(dir + "cpulist"))) {
+            if (c < CPU_SETSIZE && CPU_ISSET(c, &allowed)) {
+                node.cpus.push_back(c);
+            }
+        }
+        // "Node 0 MemTotal:       32786032 kB"
+        std::ifstream meminfo(dir + "meminfo");
+        std::string line;
+        while (std::getline(meminfo, line)) {
+            size_t at = line.find("MemTotal:");
+            if (at != std::string::npos) {
+                node.mem_total = std::stoull(line.substr(at + 9)) * 1024;
+            }
+        }
+        // Memory-only nodes (no usable CPUs) cannot run the threads that would read them.
+        if (!node.cpus.empty()) {
+            nodes.push_back(std::move(node));
+        }
+    }
+    if (nodes.empty()) {
+        NumaNode node{0, {}, 0};
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &allowed)) {
+                node.cpus.push_back(c);
+            }
+        }
+        long pages = ::sysconf(_SC_PHYS_PAGES);
+        node.mem_total = pages > 0 ? static_cast<uint64_t>(pages) * ::sysconf(_SC_PAGESIZE) : 0;
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
+
+static void set_policy(void *ptr, size_t size, int mode, const std::vector<int> &node_ids) {
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    auto begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) / page * page;
+    auto end = (reinterpret_cast<uintptr_t>(ptr) + size) / page * page;
+    if (end <= begin) {
+        return;
+    }
+    constexpr size_t BITS = 8 * sizeof(unsigned long);
+    int max_id = *std::max_element(node_ids.begin(), node_ids.end());
+    std::vector<unsigned long> mask(max_id / BITS + 1, 0);
+    for (int id : node_ids) {
+        mask[id / BITS] |= 1ul << (id % BITS);
+    }
+    // Best effort: a refused policy (e.g. under a restrictive cpuset) leaves first-touch placement.
+    ::syscall(SYS_mbind, begin, end - begin, mode, mask.data(), mask.size() * BITS + 1, MPOL_MF_MOVE_);
+}
+#else
+static std::vector<NumaNode> detect_nodes() {
+    NumaNode node{0, {}, 0};
+    for (unsigned c = 0; c < std::max(1u, std::thread::hardware_concurrency()); ++c) {
+        node.cpus.push_back(static_cast<int>(c));
+    }
+    return {node};
+}
+#endif
+
+const std::vector<NumaNode> &numaNodes() {
+    static const std::vector<NumaNode> nodes = detect_nodes();
+    return nodes;
+}
+
+static thread_local int current_device = 0;
+
+int currentNumaDevice() {
+    return current_device;
+}
+
+void setCurrentNumaDevice(int device) {
+    current_device = device;
+}
+
+void bindMemory(void *ptr, size_t size, int device) {
+#if defined(__linux__)
+    if (numaNodes().size() > 1) {
+        set_policy(ptr, size, MPOL_BIND_, {numaNodes()[device].id});
+    }
+#endif
+}
+
+void interleaveMemory(void *ptr, size_t size) {
+#if defined(__linux__)
+    if (numaNodes().size() > 1) {
+        std::vector<int> ids;
+        for (const auto &node : numaNodes()) {
+            ids.push_back(node.id);
+        }
+        set_policy(ptr, size, MPOL_INTERLEAVE_, ids);
+    }
+#endif
+}
+
+void residentBytesPerDevice(const void *ptr, size_t size, std::vector<uint64_t> &bytes) {
+#if defined(__linux__)
+    const auto &nodes = numaNodes();
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    auto begin = reinterpret_cast<uintptr_t>(ptr) / page * page;
+    auto end = reinterpret_cast<uintptr_t>(ptr) + size;
+    // move_pages without target nodes only reports where each page lives (-ENOENT if absent).
+    constexpr size_t BATCH = 4096;
+    std::vector<void *> pages;
+    std::vector<int> status(BATCH);
+    for (uintptr_t addr = begin; addr < end;) {
+        pages.clear();
+        for (; addr < end && pages.size() < BATCH; addr += page) {
+            pages.push_back(reinterpret_cast<void *>(addr));
+        }
+        if (::syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+            return;
+        }
+        for (size_t i = 0; i < pages.size(); ++i) {
+            for (size_t d = 0; d < nodes.size(); ++d) {
+                if (status[i] == nodes[d].id) {
+                    bytes[d] += page;
+                    break;
+                }
+            }
+        }
+    }
+#endif
+}
+
+int threadNumaDevice(int t, int nthreads) {
+    return static_cast<int>(static_cast<int64_t>(t) * numaNodes().size() / std::max(nthreads, 1));
+}
+
+#if defined(__linux__)
+static void pin_self(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    ::sched_setaffinity(0, sizeof(set), &set);
+}
+#endif
+
+void pinThreadToNode(int t, int nthreads) {
+#if defined(__linux__)
+    const auto &nodes = numaNodes();
+    int device = threadNumaDevice(t, nthreads);
+    // First thread of this node's block
+    int first = static_cast<int>((static_cast<int64_t>(device) * nthreads + nodes.size() - 1) / nodes.size());
+    const auto &cpus = nodes[device].cpus;
+    pin_self(cpus[(t - first) % cpus.size()]);
+#endif
+}
+
+void pinThreadToCpu(int t) {
+#if defined(__linux__)
+    std::vector<int> cpus;
+    for (const auto &node : numaNodes()) {
+        cpus.insert(cpus.end(), node.cpus.begin(), node.cpus.end());
+    }
+    pin_self(cpus[t % cpus.size()]);
+#endif
+}
+
+void unpinThread() {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto &node : numaNodes()) {
+        for (int c : node.cpus) {
+            CPU_SET(c, &set);
+        }
+    }
+    ::sched_setaffinity(0, sizeof(set), &set);
+#endif
+}
+
+double measureReadBandwidth(int device) {
+    constexpr size_t BYTES = 256 << 20;
+    constexpr int PASSES = 4;
+    const auto &cpus = numaNodes()[device].cpus;
+    size_t nthreads = std::max<size_t>(cpus.size(), 1);
+
+    void *raw = nullptr;
+    if (::posix_memalign(&raw, 4096, BYTES) != 0) {
+        return 0.0;
+    }
+    bindMemory(raw, BYTES, device);
+    auto *data = static_cast<uint64_t *>(raw);
+    const size_t n = BYTES / sizeof(uint64_t);
+
+    std::vector<uint64_t> sums(nthreads);
+    auto run = [&](bool timed) {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < nthreads; ++t) {
+            threads.emplace_back([&, t] {
+#if defined(__linux__)
+                if (!cpus.empty()) {
+                    pin_self(cpus[t]);
+                }
+#endif
+                size_t lo = n * t / nthreads, hi = n * (t + 1) / nthreads;
+                if (!timed) {
+                    std::fill(data + lo, data + hi, uint64_t(t)); // fault the pages in on the node
+                    return;
+                }
+                uint64_t sum = 0;
+                for (int p = 0; p < PASSES; ++p) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        sum += data[i];
+                    }
+                }
+                sums[t] = sum;
+            });
+        }
+        for (auto &th : threads) {
+            th.join();
+        }
+    };
+    run(false);
+    auto start = std::chrono::steady_clock::now();
+    run(true);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::free(raw);
+    return seconds > 0 ? static_cast<double>(BYTES) * PASSES / seconds / 1e9 : 0.0;
+}
+
+} // namespace llaisys::device::cpu
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace llaisys::device::cpu {
+// A NUMA node with CPUs this process may run on. The CPU runtime exposes these nodes as
+// device ids 0..n-1 in sysfs order; hosts without NUMA (or non-Linux) report one node.
+struct NumaNode {
+    int id;                // kernel node id (may be sparse)
+    std::vector<int> cpus; // allowed CPUs on the node
+    uint64_t mem_total;    // bytes
+};
+
+const std::vector<NumaNode> &numaNodes();
+
+// Device (node index) whose memory the calling thread's large allocations are bound to.
+int currentNumaDevice();
+void setCurrentNumaDevice(int device);
+
+// Memory policies for [ptr, ptr + size), trimmed inward to whole pages. Pages already
+// touched are migrated. No-ops with a single node.
+void bindMemory(void *ptr, size_t size, int device);
+void interleaveMemory(void *ptr, size_t size);
+
+// Adds the resident pages of [ptr, ptr + size) to bytes[device] of the node holding them.
+void residentBytesPerDevice(const void *ptr, size_t size, std::vector<uint64_t> &bytes);
+
+// Pins the calling thread as thread `t` of `nthreads`, node i running threads
+// [i * T / n, (i + 1) * T / n): a static row partition then reads the i-th of n equal row
+// blocks on node i.
+void pinThreadToNode(int t, int nthreads);
+// Pins the calling thread to the t-th allowed CPU (wrapping around)
+void pinThreadToCpu(int t);
+// Lets the calling thread run on every allowed CPU again
+void unpinThread();
+
+// Device owning thread `t` of `nthreads` under pinThreadToNode
+int threadNumaDevice(int t, int nthreads);
+
+// Sequential read bandwidth of `device`'s memory from its own CPUs, in GB/s.
+double measureReadBandwidth(int device);
+} // namespace llaisys::device::cpu
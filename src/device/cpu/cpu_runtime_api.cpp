@@ -1,40 +1,185 @@
 #include "../runtime_api.hpp"
+#include "cpu_numa.hpp"
+#include "cpu_stream.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace llaisys::device::cpu {
 
+// 小块按 cache line 对齐；不小于 2 MB 的块单独 mmap 成 2 MB 对齐的区域，优先用
+// MAP_HUGETLB（需要系统预留大页），失败时退回普通页并 madvise 成透明大页。
+static constexpr size_t CACHE_LINE = 64;
+static constexpr size_t HUGE_PAGE = 2 << 20;
+
+namespace {
+struct Mapping {
+    size_t size;
+    bool hugetlb;
+};
+
+// Large buffers mapped by mallocDevice, by start address
+struct Mappings {
+    std::mutex mutex;
+    std::unordered_map<void *, Mapping> map;
+};
+
+Mappings &mappings() {
+    static Mappings instance;
+    return instance;
+}
+} // namespace
+
+#if !defined(_WIN32)
+static void *map_huge(size_t size, bool &hugetlb) {
+    size_t bytes = (size + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+#ifdef MAP_HUGETLB
+    void *addr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (addr != MAP_FAILED) {
+        hugetlb = true;
+        return addr;
+    }
+#endif
+    // Over-map by one huge page and trim both ends so the region is 2 MB aligned, which
+    // lets the kernel back it with transparent huge pages.
+    size_t span = bytes + HUGE_PAGE;
+    void *raw = ::mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    auto begin = reinterpret_cast<uintptr_t>(raw);
+    auto aligned = (begin + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    if (aligned > begin) {
+        ::munmap(raw, aligned - begin);
+    }
+    if (begin + span > aligned + bytes) {
+        ::munmap(reinterpret_cast<void *>(aligned + bytes), begin + span - (aligned + bytes));
+    }
+#ifdef MADV_HUGEPAGE
+    ::madvise(reinterpret_cast<void *>(aligned), bytes, MADV_HUGEPAGE);
+#endif
+    hugetlb = false;
+    return reinterpret_cast<void *>(aligned);
+}
+#endif
+
 namespace runtime_api {
+// One device per NUMA node: large buffers allocated while device i is current live on node i.
 int getDeviceCount() {
-    return 1;
+    return static_cast<int>(numaNodes().size());
+}
+
+void setDevice(int device) {
+    setCurrentNumaDevice(device);
 }
 
-void setDevice(int) {
-    // do nothing
+// Streams alive on any thread, for deviceSynchronize. The registry shares ownership so a
+// stream destroyed while deviceSynchronize waits on it lives until that wait returns.
+struct Streams {
+    std::mutex mutex;
+    std::unordered_map<Stream *, std::shared_ptr<Stream>> map;
+};
+
+static Streams &streams() {
+    static Streams instance;
+    return instance;
 }
 
 void deviceSynchronize() {
-    // do nothing
+    std::vector<std::shared_ptr<Stream>> live;
+    {
+        std::lock_guard<std::mutex> lock(streams().mutex);
+        for (const auto &entry : streams().map) {
+            live.push_back(entry.second);
+        }
+    }
+    for (const auto &stream : live) {
+        stream->synchronize();
+    }
 }
 
+// A null stream is synchronous: work "enqueued" on it runs on the caller before returning.
 llaisysStream_t createStream() {
-    return (llaisysStream_t)0; // null stream
+    auto stream = std::make_shared<Stream>();
+    std::lock_guard<std::mutex> lock(streams().mutex);
+    streams().map[stream.get()] = stream;
+    return stream.get();
 }
 
 void destroyStream(llaisysStream_t stream) {
-    // do nothing
+    if (stream == nullptr) {
+        return;
+    }
+    std::shared_ptr<Stream> owned;
+    {
+        std::lock_guard<std::mutex> lock(streams().mutex);
+        auto it = streams().map.find(static_cast<Stream *>(stream));
+        if (it != streams().map.end()) {
+            owned = std::move(it->second);
+            streams().map.erase(it);
+        }
+    }
+    // The last owner drains and joins it: here, outside the registry lock, or a
+    // deviceSynchronize still waiting on it
 }
+
 void streamSynchronize(llaisysStream_t stream) {
-    // do nothing
+    if (stream != nullptr) {
+        static_cast<Stream *>(stream)->synchronize();
+    }
 }
 
 void *mallocDevice(size_t size) {
-    return std::malloc(size);
+#if !defined(_WIN32)
+    if (size >= HUGE_PAGE) {
+        bool hugetlb = false;
+        if (void *addr = map_huge(size, hugetlb)) {
+            bindMemory(addr, size, currentNumaDevice());
+            std::lock_guard<std::mutex> lock(mappings().mutex);
+            mappings().map[addr] = {(size + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE, hugetlb};
+            return addr;
+        }
+    }
+    void *ptr = nullptr;
+    if (::posix_memalign(&ptr, CACHE_LINE, size == 0 ? 1 : size) != 0) {
+        return nullptr;
+    }
+    return ptr;
+#else
+    return ::_aligned_malloc(size == 0 ? 1 : size, CACHE_LINE);
+#endif
 }
 
 void freeDevice(void *ptr) {
+#if !defined(_WIN32)
+    {
+        std::lock_guard<std::mutex> lock(mappings().mutex);
+        auto it = mappings().map.find(ptr);
+        if (it != mappings().map.end()) {
+            ::munmap(ptr, it->second.size);
+            mappings().map.erase(it);
+            return;
+        }
+    }
     std::free(ptr);
+#else
+    ::_aligned_free(ptr);
+#endif
 }
 
 void *mallocHost(size_t size) {
@@ -50,7 +195,74 @@ void memcpySync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kin
 }
 
 void memcpyAsync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kind, llaisysStream_t stream) {
-    memcpySync(dst, src, size, kind);
+    if (stream == nullptr) {
+        return memcpySync(dst, src, size, kind);
+    }
+    static_cast<Stream *>(stream)->enqueue([=] { std::memcpy(dst, src, size); });
+}
+
+llaisysEvent_t createEvent() {
+    return new Event();
+}
+
+void destroyEvent(llaisysEvent_t event) {
+    delete static_cast<Event *>(event);
+}
+
+// A stream no longer in the registry has been destroyed, which drained it, so the event
+// is recorded as complete.
+void eventRecord(llaisysEvent_t event, llaisysStream_t stream) {
+    std::shared_ptr<Stream> owned;
+    if (stream != nullptr) {
+        std::lock_guard<std::mutex> lock(streams().mutex);
+        auto it = streams().map.find(static_cast<Stream *>(stream));
+        if (it != streams().map.end()) {
+            owned = it->second;
+        }
+    }
+    auto *e = static_cast<Event *>(event);
+    std::lock_guard<std::mutex> lock(e->mutex);
+    e->ticket = owned ? owned->submitted() : 0;
+    e->stream = std::move(owned);
+}
+
+// The (stream, ticket) an event currently stands for; re-recording later does not affect
+// waits already issued.
+static std::pair<std::shared_ptr<Stream>, uint64_t> event_point(llaisysEvent_t event) {
+    auto *e = static_cast<Event *>(event);
+    std::lock_guard<std::mutex> lock(e->mutex);
+    return {e->stream, e->ticket};
+}
+
+void eventSynchronize(llaisysEvent_t event) {
+    auto [stream, ticket] = event_point(event);
+    if (stream != nullptr) {
+        stream->wait(ticket);
+    }
+}
+
+uint8_t eventQuery(llaisysEvent_t event) {
+    auto [stream, ticket] = event_point(event);
+    return stream == nullptr || stream->done(ticket);
+}
+
+void streamWaitEvent(llaisysStream_t stream, llaisysEvent_t event) {
+    auto [source, ticket] = event_point(event);
+    if (source == nullptr || source.get() == stream) {
+        return; // already complete, or ordered by the stream itself
+    }
+    if (stream == nullptr) {
+        return source->wait(ticket);
+    }
+    // The task owns the source stream too, so destroying it before the wait runs is safe
+    static_cast<Stream *>(stream)->enqueue([source = std::move(source), ticket = ticket] { source->wait(ticket); });
+}
+
+void launchHostFunc(llaisysStream_t stream, void (*fn)(void *), void *arg) {
+    if (stream == nullptr) {
+        return fn(arg);
+    }
+    static_cast<Stream *>(stream)->enqueue([fn, arg] { fn(arg); });
 }
 
 static const LlaisysRuntimeAPI RUNTIME_API = {
@@ -65,11 +277,188 @@ static const LlaisysRuntimeAPI RUNTIME_API = {
     &mallocHost,
     &freeHost,
     &memcpySync,
-    &memcpyAsync};
+    &memcpyAsync,
+    &createEvent,
+    &destroyEvent,
+    &eventRecord,
+    &eventSynchronize,
+    &eventQuery,
+    &streamWaitEvent,
+    &launchHostFunc};
 
 } // namespace runtime_api
 
 const LlaisysRuntimeAPI *getRuntimeAPI() {
     return &runtime_api::RUNTIME_API;
 }
+
+#if !defined(_WIN32)
+namespace {
+// How many lockMemory calls hold each page. mlock does not nest, so a range is munlocked
+// only when its last holder lets go (weights sharing pages, tied or co-mapped buffers).
+// A key starts a run of pages held that many times, up to the next key.
+struct LockedPages {
+    std::mutex mutex;
+    std::map<uintptr_t, uint32_t> runs;
+
+    // Makes `at` the start of a run
+    void split(uintptr_t at) {
+        auto next = runs.upper_bound(at);
+        if (next == runs.begin()) {
+            runs.emplace_hint(next, at, 0);
+        } else if (std::prev(next)->first != at) {
+            runs.emplace_hint(next, at, std::prev(next)->second);
+        }
+    }
+
+    // Drops keys that do not change the count, around [lo, hi]
+    void merge(uintptr_t lo, uintptr_t hi) {
+        auto it = runs.lower_bound(lo);
+        if (it != runs.begin()) {
+            --it;
+        }
+        uint32_t prev = it == runs.begin() ? 0 : std::prev(it)->second;
+        while (it != runs.end() && it->first <= hi) {
+            if (it->second == prev) {
+                it = runs.erase(it);
+            } else {
+                prev = it->second;
+                ++it;
+            }
+        }
+    }
+};
+
+LockedPages &lockedPages() {
+    static LockedPages instance;
+    return instance;
+}
+
+std::pair<uintptr_t, uintptr_t> page_range(const void *ptr, size_t size) {
+    static const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    auto lo = reinterpret_cast<uintptr_t>(ptr) / page * page;
+    auto hi = (reinterpret_cast<uintptr_t>(ptr) + size + page - 1) / page * page;
+    return {lo, hi};
+}
+} // namespace
+#endif
+
+bool lockMemory(const void *ptr, size_t size) {
+#if !defined(_WIN32)
+    if (size == 0) {
+        return true;
+    }
+    auto [lo, hi] = page_range(ptr, size);
+    auto &locked = lockedPages();
+    std::lock_guard<std::mutex> lock(locked.mutex);
+    if (::mlock(reinterpret_cast<void *>(lo), hi - lo) != 0) {
+        return false;
+    }
+    locked.split(lo);
+    locked.split(hi);
+    for (auto it = locked.runs.find(lo); it->first != hi; ++it) {
+        it->second++;
+    }
+    locked.merge(lo, hi);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void unlockMemory(const void *ptr, size_t size) {
+#if !defined(_WIN32)
+    if (size == 0) {
+        return;
+    }
+    auto [lo, hi] = page_range(ptr, size);
+    auto &locked = lockedPages();
+    std::lock_guard<std::mutex> lock(locked.mutex);
+    locked.split(lo);
+    locked.split(hi);
+    for (auto it = locked.runs.find(lo); it->first != hi; ++it) {
+        if (it->second > 0 && --it->second == 0) {
+            auto start = it->first;
+            ::munlock(reinterpret_cast<void *>(start), std::next(it)->first - start);
+        }
+    }
+    locked.merge(lo, hi);
+#endif
+}
+
+#if !defined(_WIN32)
+// Bytes of [lo, hi) covered by our mappings
+static uint64_t overlap_bytes(const std::unordered_map<void *, Mapping> &map, uintptr_t lo, uintptr_t hi) {
+    uint64_t total = 0;
+    for (const auto &[start, mapping] : map) {
+        auto begin = std::max(lo, reinterpret_cast<uintptr_t>(start));
+        auto end = std::min(hi, reinterpret_cast<uintptr_t>(start) + mapping.size);
+        total += end > begin ? end - begin : 0;
+    }
+    return total;
+}
+
+// Sums a "<Field>: <n> kB" line of the /proc/self/smaps entries covering our mappings, in
+// bytes. The kernel merges neighbouring mappings into one entry (ours and foreign alike), so
+// a partly covered entry contributes its covered fraction.
+static uint64_t smaps_field_bytes(const std::unordered_map<void *, Mapping> &map, const std::string &field) {
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    double share = 0.0;
+    double total = 0.0;
+    while (std::getline(smaps, line)) {
+        uintptr_t lo = 0, hi = 0;
+        char dash = 0;
+        std::istringstream head(line);
+        // Range lines look like "7f12a0000000-7f12a0200000 rw-p ..."
+        if (head >> std::hex >> lo >> dash >> hi && dash == '-' && hi > lo) {
+            share = static_cast<double>(overlap_bytes(map, lo, hi)) / static_cast<double>(hi - lo);
+        } else if (share > 0.0 && line.compare(0, field.size() + 1, field + ":") == 0) {
+            total += share * std::stoull(line.substr(field.size() + 1)) * 1024;
+        }
+    }
+    return static_cast<uint64_t>(total);
+}
+#endif
+
+void memoryReport(LlaisysCpuMemoryReport *report) {
+    *report = {};
+#if !defined(_WIN32)
+    std::lock_guard<std::mutex> lock(mappings().mutex);
+    for (const auto &[addr, mapping] : mappings().map) {
+        report->mapped_bytes += mapping.size;
+        if (mapping.hugetlb) {
+            report->huge_page_bytes += mapping.size;
+        }
+    }
+    report->huge_page_bytes += smaps_field_bytes(mappings().map, "AnonHugePages");
+
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmLck:") == 0) {
+            report->locked_bytes = std::stoull(line.substr(6)) * 1024;
+        }
+    }
+#endif
+}
+size_t numaReport(LlaisysNumaNodeReport *reports, size_t n, bool measure_bandwidth) {
+    const auto &nodes = numaNodes();
+    std::vector<uint64_t> resident(nodes.size(), 0);
+    {
+        std::lock_guard<std::mutex> lock(mappings().mutex);
+        for (const auto &[addr, mapping] : mappings().map) {
+            residentBytesPerDevice(addr, mapping.size, resident);
+        }
+    }
+    for (size_t i = 0; i < std::min(n, nodes.size()); ++i) {
+        reports[i] = {};
+        reports[i].node = nodes[i].id;
+        reports[i].ncpu = static_cast<int32_t>(nodes[i].cpus.size());
+        reports[i].mem_total_bytes = nodes[i].mem_total;
+        reports[i].resident_bytes = resident[i];
+        reports[i].read_gbps = measure_bandwidth ? measureReadBandwidth(static_cast<int>(i)) : 0.0;
+    }
+    return nodes.size();
+}
 } // namespace llaisys::device::cpu
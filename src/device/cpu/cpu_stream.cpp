@@ -0,0 +1,74 @@
+#include "cpu_stream.hpp"
+
+#include "cpu_numa.hpp"
+
+namespace llaisys::device::cpu {
+Stream::Stream()
+    : _submitted(0), _completed(0), _stop(false), _numa_device(currentNumaDevice()), _worker([this] { run_(); }) {}
+
+Stream::~Stream() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _work_cv.notify_one();
+    _worker.join();
+}
+
+uint64_t Stream::enqueue(std::function<void()> task) {
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(std::move(task));
+        ticket = ++_submitted;
+    }
+    _work_cv.notify_one();
+    return ticket;
+}
+
+uint64_t Stream::submitted() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _submitted;
+}
+
+bool Stream::done(uint64_t ticket) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _completed >= ticket;
+}
+
+void Stream::wait(uint64_t ticket) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done_cv.wait(lock, [&] { return _completed >= ticket; });
+    if (_error) {
+        std::exception_ptr error = std::move(_error);
+        _error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void Stream::run_() {
+    setCurrentNumaDevice(_numa_device);
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _work_cv.wait(lock, [&] { return _stop || !_queue.empty(); });
+        if (_queue.empty()) {
+            return; // stopped and drained
+        }
+        auto task = std::move(_queue.front());
+        _queue.pop_front();
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error && !_error) {
+            _error = error;
+        }
+        _completed++;
+        _done_cv.notify_all();
+    }
+}
+} // namespace llaisys::device::cpu
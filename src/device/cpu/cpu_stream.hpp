@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace llaisys::device::cpu {
+// An in-order work queue drained by its own worker thread, the CPU counterpart of a
+// device stream. Work is identified by tickets: the n-th enqueued task has ticket n.
+class Stream {
+public:
+    Stream();
+    // Drains the queue before joining the worker
+    ~Stream();
+
+    Stream(const Stream &) = delete;
+    Stream &operator=(const Stream &) = delete;
+
+    uint64_t enqueue(std::function<void()> task);
+    // Ticket of the last enqueued task (0 if none)
+    uint64_t submitted() const;
+    bool done(uint64_t ticket) const;
+    // Blocks until `ticket` has run. Rethrows the first exception a task threw since the
+    // last wait, so errors surface at the next synchronization point as on a device.
+    void wait(uint64_t ticket);
+    void synchronize() { wait(submitted()); }
+
+private:
+    void run_();
+
+    mutable std::mutex _mutex;
+    std::condition_variable _work_cv;
+    std::condition_variable _done_cv;
+    std::deque<std::function<void()>> _queue;
+    uint64_t _submitted;
+    uint64_t _completed;
+    std::exception_ptr _error;
+    bool _stop;
+    int _numa_device; // the creator's device, so allocations made by tasks land on its node
+    std::thread _worker;
+};
+
+// Marks a point in a stream: everything enqueued on it before eventRecord. An event
+// never recorded, or recorded on the null stream, is complete. The event shares ownership
+// of its stream, so it stays valid after destroyStream.
+struct Event {
+    std::mutex mutex;
+    std::shared_ptr<Stream> stream;
+    uint64_t ticket = 0;
+};
+} // namespace llaisys::device::cpu
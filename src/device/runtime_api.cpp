@@ -52,6 +52,36 @@ void memcpyAsync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t ki
     EXCEPTION_UNSUPPORTED_DEVICE;
 }
 
+llaisysEvent_t createEvent() {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+    return nullptr;
+}
+
+void destroyEvent(llaisysEvent_t event) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+void eventRecord(llaisysEvent_t event, llaisysStream_t stream) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+void eventSynchronize(llaisysEvent_t event) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+uint8_t eventQuery(llaisysEvent_t event) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+    return 0;
+}
+
+void streamWaitEvent(llaisysStream_t stream, llaisysEvent_t event) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+void launchHostFunc(llaisysStream_t stream, void (*fn)(void *), void *arg) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
 static const LlaisysRuntimeAPI NOOP_RUNTIME_API = {
     &getDeviceCount,
     &setDevice,
@@ -64,7 +94,14 @@ static const LlaisysRuntimeAPI NOOP_RUNTIME_API = {
     &mallocHost,
     &freeHost,
     &memcpySync,
-    &memcpyAsync};
+    &memcpyAsync,
+    &createEvent,
+    &destroyEvent,
+    &eventRecord,
+    &eventSynchronize,
+    &eventQuery,
+    &streamWaitEvent,
+    &launchHostFunc};
 
 const LlaisysRuntimeAPI *getUnsupportedRuntimeAPI() {
     return &NOOP_RUNTIME_API;
@@ -10,7 +10,17 @@ const LlaisysRuntimeAPI *getUnsupportedRuntimeAPI();
 
 namespace cpu {
 const LlaisysRuntimeAPI *getRuntimeAPI();
-}
+
+// Pins host memory so it is never swapped out; false if the kernel refuses (RLIMIT_MEMLOCK).
+// Counted per page: unlockMemory releases a page once every lock covering it is undone.
+bool lockMemory(const void *ptr, size_t size);
+void unlockMemory(const void *ptr, size_t size);
+
+void memoryReport(LlaisysCpuMemoryReport *report);
+
+// Fills up to `n` node reports; returns the number of nodes.
+size_t numaReport(LlaisysNumaNodeReport *reports, size_t n, bool measure_bandwidth);
+} // namespace cpu
 
 #ifdef ENABLE_NVIDIA_API
 namespace nvidia {
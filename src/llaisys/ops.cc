@@ -3,9 +3,12 @@
 #include "llaisys_tensor.hpp"
 
 #include "../ops/add/op.hpp"
+#include "../ops/add_rms_norm/op.hpp"
 #include "../ops/argmax/op.hpp"
+#include "../ops/cast/op.hpp"
 #include "../ops/embedding/op.hpp"
 #include "../ops/linear/op.hpp"
+#include "../ops/lm_head_topk/op.hpp"
 #include "../ops/rearrange/op.hpp"
 #include "../ops/rms_norm/op.hpp"
 #include "../ops/rope/op.hpp"
@@ -16,15 +19,24 @@ __C {
     void llaisysAdd(llaisysTensor_t c, llaisysTensor_t a, llaisysTensor_t b) {
         llaisys::ops::add(c->tensor, a->tensor, b->tensor);
     }
+    void llaisysAddRmsNorm(llaisysTensor_t out, llaisysTensor_t res_out, llaisysTensor_t a, llaisysTensor_t b, llaisysTensor_t weight, float eps) {
+        llaisys::ops::add_rms_norm(out->tensor, res_out->tensor, a->tensor, b->tensor, weight->tensor, eps);
+    }
     void llaisysArgmax(llaisysTensor_t max_idx, llaisysTensor_t max_val, llaisysTensor_t vals) {
         llaisys::ops::argmax(max_idx->tensor, max_val->tensor, vals->tensor);
     }
+    void llaisysCast(llaisysTensor_t out, llaisysTensor_t in) {
+        llaisys::ops::cast(out->tensor, in->tensor);
+    }
     void llaisysEmbedding(llaisysTensor_t out, llaisysTensor_t index, llaisysTensor_t weight) {
         llaisys::ops::embedding(out->tensor, index->tensor, weight->tensor);
     }
     void llaisysLinear(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, llaisysTensor_t bias) {
         llaisys::ops::linear(out->tensor, in->tensor, weight->tensor, bias->tensor);
     }
+    void llaisysLmHeadTopK(llaisysTensor_t out_idx, llaisysTensor_t out_val, llaisysTensor_t lse, llaisysTensor_t hidden, llaisysTensor_t weight) {
+        llaisys::ops::lm_head_topk(out_idx->tensor, out_val->tensor, lse ? lse->tensor : nullptr, hidden->tensor, weight->tensor);
+    }
     void llaisysRearrange(llaisysTensor_t out, llaisysTensor_t in) {
         llaisys::ops::rearrange(out->tensor, in->tensor);
     }
@@ -34,6 +46,12 @@ __C {
     void llaisysROPE(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, float theta) {
         llaisys::ops::rope(out->tensor, in->tensor, pos_ids->tensor, theta);
     }
+    void llaisysROPECached(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, llaisysTensor_t cos_table, llaisysTensor_t sin_table) {
+        llaisys::ops::rope(out->tensor, in->tensor, pos_ids->tensor, cos_table->tensor, sin_table->tensor);
+    }
+    void llaisysROPETable(llaisysTensor_t cos_table, llaisysTensor_t sin_table, float theta) {
+        llaisys::ops::rope_table(cos_table->tensor, sin_table->tensor, theta);
+    }
     void llaisysSelfAttention(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v, float scale) {
         llaisys::ops::self_attention(attn_val->tensor, q->tensor, k->tensor, v->tensor, scale);
     }
@@ -16,8 +16,98 @@ __C {
         return reinterpret_cast<llaisys::models::Qwen2 *>(model)->weights();
     }
 
+    void llaisysQwen2ModelTieEmbeddings(struct LlaisysQwen2Model * model) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->tieEmbeddings();
+    }
+
+    int llaisysQwen2ModelLoadSafetensors(struct LlaisysQwen2Model * model, const char *const *paths, size_t npath, llaisysWeightPrefetch_t prefetch, struct LlaisysWeightLoadStats *stats) {
+        std::vector<std::string> files(paths, paths + npath);
+        return reinterpret_cast<llaisys::models::Qwen2 *>(model)->loadSafetensors(files, prefetch, stats) ? 0 : -1;
+    }
+
+    int llaisysQwen2ModelLockWeights(struct LlaisysQwen2Model * model) {
+        return reinterpret_cast<llaisys::models::Qwen2 *>(model)->lockWeights() ? 0 : -1;
+    }
+
+    void llaisysQwen2ModelPlaceWeights(struct LlaisysQwen2Model * model, llaisysNumaPlacement_t placement) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->placeWeights(placement);
+    }
+
+    void llaisysQwen2ModelSetKVCacheLayout(struct LlaisysQwen2Model * model, llaisysKVCacheLayout_t layout) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().setKVCacheLayout(layout);
+    }
+
+    void llaisysQwen2ModelSetResidualDtype(struct LlaisysQwen2Model * model, llaisysDataType_t dtype) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().setResidualDtype(dtype);
+    }
+
+    void llaisysQwen2ModelReserveWorkspace(struct LlaisysQwen2Model * model, size_t ntoken) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().reserveWorkspace(ntoken);
+    }
+
+    void llaisysQwen2ModelWorkspaceStats(struct LlaisysQwen2Model * model, struct LlaisysWorkspaceStats * stats) {
+        *stats = reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().workspaceStats();
+    }
+
+    void llaisysQwen2ModelKVSwapOut(struct LlaisysQwen2Model * model, const char *path, size_t npos) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().swapOutKVCache(path, npos);
+    }
+
+    void llaisysQwen2ModelKVSwapIn(struct LlaisysQwen2Model * model) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().swapInKVCache();
+    }
+
+    void llaisysQwen2ModelSetDecodeGraph(struct LlaisysQwen2Model * model, uint8_t enable) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().setDecodeGraph(enable != 0);
+    }
+
+    void llaisysQwen2ModelDecodeGraphStats(struct LlaisysQwen2Model * model, struct LlaisysDecodeGraphStats * stats) {
+        *stats = reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().decodeGraphStats();
+    }
+
+    void llaisysQwen2ModelKVSwapStats(struct LlaisysQwen2Model * model, struct LlaisysKVSwapStats * stats) {
+        *stats = reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().kvSwapStats();
+    }
+
+    void llaisysQwen2ModelSaveSession(struct LlaisysQwen2Model * model, const char *path, size_t pos) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().saveSession(path, pos);
+    }
+
+    int64_t llaisysQwen2ModelLoadSession(struct LlaisysQwen2Model * model, const char *path) {
+        return reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().loadSession(path);
+    }
+
     // 更新：参数包含 pos
     int64_t llaisysQwen2ModelInfer(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t pos) {
-        return reinterpret_cast<llaisys::models::Qwen2 *>(model)->infer(token_ids, ntoken, pos);
+        return reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().infer(token_ids, ntoken, pos);
+    }
+
+    void llaisysQwen2ModelSetSamplingSeed(struct LlaisysQwen2Model * model, uint64_t seed) {
+        reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().setSamplingSeed(seed);
+    }
+
+    int64_t llaisysQwen2ModelInferSampled(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t pos, const LlaisysSamplingParams *params) {
+        return reinterpret_cast<llaisys::models::Qwen2 *>(model)->defaultSession().infer(token_ids, ntoken, pos, params);
+    }
+
+    struct LlaisysQwen2Session *llaisysQwen2SessionCreate(struct LlaisysQwen2Model * model) {
+        auto session = reinterpret_cast<llaisys::models::Qwen2 *>(model)->createSession();
+        return reinterpret_cast<struct LlaisysQwen2Session *>(session.release());
+    }
+
+    void llaisysQwen2SessionDestroy(struct LlaisysQwen2Session * session) {
+        delete reinterpret_cast<llaisys::models::Qwen2Session *>(session);
+    }
+
+    int64_t llaisysQwen2SessionInfer(struct LlaisysQwen2Session * session, int64_t * token_ids, size_t ntoken, size_t pos) {
+        return reinterpret_cast<llaisys::models::Qwen2Session *>(session)->infer(token_ids, ntoken, pos);
+    }
+
+    int64_t llaisysQwen2SessionInferSampled(struct LlaisysQwen2Session * session, int64_t * token_ids, size_t ntoken, size_t pos, const LlaisysSamplingParams *params) {
+        return reinterpret_cast<llaisys::models::Qwen2Session *>(session)->infer(token_ids, ntoken, pos, params);
+    }
+
+    void llaisysQwen2SessionSetSamplingSeed(struct LlaisysQwen2Session * session, uint64_t seed) {
+        reinterpret_cast<llaisys::models::Qwen2Session *>(session)->setSamplingSeed(seed);
     }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "llaisys/runtime.h"
 #include "../core/context/context.hpp"
+#include "../core/thread_pool/thread_pool.hpp"
 #include "../device/runtime_api.hpp"
+#include "../device/cpu/cpu_numa.hpp"
 
 // Llaisys API for setting context runtime.
 __C void llaisysSetContextRuntime(llaisysDeviceType_t device_type, int device_id) {
@@ -10,4 +12,44 @@ __C void llaisysSetContextRuntime(llaisysDeviceType_t device_type, int device_id
 // Llaisys API for getting the runtime APIs
 __C const LlaisysRuntimeAPI *llaisysGetRuntimeAPI(llaisysDeviceType_t device_type) {
     return llaisys::device::getRuntimeAPI(device_type);
-}
\ No newline at end of file
+}
+
+// Llaisys API for the device allocator
+__C void llaisysAllocatorStats(llaisysDeviceType_t device_type, int device_id, LlaisysAllocatorStats *stats) {
+    llaisys::core::context().setDevice(device_type, device_id);
+    *stats = llaisys::core::context().runtime().allocatorStats();
+}
+
+__C void llaisysAllocatorTrim(llaisysDeviceType_t device_type, int device_id) {
+    llaisys::core::context().setDevice(device_type, device_id);
+    llaisys::core::context().runtime().trimAllocator();
+}
+
+__C void llaisysCpuMemoryReport(LlaisysCpuMemoryReport *report) {
+    llaisys::device::cpu::memoryReport(report);
+}
+
+__C int llaisysCpuLockMemory(const void *ptr, size_t size) {
+    return llaisys::device::cpu::lockMemory(ptr, size) ? 0 : -1;
+}
+
+__C void llaisysCpuUnlockMemory(const void *ptr, size_t size) {
+    llaisys::device::cpu::unlockMemory(ptr, size);
+}
+
+__C size_t llaisysCpuNumaReport(LlaisysNumaNodeReport *reports, size_t n, uint8_t measure_bandwidth) {
+    return llaisys::device::cpu::numaReport(reports, n, measure_bandwidth != 0);
+}
+
+__C void llaisysSetThreadPool(size_t nthreads, llaisysThreadAffinity_t affinity) {
+    llaisys::core::ThreadPool::instance().configure(nthreads, affinity);
+}
+
+__C size_t llaisysGetNumThreads() {
+    return llaisys::core::ThreadPool::instance().size();
+}
+
+__C void llaisysCpuPinThreads() {
+    auto &pool = llaisys::core::ThreadPool::instance();
+    pool.configure(pool.size(), LLAISYS_THREAD_AFFINITY_NUMA);
+}
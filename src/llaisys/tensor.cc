@@ -71,6 +71,13 @@ __C {
         tensor->tensor->load(data);
     }
 
+    void tensorLoadAs(
+        llaisysTensor_t tensor,
+        const void *data,
+        llaisysDataType_t dtype) {
+        tensor->tensor->load(data, dtype);
+    }
+
     llaisysTensor_t tensorView(
         llaisysTensor_t tensor,
         size_t * shape,
@@ -93,4 +100,24 @@ __C {
         size_t end) {
         return new LlaisysTensor{tensor->tensor->slice(dim, start, end)};
     }
+
+    llaisysTensor_t tensorContiguous(
+        llaisysTensor_t tensor) {
+        return new LlaisysTensor{tensor->tensor->contiguous()};
+    }
+
+    llaisysTensor_t tensorReshape(
+        llaisysTensor_t tensor,
+        size_t * shape,
+        size_t ndim) {
+        std::vector<size_t> shape_vec(shape, shape + ndim);
+        return new LlaisysTensor{tensor->tensor->reshape(shape_vec)};
+    }
+
+    llaisysTensor_t tensorTo(
+        llaisysTensor_t tensor,
+        llaisysDeviceType_t device_type,
+        int device_id) {
+        return new LlaisysTensor{tensor->tensor->to(device_type, device_id)};
+    }
 }
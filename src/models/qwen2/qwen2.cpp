@@ -2,23 +2,21 @@
 // 新增：引入 LlaisysTensor 的完整定义
 #include "../../llaisys/llaisys_tensor.hpp" 
 
-#include "../../ops/add/op.hpp"
-#include "../../ops/argmax/op.hpp"
-#include "../../ops/embedding/op.hpp"
-#include "../../ops/linear/op.hpp"
-#include "../../ops/rms_norm/op.hpp"
 #include "../../ops/rope/op.hpp"
-#include "../../ops/self_attention/op.hpp"
-#include "../../ops/swiglu/op.hpp"
 #include "../../core/context/context.hpp"
-#include <cmath>
+#include "../../device/cpu/cpu_numa.hpp"
+#include "../safetensors/safetensors.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <stdexcept>
 
 namespace llaisys::models {
 
-using namespace llaisys::ops;
-
 Qwen2::Qwen2(const LlaisysQwen2Meta &meta, llaisysDeviceType_t device_type, int device_id)
-    : _meta(meta), _device_type(device_type), _device_id(device_id) {
+    : _meta(meta), _device_type(device_type), _device_id(device_id), _weights_version(0) {
     
     core::context().setDevice(_device_type, _device_id);
 
@@ -71,15 +69,16 @@ Qwen2::Qwen2(const LlaisysQwen2Meta &meta, llaisysDeviceType_t device_type, int
         _weights.mlp_gate_w[i] = create_tensor_wrapper(new_tensor({meta.hs, meta.di}));
         _weights.mlp_up_w[i] = create_tensor_wrapper(new_tensor({meta.hs, meta.di}));
         _weights.mlp_down_w[i] = create_tensor_wrapper(new_tensor({meta.di, meta.hs}));
-        
-        // Initialize KV Cache
-        auto k_cache = new_tensor({meta.maxseq, meta.nkvh, head_dim});
-        auto v_cache = new_tensor({meta.maxseq, meta.nkvh, head_dim});
-        _kv_cache.push_back({k_cache, v_cache});
     }
+
+    _session = std::make_unique<Qwen2Session>(*this);
 }
 
 Qwen2::~Qwen2() {
+    _session.reset();
+    for (const auto &t : _locked_weights) {
+        device::cpu::unlockMemory(t->data(), t->numel() * t->elementSize());
+    }
     // 这里的 delete 现在可以正常工作了，因为编译器看到了结构体定义
     delete _weights.in_embed;
     delete _weights.out_embed;
@@ -98,118 +97,295 @@ Qwen2::~Qwen2() {
     for(auto t : _mlp_down_w_storage) delete t;
 }
 
-tensor_t Qwen2::new_tensor(const std::vector<size_t>& shape) {
+tensor_t Qwen2::new_tensor(const tensor_shape_t &shape) {
     return Tensor::create(shape, _meta.dtype, _device_type, _device_id);
 }
 
-llaisysTensor_t Qwen2::create_tensor_wrapper(tensor_t t) {
-    return new LlaisysTensor{t};
-}
+// Per-layer weights, named "model.layers.<i>.<suffix>" in Hugging Face checkpoints
+static const std::pair<const char *, llaisysTensor_t *LlaisysQwen2Weights::*> LAYER_WEIGHTS[] = {
+    {"input_layernorm.weight", &LlaisysQwen2Weights::attn_norm_w},
+    {"self_attn.q_proj.weight", &LlaisysQwen2Weights::attn_q_w},
+    {"self_attn.q_proj.bias", &LlaisysQwen2Weights::attn_q_b},
+    {"self_attn.k_proj.weight", &LlaisysQwen2Weights::attn_k_w},
+    {"self_attn.k_proj.bias", &LlaisysQwen2Weights::attn_k_b},
+    {"self_attn.v_proj.weight", &LlaisysQwen2Weights::attn_v_w},
+    {"self_attn.v_proj.bias", &LlaisysQwen2Weights::attn_v_b},
+    {"self_attn.o_proj.weight", &LlaisysQwen2Weights::attn_o_w},
+    {"post_attention_layernorm.weight", &LlaisysQwen2Weights::mlp_norm_w},
+    {"mlp.gate_proj.weight", &LlaisysQwen2Weights::mlp_gate_w},
+    {"mlp.up_proj.weight", &LlaisysQwen2Weights::mlp_up_w},
+    {"mlp.down_proj.weight", &LlaisysQwen2Weights::mlp_down_w},
+};
 
-int64_t Qwen2::infer(int64_t *token_ids, size_t ntoken, size_t pos) {
-    core::context().setDevice(_device_type, _device_id);
+// Every checkpoint name the model loads
+static std::vector<std::string> weight_names(size_t nlayer) {
+    std::vector<std::string> names = {"model.embed_tokens.weight", "lm_head.weight", "model.norm.weight"};
+    for (size_t i = 0; i < nlayer; ++i) {
+        for (const auto &[suffix, field] : LAYER_WEIGHTS) {
+            names.push_back("model.layers." + std::to_string(i) + "." + suffix);
+        }
+    }
+    return names;
+}
 
-    size_t seq_len = ntoken;
-    size_t head_dim = _meta.di / _meta.nh;
-    
-    // Inputs
-    auto input_ids_t = Tensor::create({seq_len}, LLAISYS_DTYPE_I64, _device_type, _device_id);
-    auto pos_ids_t = Tensor::create({seq_len}, LLAISYS_DTYPE_I64, _device_type, _device_id);
-    
-    input_ids_t->load(token_ids);
-    std::vector<int64_t> pos_vec(seq_len);
-    for(size_t i=0; i<seq_len; ++i) pos_vec[i] = pos + i;
-    pos_ids_t->load(pos_vec.data());
-
-    // 1. Embedding
-    auto hidden_states = new_tensor({seq_len, _meta.di});
-    embedding(hidden_states, input_ids_t, _weights.in_embed->tensor);
-
-    // 2. Layers
-    for (size_t i = 0; i < _meta.nlayer; ++i) {
-        auto residual = hidden_states;
-        auto norm_out = new_tensor({seq_len, _meta.di});
-        
-        // Attention Block
-        rms_norm(norm_out, hidden_states, _weights.attn_norm_w[i]->tensor, _meta.epsilon);
-        
-        auto q = new_tensor({seq_len, _meta.nh * head_dim});
-        auto k = new_tensor({seq_len, _meta.nkvh * head_dim});
-        auto v = new_tensor({seq_len, _meta.nkvh * head_dim});
-        
-        linear(q, norm_out, _weights.attn_q_w[i]->tensor, _weights.attn_q_b[i]->tensor);
-        linear(k, norm_out, _weights.attn_k_w[i]->tensor, _weights.attn_k_b[i]->tensor);
-        linear(v, norm_out, _weights.attn_v_w[i]->tensor, _weights.attn_v_b[i]->tensor);
+llaisysTensor_t Qwen2::weight_handle(const std::string &name) {
+    if (name == "model.embed_tokens.weight") {
+        return _weights.in_embed;
+    }
+    if (name == "lm_head.weight") {
+        return _weights.out_embed;
+    }
+    if (name == "model.norm.weight") {
+        return _weights.out_norm_w;
+    }
+    // model.layers.<i>.<rest>
+    static const std::string prefix = "model.layers.";
+    if (name.compare(0, prefix.size(), prefix) != 0) {
+        return nullptr;
+    }
+    size_t pos = prefix.size(), layer = 0;
+    if (pos == name.size() || !std::isdigit(static_cast<unsigned char>(name[pos]))) {
+        return nullptr;
+    }
+    while (pos < name.size() && std::isdigit(static_cast<unsigned char>(name[pos]))) {
+        layer = layer * 10 + static_cast<size_t>(name[pos++] - '0');
+    }
+    if (layer >= _meta.nlayer || pos == name.size() || name[pos] != '.') {
+        return nullptr;
+    }
+    const char *rest = name.c_str() + pos + 1;
+    for (const auto &[suffix, field] : LAYER_WEIGHTS) {
+        if (std::strcmp(rest, suffix) == 0) {
+            return (_weights.*field)[layer];
+        }
+    }
+    return nullptr;
+}
 
-        q = q->view({seq_len, _meta.nh, head_dim});
-        k = k->view({seq_len, _meta.nkvh, head_dim});
-        v = v->view({seq_len, _meta.nkvh, head_dim});
+bool Qwen2::loadSafetensors(const std::vector<std::string> &paths, llaisysWeightPrefetch_t prefetch,
+                            LlaisysWeightLoadStats *stats) {
+    auto start = std::chrono::steady_clock::now();
+    LlaisysWeightLoadStats s{};
+    try {
+        if (prefetch != LLAISYS_WEIGHT_PREFETCH_NONE && prefetch != LLAISYS_WEIGHT_PREFETCH_ASYNC
+            && prefetch != LLAISYS_WEIGHT_PREFETCH_POPULATE) {
+            throw std::runtime_error("unknown weight prefetch mode");
+        }
+        core::context().setDevice(_device_type, _device_id);
+        const bool tied = _weights.out_embed->tensor == _weights.in_embed->tensor;
 
-        rope(q, q, pos_ids_t, _meta.theta);
-        rope(k, k, pos_ids_t, _meta.theta);
+        // Open (and start reading) every file before binding, so readahead of the later
+        // shards overlaps with work on the earlier ones.
+        std::vector<std::unique_ptr<SafetensorsFile>> files;
+        for (const auto &path : paths) {
+            files.push_back(SafetensorsFile::open(path));
+            if (prefetch == LLAISYS_WEIGHT_PREFETCH_ASYNC) {
+                files.back()->prefetchAsync();
+            } else if (prefetch == LLAISYS_WEIGHT_PREFETCH_POPULATE) {
+                files.back()->populate();
+            }
+        }
 
-        // Update KV Cache
-        auto& k_cache = _kv_cache[i].first;
-        auto& v_cache = _kv_cache[i].second;
-        
-        auto k_slot = k_cache->slice(0, pos, pos + seq_len);
-        auto v_slot = v_cache->slice(0, pos, pos + seq_len);
-        
-        core::context().runtime().api()->memcpy_sync(
-            k_slot->data(), k->data(), k->numel() * k->elementSize(), LLAISYS_MEMCPY_D2D);
-        core::context().runtime().api()->memcpy_sync(
-            v_slot->data(), v->data(), v->numel() * v->elementSize(), LLAISYS_MEMCPY_D2D);
-        
-        // Full KV for attention
-        auto k_full = k_cache->slice(0, 0, pos + seq_len);
-        auto v_full = v_cache->slice(0, 0, pos + seq_len);
+        // Check the whole checkpoint before touching a weight, so a bad one leaves the model as it was
+        struct Source {
+            llaisysTensor_t handle;
+            const SafetensorsFile *file;
+            const SafetensorsFile::Entry *entry;
+        };
+        std::map<std::string, Source> sources;
+        for (const auto &file : files) {
+            for (const auto &[name, e] : file->entries()) {
+                llaisysTensor_t h = weight_handle(name);
+                if (h == nullptr || (tied && h == _weights.out_embed)) {
+                    continue;
+                }
+                auto seen = sources.find(name);
+                if (seen != sources.end()) {
+                    throw std::runtime_error(file->path() + ": " + name + " is also in " + seen->second.file->path());
+                }
+                if (e.shape != h->tensor->shape()) {
+                    throw std::runtime_error(file->path() + ": " + name + " does not have the model's shape");
+                }
+                if (e.dtype != LLAISYS_DTYPE_F32 && e.dtype != LLAISYS_DTYPE_F16 && e.dtype != LLAISYS_DTYPE_BF16) {
+                    throw std::runtime_error(file->path() + ": " + name + " has an unsupported dtype");
+                }
+                sources.emplace(name, Source{h, file.get(), &e});
+            }
+        }
+        for (const auto &name : weight_names(_meta.nlayer)) {
+            if (!(tied && name == "lm_head.weight") && sources.find(name) == sources.end()) {
+                throw std::runtime_error("the checkpoint has no " + name);
+            }
+        }
 
-        // Attention
-        auto attn_out = new_tensor({seq_len, _meta.nh, head_dim});
-        float scale = 1.0f / sqrtf((float)head_dim);
-        self_attention(attn_out, q, k_full, v_full, scale);
+        // Copies go into the model's buffers; handles are only re-pointed (to views, or to
+        // fresh buffers replacing earlier views) once every weight has made it.
+        std::vector<std::pair<llaisysTensor_t, tensor_t>> rebind;
+        for (const auto &[name, src] : sources) {
+            const auto &e = *src.entry;
+            // A view needs the model's dtype, host memory and element-aligned data
+            if (e.dtype == _meta.dtype && _device_type == LLAISYS_DEVICE_CPU
+                && reinterpret_cast<uintptr_t>(src.file->data(e)) % utils::dsize(e.dtype) == 0) {
+                rebind.emplace_back(src.handle, src.file->view(e));
+                s.mapped++;
+                s.mapped_bytes += e.bytes;
+            } else {
+                tensor_t dst = src.handle->tensor;
+                if (dst->isReadOnly()) {
+                    dst = new_tensor(e.shape);
+                    rebind.emplace_back(src.handle, dst);
+                }
+                dst->load(src.file->data(e), e.dtype);
+                s.copied++;
+                s.copied_bytes += e.bytes;
+            }
+        }
+        for (auto &[h, t] : rebind) {
+            h->tensor = std::move(t);
+        }
+        if (tied) {
+            _weights.out_embed->tensor = _weights.in_embed->tensor;
+        }
+        if (!relock_weights()) {
+            std::cerr << "[WARNING] Qwen2: could not lock all of the reloaded weights" << std::endl;
+        }
+    } catch (const std::exception &err) {
+        std::cerr << "[ERROR] Qwen2: " << err.what() << std::endl;
+        return false;
+    }
+    _weights_version++;
+    // The buffers replaced by views are cached by the allocator; give them back
+    core::context().runtime().trimAllocator();
+    s.load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (stats) {
+        *stats = s;
+    }
+    return true;
+}
 
-        attn_out = attn_out->view({seq_len, _meta.di});
-        auto linear_out = new_tensor({seq_len, _meta.di});
-        linear(linear_out, attn_out, _weights.attn_o_w[i]->tensor, nullptr);
+void Qwen2::tieEmbeddings() {
+    // Both handles stay valid (and are freed separately); only the storage is shared.
+    _weights.out_embed->tensor = _weights.in_embed->tensor;
+    relock_weights();
+    _weights_version++;
+}
 
-        add(hidden_states, residual, linear_out);
+std::vector<llaisysTensor_t> Qwen2::weight_handles() const {
+    std::vector<llaisysTensor_t> handles = {_weights.in_embed, _weights.out_embed, _weights.out_norm_w};
+    for (const auto *storage : {&_attn_norm_w_storage, &_attn_q_w_storage, &_attn_q_b_storage, &_attn_k_w_storage,
+                                &_attn_k_b_storage, &_attn_v_w_storage, &_attn_v_b_storage, &_attn_o_w_storage,
+                                &_mlp_norm_w_storage, &_mlp_gate_w_storage, &_mlp_up_w_storage,
+                                &_mlp_down_w_storage}) {
+        handles.insert(handles.end(), storage->begin(), storage->end());
+    }
+    return handles;
+}
 
-        // MLP Block
-        residual = hidden_states;
-        rms_norm(norm_out, hidden_states, _weights.mlp_norm_w[i]->tensor, _meta.epsilon);
-        
-        auto gate = new_tensor({seq_len, _meta.hs});
-        auto up = new_tensor({seq_len, _meta.hs});
-        linear(gate, norm_out, _weights.mlp_gate_w[i]->tensor, nullptr);
-        linear(up, norm_out, _weights.mlp_up_w[i]->tensor, nullptr);
-        
-        swiglu(gate, gate, up);
-        
-        auto down_out = new_tensor({seq_len, _meta.di});
-        linear(down_out, gate, _weights.mlp_down_w[i]->tensor, nullptr);
+bool Qwen2::lockWeights() {
+    CHECK_ARGUMENT(_device_type == LLAISYS_DEVICE_CPU, "Qwen2: only CPU weights can be locked.");
+    _weights_locked = true;
+    bool ok = true;
+    for (auto *h : weight_handles()) {
+        const tensor_t &t = h->tensor;
+        // Tied embeddings share one buffer; lock it once.
+        if (std::find(_locked_weights.begin(), _locked_weights.end(), t) != _locked_weights.end()) {
+            continue;
+        }
+        if (device::cpu::lockMemory(t->data(), t->numel() * t->elementSize())) {
+            _locked_weights.push_back(t);
+        } else {
+            ok = false;
+        }
+    }
+    return ok;
+}
 
-        add(hidden_states, residual, down_out);
+bool Qwen2::relock_weights() {
+    if (!_weights_locked) {
+        return true;
     }
+    auto handles = weight_handles();
+    auto in_use = [&](const tensor_t &t) {
+        return std::any_of(handles.begin(), handles.end(), [&](llaisysTensor_t h) { return h->tensor == t; });
+    };
+    // Unlock first, so buffers on their way out do not count against RLIMIT_MEMLOCK
+    for (auto it = _locked_weights.begin(); it != _locked_weights.end();) {
+        if (in_use(*it)) {
+            ++it;
+        } else {
+            device::cpu::unlockMemory((*it)->data(), (*it)->numel() * (*it)->elementSize());
+            it = _locked_weights.erase(it);
+        }
+    }
+    return lockWeights();
+}
 
-    // 3. Final Norm
-    rms_norm(hidden_states, hidden_states, _weights.out_norm_w->tensor, _meta.epsilon);
+void Qwen2::placeWeights(llaisysNumaPlacement_t placement) {
+    CHECK_ARGUMENT(_device_type == LLAISYS_DEVICE_CPU, "Qwen2: NUMA placement applies to CPU weights only.");
+    CHECK_ARGUMENT(placement == LLAISYS_NUMA_LOCAL || placement == LLAISYS_NUMA_INTERLEAVE
+                       || placement == LLAISYS_NUMA_PARTITION,
+                   "Qwen2: unknown NUMA placement.");
+    auto bytes = [](const tensor_t &t) { return t->numel() * t->elementSize(); };
+    auto place = [&](llaisysTensor_t h, bool partition) {
+        const tensor_t &t = h->tensor;
+        if (placement == LLAISYS_NUMA_LOCAL) {
+            device::cpu::bindMemory(t->data(), bytes(t), _device_id);
+        } else if (placement == LLAISYS_NUMA_PARTITION && partition) {
+            // Row block i goes to node i; linear gives pool thread t the t-th equal row
+            // block, so under NUMA affinity the threads on node i read exactly this block.
+            size_t nnode = device::cpu::numaNodes().size();
+            size_t rows = t->shape()[0], row_bytes = bytes(t) / rows;
+            for (size_t i = 0; i < nnode; ++i) {
+                size_t lo = rows * i / nnode, hi = rows * (i + 1) / nnode;
+                device::cpu::bindMemory(t->data() + lo * row_bytes, (hi - lo) * row_bytes, static_cast<int>(i));
+            }
+        } else {
+            device::cpu::interleaveMemory(t->data(), bytes(t));
+        }
+    };
+    // Embedding rows are gathered at random and the LM head is sharded dynamically: interleave those.
+    place(_weights.in_embed, false);
+    if (_weights.out_embed->tensor != _weights.in_embed->tensor) {
+        place(_weights.out_embed, false);
+    }
+    place(_weights.out_norm_w, false);
+    for (const auto *storage : {&_attn_norm_w_storage, &_attn_q_b_storage, &_attn_k_b_storage, &_attn_v_b_storage,
+                                &_mlp_norm_w_storage}) {
+        for (auto *h : *storage) {
+            place(h, false);
+        }
+    }
+    for (const auto *storage : {&_attn_q_w_storage, &_attn_k_w_storage, &_attn_v_w_storage, &_attn_o_w_storage,
+                                &_mlp_gate_w_storage, &_mlp_up_w_storage, &_mlp_down_w_storage}) {
+        for (auto *h : *storage) {
+            place(h, true);
+        }
+    }
+}
 
-    // 4. Head
-    auto last_hidden = hidden_states->slice(0, seq_len - 1, seq_len);
-    auto logits = new_tensor({1, _meta.voc});
-    linear(logits, last_hidden, _weights.out_embed->tensor, nullptr); 
+void Qwen2::ropeTables(size_t npos, tensor_t &cos, tensor_t &sin) const {
+    std::lock_guard<std::mutex> lock(_rope_mutex);
+    size_t cached = _rope_cos ? _rope_cos->shape()[0] : 0;
+    if (npos > cached) {
+        // Grow geometrically so a long decode rebuilds the table only a few times.
+        size_t capacity = std::min(_meta.maxseq, std::max({npos, 2 * cached, size_t(256)}));
+        size_t head_dim = _meta.di / _meta.nh;
+        auto new_cos = Tensor::create({capacity, head_dim / 2}, LLAISYS_DTYPE_F32, _device_type, _device_id);
+        auto new_sin = Tensor::create({capacity, head_dim / 2}, LLAISYS_DTYPE_F32, _device_type, _device_id);
+        ops::rope_table(new_cos, new_sin, _meta.theta);
+        _rope_cos = new_cos;
+        _rope_sin = new_sin;
+    }
+    cos = _rope_cos;
+    sin = _rope_sin;
+}
 
-    // 5. Argmax
-    auto max_idx = Tensor::create({1}, LLAISYS_DTYPE_I64, _device_type, _device_id);
-    auto max_val = new_tensor({1});
-    argmax(max_idx, max_val, logits);
-    
-    int64_t result_token;
-    core::context().runtime().api()->memcpy_sync(
-        &result_token, max_idx->data(), sizeof(int64_t), LLAISYS_MEMCPY_D2H);
+std::unique_ptr<Qwen2Session> Qwen2::createSession() const {
+    return std::make_unique<Qwen2Session>(*this, _session.get());
+}
 
-    return result_token;
+llaisysTensor_t Qwen2::create_tensor_wrapper(tensor_t t) {
+    return new LlaisysTensor{t};
 }
 
-} // namespace llaisys::models
\ No newline at end of file
+} // namespace llaisys::models
@@ -1,19 +1,58 @@
 #pragma once
 #include "llaisys/models/qwen2.h"
+#include "qwen2_session.hpp"
 #include "../../tensor/tensor.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 namespace llaisys::models {
 
+// The weights of a Qwen2 model, shared read-only by its sessions (see Qwen2Session).
+//
+// Loading, tying, locking and placing the weights must be done before any session runs.
+// The model also owns a default session, which the single-conversation C API drives.
 class Qwen2 {
 public:
     Qwen2(const LlaisysQwen2Meta &meta, llaisysDeviceType_t device_type, int device_id);
     ~Qwen2();
 
     LlaisysQwen2Weights *weights() { return &_weights; }
-    
-    // 更新：增加 pos 参数
-    int64_t infer(int64_t *token_ids, size_t ntoken, size_t pos);
+    const LlaisysQwen2Weights &weights() const { return _weights; }
+    const LlaisysQwen2Meta &meta() const { return _meta; }
+    llaisysDeviceType_t deviceType() const { return _device_type; }
+    int deviceId() const { return _device_id; }
+
+    // Binds or loads the weights from .safetensors files (see llaisysQwen2ModelLoadSafetensors).
+    bool loadSafetensors(const std::vector<std::string> &paths, llaisysWeightPrefetch_t prefetch,
+                         LlaisysWeightLoadStats *stats);
+
+    // tie_word_embeddings: out_embed reuses in_embed's storage and drops its own.
+    void tieEmbeddings();
+    // Bumped whenever a weight handle is re-pointed (tieEmbeddings, loadSafetensors); sessions
+    // drop decode graphs captured against an older version.
+    uint64_t weightsVersion() const { return _weights_version.load(); }
+
+    // CPU only: mlocks every weight buffer so it is never swapped out. Returns false if the
+    // kernel refused part of it (RLIMIT_MEMLOCK); what did lock stays locked until destruction.
+    // Once locked, weights re-pointed by loadSafetensors or tieEmbeddings are locked in turn
+    // and the buffers they replace unlocked.
+    bool lockWeights();
+
+    // CPU only: NUMA placement of the weights (see llaisysNumaPlacement_t).
+    void placeWeights(llaisysNumaPlacement_t placement);
+
+    // RoPE cos/sin tables covering at least `npos` positions ([n, dh / 2] F32), shared by all
+    // sessions and grown on demand up to maxseq. Thread-safe; a grown table is a new pair,
+    // so the ones handed out earlier stay valid.
+    void ropeTables(size_t npos, tensor_t &cos, tensor_t &sin) const;
+
+    Qwen2Session &defaultSession() { return *_session; }
+    // A new session with the default session's KV layout, residual dtype and decode-graph switch
+    std::unique_ptr<Qwen2Session> createSession() const;
 
 private:
     LlaisysQwen2Meta _meta;
@@ -21,11 +60,15 @@ private:
     int _device_id;
 
     LlaisysQwen2Weights _weights;
-    
-    // KV Cache: [layer][k/v]
-    std::vector<std::pair<tensor_t, tensor_t>> _kv_cache;
-    
-    // 移除 _cur_pos，因为位置现在由调用者管理
+    std::atomic<uint64_t> _weights_version;
+
+    // Weights pinned by lockWeights, held so they can be unlocked on destruction
+    std::vector<tensor_t> _locked_weights;
+    bool _weights_locked = false;
+
+    mutable std::mutex _rope_mutex;
+    mutable tensor_t _rope_cos;
+    mutable tensor_t _rope_sin;
 
     // 权重存储容器
     std::vector<llaisysTensor_t> _attn_norm_w_storage;
@@ -41,8 +84,17 @@ private:
     std::vector<llaisysTensor_t> _mlp_up_w_storage;
     std::vector<llaisysTensor_t> _mlp_down_w_storage;
 
+    std::unique_ptr<Qwen2Session> _session;
+
     llaisysTensor_t create_tensor_wrapper(tensor_t t);
-    tensor_t new_tensor(const std::vector<size_t>& shape);
+    tensor_t new_tensor(const tensor_shape_t &shape);
+    // The handle a checkpoint tensor name loads into, or nullptr for names the model does not use
+    llaisysTensor_t weight_handle(const std::string &name);
+    // Every weight handle (in and out embeddings both, even when tied)
+    std::vector<llaisysTensor_t> weight_handles() const;
+    // After handles were re-pointed: unlocks the locked buffers no handle uses any more and
+    // locks the new ones. A no-op unless lockWeights was called.
+    bool relock_weights();
 };
 
 } // namespace llaisys::models
\ No newline at end of file
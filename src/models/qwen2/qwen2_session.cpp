@@ -0,0 +1,557 @@
+#include "qwen2_session.hpp"
+#include "qwen2.hpp"
+
+#include "../../ops/add_rms_norm/op.hpp"
+#include "../../ops/embedding/op.hpp"
+#include "../../ops/linear/op.hpp"
+#include "../../ops/lm_head_topk/op.hpp"
+#include "../../ops/rearrange/op.hpp"
+#include "../../ops/rms_norm/op.hpp"
+#include "../../ops/rope/op.hpp"
+#include "../../ops/self_attention/op.hpp"
+#include "../../ops/swiglu/op.hpp"
+#include "../../core/context/context.hpp"
+#include "../../device/runtime_api.hpp"
+#include "../../llaisys/llaisys_tensor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace llaisys::models {
+
+using namespace llaisys::ops;
+
+Qwen2Session::Qwen2Session(const Qwen2 &model, const Qwen2Session *settings)
+    : _model(model), _meta(model.meta()), _device_type(model.deviceType()), _device_id(model.deviceId()),
+      _weights(model.weights()),
+      _kv_layout(settings ? settings->_kv_layout : LLAISYS_KV_LAYOUT_TOKEN_MAJOR),
+      _residual_dtype(settings ? settings->_residual_dtype : _meta.dtype), _kv_swap_npos(0),
+      _kv_swap_pending(false), _kv_swap_stats{},
+      _sampler(std::chrono::steady_clock::now().time_since_epoch().count()), _ws_tokens(0), _ws{},
+      _graph_enabled(settings ? settings->_graph_enabled : true), _graph_pos(0), _graph_full_logits(false),
+      _graph_stats{}, _graph_weights_version(model.weightsVersion()) {
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+    _copy_stream = api->create_stream();
+    _kv_swap_event = api->create_event();
+    init_kv_cache();
+}
+
+Qwen2Session::~Qwen2Session() {
+    // Copies in flight still write into the KV cache. A copy that failed has nowhere to be
+    // reported from a destructor, so its rethrown error is dropped.
+    auto api = device::getRuntimeAPI(_device_type);
+    try {
+        api->stream_synchronize(_copy_stream);
+    } catch (...) {
+    }
+    api->destroy_event(_kv_swap_event);
+    api->destroy_stream(_copy_stream);
+}
+
+tensor_t Qwen2Session::new_kv_cache_tensor() {
+    size_t head_dim = _meta.di / _meta.nh;
+    if (_kv_layout == LLAISYS_KV_LAYOUT_HEAD_MAJOR) {
+        // Stored as [nkvh, maxseq, dh] and permuted back, so slicing by position works the same.
+        return Tensor::create({_meta.nkvh, _meta.maxseq, head_dim}, _meta.dtype, _device_type, _device_id)
+            ->permute({1, 0, 2});
+    }
+    return Tensor::create({_meta.maxseq, _meta.nkvh, head_dim}, _meta.dtype, _device_type, _device_id);
+}
+
+void Qwen2Session::init_kv_cache() {
+    _decode_graph.clear();
+    _kv_cache.clear();
+    for (size_t i = 0; i < _meta.nlayer; ++i) {
+        auto k_cache = new_kv_cache_tensor();
+        auto v_cache = new_kv_cache_tensor();
+        _kv_cache.push_back({k_cache, v_cache});
+    }
+}
+
+void Qwen2Session::ensure_rope_table(size_t npos) {
+    if (_rope_cos && npos <= _rope_cos->shape()[0]) {
+        return;
+    }
+    _decode_graph.clear();
+    _model.ropeTables(npos, _rope_cos, _rope_sin);
+}
+
+void Qwen2Session::setKVCacheLayout(llaisysKVCacheLayout_t layout) {
+    CHECK_ARGUMENT(layout == LLAISYS_KV_LAYOUT_TOKEN_MAJOR || layout == LLAISYS_KV_LAYOUT_HEAD_MAJOR,
+                   "Qwen2: unknown KV cache layout.");
+    if (layout == _kv_layout) {
+        return;
+    }
+    core::context().setDevice(_device_type, _device_id);
+    // A swapped-out cache belongs to the old layout: drop it.
+    if (_kv_swap_pending) {
+        core::context().runtime().api()->event_synchronize(_kv_swap_event);
+        _kv_swap_pending = false;
+    }
+    _kv_swap_file.reset();
+    _kv_layout = layout;
+    _kv_cache.clear(); // release the old cache before allocating the new one
+    init_kv_cache();
+}
+
+void Qwen2Session::setResidualDtype(llaisysDataType_t dtype) {
+    CHECK_ARGUMENT(dtype == _meta.dtype || dtype == LLAISYS_DTYPE_F32,
+                   "Qwen2: residual dtype must be the model dtype or F32.");
+    if (dtype != _residual_dtype) {
+        _residual_dtype = dtype;
+        _ws_tokens = 0; // residual buffers change size: replan on the next call
+    }
+}
+
+// Calls fn(ptr, bytes) on each dense run holding the first npos positions of a
+// [maxseq, nkvh, dh] cache view, in physical order.
+template <typename Fn>
+static void for_each_kv_run(const tensor_t &cache, size_t npos, Fn fn) {
+    if (npos == 0) {
+        return;
+    }
+    const auto &shape = cache->shape();
+    const auto &strides = cache->strides();
+    size_t esize = cache->elementSize();
+    if (strides[1] > strides[0]) {
+        // Head-major: the positions of each head are contiguous.
+        for (size_t h = 0; h < shape[1]; ++h) {
+            fn(cache->data() + h * strides[1] * esize, npos * shape[2] * esize);
+        }
+    } else {
+        fn(cache->data(), npos * shape[1] * shape[2] * esize);
+    }
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Qwen2Session::swapOutKVCache(const std::string &path, size_t npos) {
+    core::context().setDevice(_device_type, _device_id);
+    wait_kv_cache();
+    CHECK_ARGUMENT(npos <= _meta.maxseq, "Qwen2: swap-out positions exceed the KV cache.");
+    auto start = std::chrono::steady_clock::now();
+
+    size_t head_dim = _meta.di / _meta.nh;
+    size_t cache_bytes = npos * _meta.nkvh * head_dim * utils::dsize(_meta.dtype);
+    auto file = utils::MappedFile::create(path, 2 * _meta.nlayer * cache_bytes);
+    file->unlinkOnClose();
+
+    // The file keeps the cache's physical order; it is only ever read back by this model.
+    std::byte *dst = file->data();
+    auto api = core::context().runtime().api();
+    for (auto &kv : _kv_cache) {
+        for (auto &cache : {kv.first, kv.second}) {
+            for_each_kv_run(cache, npos, [&](std::byte *src, size_t bytes) {
+                api->memcpy_sync(dst, src, bytes, LLAISYS_MEMCPY_D2H);
+                dst += bytes;
+            });
+        }
+    }
+    file->flushAsync();
+
+    // Own the file before dropping the cache, so a failure below still leaves it restorable
+    _kv_swap_file = std::move(file);
+    _kv_swap_npos = npos;
+    _kv_cache.clear();
+    // The allocator caches freed blocks; hand the cache's segments back to the device
+    core::context().runtime().trimAllocator();
+
+    double ms = elapsed_ms(start);
+    _kv_swap_stats.swap_out_count++;
+    _kv_swap_stats.swap_out_bytes += _kv_swap_file->size();
+    _kv_swap_stats.last_swap_out_ms = ms;
+    _kv_swap_stats.total_swap_out_ms += ms;
+}
+
+void Qwen2Session::swapInKVCache() {
+    if (!_kv_swap_file || _kv_swap_pending) {
+        return; // nothing swapped out, or already restoring
+    }
+    core::context().setDevice(_device_type, _device_id);
+    init_kv_cache();
+
+    // Allocation happens here, on the caller's thread; the copy stream only copies.
+    auto api = core::context().runtime().api();
+    const std::byte *src = _kv_swap_file->data();
+    _kv_swap_start = std::chrono::steady_clock::now();
+    for (auto &kv : _kv_cache) {
+        for (auto &cache : {kv.first, kv.second}) {
+            for_each_kv_run(cache, _kv_swap_npos, [&](std::byte *dst, size_t bytes) {
+                api->memcpy_async(dst, src, bytes, LLAISYS_MEMCPY_H2D, _copy_stream);
+                src += bytes;
+            });
+        }
+    }
+    api->launch_host_func(
+        _copy_stream, [](void *session) { static_cast<Qwen2Session *>(session)->_kv_swap_done = std::chrono::steady_clock::now(); },
+        this);
+    api->event_record(_kv_swap_event, _copy_stream);
+    _kv_swap_pending = true;
+}
+
+void Qwen2Session::wait_kv_cache() {
+    if (_kv_swap_file && !_kv_swap_pending) {
+        swapInKVCache();
+    }
+    if (_kv_swap_pending) {
+        core::context().runtime().api()->event_synchronize(_kv_swap_event);
+        _kv_swap_pending = false;
+        double ms = std::chrono::duration<double, std::milli>(_kv_swap_done - _kv_swap_start).count();
+        _kv_swap_stats.swap_in_count++;
+        _kv_swap_stats.swap_in_bytes += _kv_swap_file->size();
+        _kv_swap_stats.last_swap_in_ms = ms;
+        _kv_swap_stats.total_swap_in_ms += ms;
+        _kv_swap_file.reset();
+    }
+}
+
+// On-disk layout of a session snapshot: this header followed by, for every layer,
+// K then V as dense [pos, nkvh, dh] arrays of meta.dtype.
+struct SessionSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint64_t nlayer, hs, nh, nkvh, dh, di, voc;
+    float epsilon, theta;
+    uint64_t pos;
+};
+
+static constexpr char SESSION_SNAPSHOT_MAGIC[8] = {'L', 'L', 'A', 'I', 'S', 'Y', 'S', 'K'};
+static constexpr uint32_t SESSION_SNAPSHOT_VERSION = 1;
+
+// Copies the first npos positions of a [maxseq, nkvh, dh] cache view to (or from) a
+// dense [npos, nkvh, dh] host buffer.
+static void copy_kv_positions(const tensor_t &cache, size_t npos, std::byte *host, bool to_host) {
+    const auto &shape = cache->shape();
+    const auto &strides = cache->strides();
+    size_t esize = cache->elementSize();
+    size_t row_bytes = shape[2] * esize;
+    auto api = core::context().runtime().api();
+    auto kind = to_host ? LLAISYS_MEMCPY_D2H : LLAISYS_MEMCPY_H2D;
+    if (strides[0] == static_cast<ptrdiff_t>(shape[1] * shape[2]) && strides[1] == static_cast<ptrdiff_t>(shape[2])) {
+        size_t bytes = npos * shape[1] * row_bytes;
+        return to_host ? api->memcpy_sync(host, cache->data(), bytes, kind)
+                       : api->memcpy_sync(cache->data(), host, bytes, kind);
+    }
+    for (size_t t = 0; t < npos; ++t) {
+        for (size_t h = 0; h < shape[1]; ++h) {
+            std::byte *dev = cache->data() + (t * strides[0] + h * strides[1]) * esize;
+            std::byte *row = host + (t * shape[1] + h) * row_bytes;
+            to_host ? api->memcpy_sync(row, dev, row_bytes, kind) : api->memcpy_sync(dev, row, row_bytes, kind);
+        }
+    }
+}
+
+void Qwen2Session::saveSession(const std::string &path, size_t pos) {
+    core::context().setDevice(_device_type, _device_id);
+    wait_kv_cache();
+    CHECK_ARGUMENT(pos <= _meta.maxseq, "Qwen2: session positions exceed the KV cache.");
+
+    SessionSnapshotHeader header{};
+    std::memcpy(header.magic, SESSION_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SESSION_SNAPSHOT_VERSION;
+    header.dtype = static_cast<uint32_t>(_meta.dtype);
+    header.nlayer = _meta.nlayer;
+    header.hs = _meta.hs;
+    header.nh = _meta.nh;
+    header.nkvh = _meta.nkvh;
+    header.dh = _meta.dh;
+    header.di = _meta.di;
+    header.voc = _meta.voc;
+    header.epsilon = _meta.epsilon;
+    header.theta = _meta.theta;
+    header.pos = pos;
+
+    size_t head_dim = _meta.di / _meta.nh;
+    size_t cache_bytes = pos * _meta.nkvh * head_dim * utils::dsize(_meta.dtype);
+    auto file = utils::MappedFile::create(path, sizeof(header) + 2 * _meta.nlayer * cache_bytes);
+    std::memcpy(file->data(), &header, sizeof(header));
+    std::byte *dst = file->data() + sizeof(header);
+    for (auto &kv : _kv_cache) {
+        copy_kv_positions(kv.first, pos, dst, true);
+        copy_kv_positions(kv.second, pos, dst + cache_bytes, true);
+        dst += 2 * cache_bytes;
+    }
+}
+
+int64_t Qwen2Session::loadSession(const std::string &path) {
+    core::context().setDevice(_device_type, _device_id);
+    wait_kv_cache();
+
+    std::unique_ptr<utils::MappedFile> file;
+    try {
+        file = utils::MappedFile::open(path);
+    } catch (const std::exception &err) {
+        std::cerr << "[ERROR] Qwen2: " << err.what() << std::endl;
+        return -1;
+    }
+    SessionSnapshotHeader header{};
+    if (file->size() < sizeof(header)) {
+        std::cerr << "[ERROR] Qwen2: " << path << " is not a session snapshot." << std::endl;
+        return -1;
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    bool valid = std::memcmp(header.magic, SESSION_SNAPSHOT_MAGIC, sizeof(header.magic)) == 0
+              && header.version == SESSION_SNAPSHOT_VERSION
+              && header.dtype == static_cast<uint32_t>(_meta.dtype)
+              && header.nlayer == _meta.nlayer && header.hs == _meta.hs
+              && header.nh == _meta.nh && header.nkvh == _meta.nkvh
+              && header.dh == _meta.dh && header.di == _meta.di && header.voc == _meta.voc
+              && header.epsilon == _meta.epsilon && header.theta == _meta.theta
+              && header.pos <= _meta.maxseq;
+    size_t head_dim = _meta.di / _meta.nh;
+    size_t cache_bytes = header.pos * _meta.nkvh * head_dim * utils::dsize(_meta.dtype);
+    if (!valid || file->size() != sizeof(header) + 2 * _meta.nlayer * cache_bytes) {
+        std::cerr << "[ERROR] Qwen2: session snapshot " << path << " does not match this model." << std::endl;
+        return -1;
+    }
+
+    std::byte *src = file->data() + sizeof(header);
+    for (auto &kv : _kv_cache) {
+        copy_kv_positions(kv.first, header.pos, src, false);
+        copy_kv_positions(kv.second, header.pos, src + cache_bytes, false);
+        src += 2 * cache_bytes;
+    }
+    return static_cast<int64_t>(header.pos);
+}
+
+void Qwen2Session::reserveWorkspace(size_t ntoken) {
+    ntoken = std::min(std::max(ntoken, size_t(1)), _meta.maxseq);
+    if (ntoken <= _ws_tokens) {
+        return;
+    }
+    // Steps of one forward pass. A layer's steps repeat, so a buffer read in every layer
+    // lives until the last step of the layer loop.
+    enum { EMBED, QKV, ROPE, ATTN, O_PROJ, ATTN_NORM, GATE_UP, SWIGLU, DOWN, MLP_NORM, HEAD };
+    size_t T = ntoken;
+    size_t head_dim = _meta.di / _meta.nh;
+    size_t dsize = utils::dsize(_meta.dtype);
+    size_t rsize = utils::dsize(_residual_dtype);
+
+    _workspace.clear();
+    _ws.ids = _workspace.add(T * sizeof(int64_t), EMBED, EMBED);
+    _ws.pos = _workspace.add(T * sizeof(int64_t), EMBED, MLP_NORM);
+    _ws.hidden = _workspace.add(T * _meta.di * rsize, EMBED, MLP_NORM);
+    _ws.norm = _workspace.add(T * _meta.di * rsize, EMBED, HEAD);
+    _ws.q = _workspace.add(T * _meta.nh * head_dim * dsize, QKV, ATTN);
+    // K/V staging is only used by the head-major cache layout
+    _ws.k = _workspace.add(T * _meta.nkvh * head_dim * dsize, QKV, ROPE);
+    _ws.v = _workspace.add(T * _meta.nkvh * head_dim * dsize, QKV, ROPE);
+    _ws.attn = _workspace.add(T * _meta.nh * head_dim * dsize, ATTN, O_PROJ);
+    _ws.attn_proj = _workspace.add(T * _meta.di * rsize, O_PROJ, ATTN_NORM);
+    _ws.gate = _workspace.add(T * _meta.hs * dsize, GATE_UP, DOWN);
+    _ws.up = _workspace.add(T * _meta.hs * dsize, GATE_UP, SWIGLU);
+    _ws.down = _workspace.add(T * _meta.di * rsize, DOWN, MLP_NORM);
+    _ws.logits = _workspace.add(_meta.voc * sizeof(float), HEAD, HEAD);
+    _ws.max_idx = _workspace.add(sizeof(int64_t), HEAD, HEAD);
+    _ws.max_val = _workspace.add(sizeof(float), HEAD, HEAD);
+    _workspace.plan(_device_type, _device_id);
+    _ws_tokens = ntoken;
+    _decode_graph.clear();
+}
+
+LlaisysWorkspaceStats Qwen2Session::workspaceStats() const {
+    return {_ws_tokens, _workspace.bytes(), _workspace.unplannedBytes()};
+}
+
+void Qwen2Session::setSamplingSeed(uint64_t seed) {
+    _sampler.seed(seed);
+}
+
+void Qwen2Session::setDecodeGraph(bool enable) {
+    _graph_enabled = enable;
+    _decode_graph.clear();
+}
+
+int64_t Qwen2Session::infer(int64_t *token_ids, size_t ntoken, size_t pos, const LlaisysSamplingParams *sampling) {
+    core::context().setDevice(_device_type, _device_id);
+    wait_kv_cache();
+    // Re-tied embeddings free the buffer the recording reads
+    if (_graph_weights_version != _model.weightsVersion()) {
+        _decode_graph.clear();
+        _graph_weights_version = _model.weightsVersion();
+    }
+
+    size_t seq_len = ntoken;
+    CHECK_ARGUMENT(seq_len > 0 && pos + seq_len <= _meta.maxseq, "Qwen2: tokens exceed the KV cache capacity.");
+
+    // Positions from `pos` on are overwritten; earlier ones not fed through this model
+    // (e.g. restored from a session) are simply absent from the penalty history.
+    _tokens.resize(std::min(_tokens.size(), pos));
+    _tokens.insert(_tokens.end(), token_ids, token_ids + ntoken);
+    
+    // Activations come from the preplanned workspace: a steady decode allocates nothing
+    reserveWorkspace(seq_len);
+
+    // Inputs
+    auto input_ids_t = _workspace.get(_ws.ids, {seq_len}, LLAISYS_DTYPE_I64);
+    auto pos_ids_t = _workspace.get(_ws.pos, {seq_len}, LLAISYS_DTYPE_I64);
+    
+    input_ids_t->load(token_ids);
+    _pos_host.resize(seq_len);
+    for(size_t i=0; i<seq_len; ++i) _pos_host[i] = pos + i;
+    pos_ids_t->load(_pos_host.data());
+    ensure_rope_table(pos + seq_len);
+
+    bool full_logits = sampling && !Sampler::isArgmax(*sampling);
+    if (seq_len == 1 && _graph_enabled && _device_type == LLAISYS_DEVICE_CPU) {
+        // Decode: replay the captured step, shifted to this position, or capture it now
+        if (!_decode_graph.empty() && _graph_full_logits == full_logits) {
+            _decode_graph.replay(static_cast<ptrdiff_t>(pos) - static_cast<ptrdiff_t>(_graph_pos));
+            _graph_stats.replays++;
+        } else {
+            _decode_graph.beginCapture();
+            try {
+                forward(seq_len, pos, full_logits);
+            } catch (...) {
+                _decode_graph.endCapture();
+                _decode_graph.clear();
+                throw;
+            }
+            _decode_graph.endCapture();
+            _graph_pos = pos;
+            _graph_full_logits = full_logits;
+            _graph_stats.captures++;
+            _graph_stats.nodes = _decode_graph.size();
+            _graph_stats.depth = _decode_graph.depth();
+        }
+    } else {
+        forward(seq_len, pos, full_logits);
+    }
+
+    if (full_logits) {
+        // Sampling needs the whole distribution
+        auto logits = _workspace.get(_ws.logits, {1, _meta.voc}, LLAISYS_DTYPE_F32);
+        _logits_host.resize(_meta.voc);
+        core::context().runtime().api()->memcpy_sync(
+            _logits_host.data(), logits->data(), _meta.voc * sizeof(float), LLAISYS_MEMCPY_D2H);
+        return _sampler.sample(_logits_host.data(), _meta.voc, *sampling, _tokens);
+    }
+
+    auto max_idx = _workspace.get(_ws.max_idx, {1, 1}, LLAISYS_DTYPE_I64);
+    int64_t result_token;
+    core::context().runtime().api()->memcpy_sync(
+        &result_token, max_idx->data(), sizeof(int64_t), LLAISYS_MEMCPY_D2H);
+
+    return result_token;
+}
+
+void Qwen2Session::forward(size_t seq_len, size_t pos, bool full_logits) {
+    size_t head_dim = _meta.di / _meta.nh;
+    auto input_ids_t = _workspace.get(_ws.ids, {seq_len}, LLAISYS_DTYPE_I64);
+    auto pos_ids_t = _workspace.get(_ws.pos, {seq_len}, LLAISYS_DTYPE_I64);
+    // While capturing, the KV slot written this step and the prefix attention reads move
+    // with the position; everything else stays put between steps.
+    auto *graph = ops::Graph::capturing();
+
+    // 1. Embedding
+    auto hidden_states = _workspace.get(_ws.hidden, {seq_len, _meta.di}, _residual_dtype);
+    embedding(hidden_states, input_ids_t, _weights.in_embed->tensor);
+
+    // 2. Layers
+    // Each residual add is fused with the norm that follows it (the next block's
+    // input norm, or the final norm after the last layer), so only the first
+    // attention norm runs on its own.
+    // With an F32 residual the norm outputs stay F32 too and feed the BF16/F16
+    // projections directly, so nothing is rounded between the residual and a matmul.
+    auto norm_out = _workspace.get(_ws.norm, {seq_len, _meta.di}, _residual_dtype);
+    rms_norm(norm_out, hidden_states, _weights.attn_norm_w[0]->tensor, _meta.epsilon);
+
+    for (size_t i = 0; i < _meta.nlayer; ++i) {
+        // Attention Block
+        
+        // K/V are projected straight into this step's cache slots when those are
+        // contiguous (token-major layout), so no staging tensors or copies are needed.
+        // For the head-major layout the slot is strided: RoPE writes K into it and V
+        // is scattered with one rearrange.
+        auto& k_cache = _kv_cache[i].first;
+        auto& v_cache = _kv_cache[i].second;
+        auto k_slot = k_cache->slice(0, pos, pos + seq_len);
+        auto v_slot = v_cache->slice(0, pos, pos + seq_len);
+        bool direct = k_slot->isContiguous();
+        if (graph) {
+            graph->slidesWithPosition(k_slot);
+            graph->slidesWithPosition(v_slot);
+        }
+
+        auto q = _workspace.get(_ws.q, {seq_len, _meta.nh * head_dim}, _meta.dtype);
+        auto k = direct ? k_slot : _workspace.get(_ws.k, {seq_len, _meta.nkvh, head_dim}, _meta.dtype);
+        auto v = direct ? v_slot : _workspace.get(_ws.v, {seq_len, _meta.nkvh, head_dim}, _meta.dtype);
+
+        linear(q, norm_out, _weights.attn_q_w[i]->tensor, _weights.attn_q_b[i]->tensor);
+        auto k_rows = k->view({seq_len, _meta.nkvh * head_dim});
+        auto v_rows = v->view({seq_len, _meta.nkvh * head_dim});
+        if (graph && direct) {
+            graph->slidesWithPosition(k_rows);
+            graph->slidesWithPosition(v_rows);
+        }
+        linear(k_rows, norm_out, _weights.attn_k_w[i]->tensor, _weights.attn_k_b[i]->tensor);
+        linear(v_rows, norm_out, _weights.attn_v_w[i]->tensor, _weights.attn_v_b[i]->tensor);
+
+        q = q->view({seq_len, _meta.nh, head_dim});
+
+        rope(q, q, pos_ids_t, _rope_cos, _rope_sin);
+        rope(k_slot, k, pos_ids_t, _rope_cos, _rope_sin);
+        if (!direct) {
+            rearrange(v_slot, v);
+        }
+
+        // Full KV for attention
+        auto k_full = k_cache->slice(0, 0, pos + seq_len);
+        auto v_full = v_cache->slice(0, 0, pos + seq_len);
+        if (graph) {
+            graph->growsWithPosition(k_full);
+            graph->growsWithPosition(v_full);
+        }
+
+        // Attention
+        auto attn_out = _workspace.get(_ws.attn, {seq_len, _meta.nh, head_dim}, _meta.dtype);
+        float scale = 1.0f / sqrtf((float)head_dim);
+        self_attention(attn_out, q, k_full, v_full, scale);
+
+        attn_out = attn_out->view({seq_len, _meta.di});
+        auto linear_out = _workspace.get(_ws.attn_proj, {seq_len, _meta.di}, _residual_dtype);
+        linear(linear_out, attn_out, _weights.attn_o_w[i]->tensor, nullptr);
+
+        add_rms_norm(norm_out, hidden_states, hidden_states, linear_out, _weights.mlp_norm_w[i]->tensor, _meta.epsilon);
+
+        // MLP Block
+        
+        auto gate = _workspace.get(_ws.gate, {seq_len, _meta.hs}, _meta.dtype);
+        auto up = _workspace.get(_ws.up, {seq_len, _meta.hs}, _meta.dtype);
+        linear(gate, norm_out, _weights.mlp_gate_w[i]->tensor, nullptr);
+        linear(up, norm_out, _weights.mlp_up_w[i]->tensor, nullptr);
+        
+        swiglu(gate, gate, up);
+        
+        auto down_out = _workspace.get(_ws.down, {seq_len, _meta.di}, _residual_dtype);
+        linear(down_out, gate, _weights.mlp_down_w[i]->tensor, nullptr);
+
+        bool last = i + 1 == _meta.nlayer;
+        // 3. Final Norm (fused into the last layer's residual add)
+        auto next_norm_w = last ? _weights.out_norm_w : _weights.attn_norm_w[i + 1];
+        add_rms_norm(norm_out, hidden_states, hidden_states, down_out, next_norm_w->tensor, _meta.epsilon);
+    }
+
+    // 4. Head
+    auto last_hidden = norm_out->slice(0, seq_len - 1, seq_len);
+    if (full_logits) {
+        auto logits = _workspace.get(_ws.logits, {1, _meta.voc}, LLAISYS_DTYPE_F32);
+        linear(logits, last_hidden, _weights.out_embed->tensor, nullptr);
+        return;
+    }
+
+    // 5. Argmax
+    // The fused head keeps only the running best token per vocab shard, so the
+    // [1, voc] logits row is never materialized.
+    auto max_idx = _workspace.get(_ws.max_idx, {1, 1}, LLAISYS_DTYPE_I64);
+    auto max_val = _workspace.get(_ws.max_val, {1, 1}, LLAISYS_DTYPE_F32);
+    lm_head_topk(max_idx, max_val, nullptr, last_hidden, _weights.out_embed->tensor);
+}
+
+} // namespace llaisys::models
@@ -0,0 +1,122 @@
+#pragma once
+#include "llaisys/models/qwen2.h"
+#include "../../ops/graph/graph.hpp"
+#include "../../tensor/tensor.hpp"
+#include "../../utils/mapped_file.hpp"
+#include "../sampler/sampler.hpp"
+#include "../workspace/workspace.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llaisys::models {
+
+class Qwen2;
+
+// One conversation over a Qwen2's weights: KV cache, token history and sampler, activation
+// workspace and captured decode step. The weights are only read, so sessions of the same
+// model may run infer concurrently on different threads; one session is not to be used by
+// two threads at once, and the model must outlive its sessions.
+class Qwen2Session {
+public:
+    // Starts from `settings`' KV layout, residual dtype and decode-graph switch when given.
+    Qwen2Session(const Qwen2 &model, const Qwen2Session *settings = nullptr);
+    ~Qwen2Session();
+
+    Qwen2Session(const Qwen2Session &) = delete;
+    Qwen2Session &operator=(const Qwen2Session &) = delete;
+
+    void setKVCacheLayout(llaisysKVCacheLayout_t layout);
+
+    // Dtype of the residual stream and norm outputs: meta.dtype (default) or F32.
+    void setResidualDtype(llaisysDataType_t dtype);
+
+    // KV swap tier: spill the cache to an mmap-backed file and restore it asynchronously.
+    void swapOutKVCache(const std::string &path, size_t npos);
+    void swapInKVCache();
+    const LlaisysKVSwapStats &kvSwapStats() const { return _kv_swap_stats; }
+
+    // Session snapshots: the first `pos` KV positions plus metadata, in a layout-independent file.
+    void saveSession(const std::string &path, size_t pos);
+    int64_t loadSession(const std::string &path);
+
+    void setSamplingSeed(uint64_t seed);
+
+    // Plans the activation workspace for calls of up to `ntoken` tokens. infer grows it on
+    // demand; reserving the prefill length up front keeps later calls allocation-free.
+    void reserveWorkspace(size_t ntoken);
+    LlaisysWorkspaceStats workspaceStats() const;
+
+    // Single-token steps record their op sequence once and replay it afterwards (default on).
+    // Anything that moves a captured buffer drops the graph; the next step recaptures it.
+    void setDecodeGraph(bool enable);
+    const LlaisysDecodeGraphStats &decodeGraphStats() const { return _graph_stats; }
+
+    // 更新：增加 pos 参数；sampling 为空时取 argmax
+    int64_t infer(int64_t *token_ids, size_t ntoken, size_t pos, const LlaisysSamplingParams *sampling = nullptr);
+
+private:
+    const Qwen2 &_model;
+    const LlaisysQwen2Meta _meta;
+    const llaisysDeviceType_t _device_type;
+    const int _device_id;
+    const LlaisysQwen2Weights &_weights;
+
+    // KV Cache: [layer][k/v], always viewed as [maxseq, nkvh, dh] whatever the layout
+    std::vector<std::pair<tensor_t, tensor_t>> _kv_cache;
+    llaisysKVCacheLayout_t _kv_layout;
+
+    // Residual stream, norm outputs and the projections feeding the residual use this
+    // dtype; attention and MLP intermediates stay in meta.dtype.
+    llaisysDataType_t _residual_dtype;
+
+    // Swapped-out KV cache and the pending restore, if any. The restore is a series of async
+    // copies on _copy_stream; _kv_swap_event marks their end.
+    std::unique_ptr<utils::MappedFile> _kv_swap_file;
+    size_t _kv_swap_npos;
+    bool _kv_swap_pending;
+    std::chrono::steady_clock::time_point _kv_swap_start;
+    std::chrono::steady_clock::time_point _kv_swap_done;
+    LlaisysKVSwapStats _kv_swap_stats;
+    llaisysStream_t _copy_stream;
+    llaisysEvent_t _kv_swap_event;
+
+    // Tokens fed at each position, for the sampling penalties
+    std::vector<int64_t> _tokens;
+    Sampler _sampler;
+
+    // Per-step activations carved from one arena, planned for up to _ws_tokens tokens
+    Workspace _workspace;
+    size_t _ws_tokens;
+    struct {
+        size_t ids, pos, hidden, norm, q, k, v, attn, attn_proj, gate, up, down, logits, max_idx, max_val;
+    } _ws;
+    std::vector<int64_t> _pos_host;
+    std::vector<float> _logits_host;
+
+    // Captured decode step: valid for seq_len 1 and the head mode it was recorded with,
+    // replayed relative to the position it was captured at.
+    bool _graph_enabled;
+    ops::Graph _decode_graph;
+    size_t _graph_pos;
+    bool _graph_full_logits;
+    LlaisysDecodeGraphStats _graph_stats;
+    // Qwen2::weightsVersion() the graph was captured against
+    uint64_t _graph_weights_version;
+
+    // The model's RoPE tables this session runs with; held so that a regrowth by another
+    // session cannot free them under this one's decode graph.
+    tensor_t _rope_cos;
+    tensor_t _rope_sin;
+
+    tensor_t new_kv_cache_tensor();
+    void init_kv_cache();
+    void wait_kv_cache();
+    void ensure_rope_table(size_t npos);
+    // Runs the ops of one step (embedding through the head) on the workspace inputs
+    void forward(size_t seq_len, size_t pos, bool full_logits);
+};
+
+} // namespace llaisys::models
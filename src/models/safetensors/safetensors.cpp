@@ -0,0 +1,247 @@
+#include "safetensors.hpp"
+
+#include "../../core/storage/storage.hpp"
+#include "../../utils.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace llaisys::models {
+
+static llaisysDataType_t parse_dtype(const std::string &s) {
+    static const std::map<std::string, llaisysDataType_t> dtypes = {
+        {"BOOL", LLAISYS_DTYPE_BOOL}, {"U8", LLAISYS_DTYPE_U8},     {"I8", LLAISYS_DTYPE_I8},
+        {"I16", LLAISYS_DTYPE_I16},   {"U16", LLAISYS_DTYPE_U16},   {"I32", LLAISYS_DTYPE_I32},
+        {"U32", LLAISYS_DTYPE_U32},   {"I64", LLAISYS_DTYPE_I64},   {"U64", LLAISYS_DTYPE_U64},
+        {"F16", LLAISYS_DTYPE_F16},   {"BF16", LLAISYS_DTYPE_BF16}, {"F32", LLAISYS_DTYPE_F32},
+        {"F64", LLAISYS_DTYPE_F64},
+    };
+    auto it = dtypes.find(s);
+    return it == dtypes.end() ? LLAISYS_DTYPE_INVALID : it->second;
+}
+
+// Just enough JSON for a safetensors header: objects, arrays, strings, unsigned integers,
+// and anything else skipped over (e.g. inside __metadata__).
+class HeaderParser {
+public:
+    HeaderParser(const std::string &path, const char *begin, const char *end) : _path(path), _p(begin), _end(end) {}
+
+    void ws() {
+        while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r')) {
+            ++_p;
+        }
+    }
+
+    bool peek(char c) {
+        ws();
+        return _p < _end && *_p == c;
+    }
+
+    void expect(char c) {
+        if (!peek(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++_p;
+    }
+
+    // Consumes `c` if it is next
+    bool accept(char c) {
+        if (peek(c)) {
+            ++_p;
+            return true;
+        }
+        return false;
+    }
+
+    std::string string() {
+        expect('"');
+        std::string out;
+        while (_p < _end && *_p != '"') {
+            if (*_p == '\\') {
+                if (++_p == _end) {
+                    break;
+                }
+                switch (*_p) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    // Tensor names are ASCII; keep other code points escaped as-is
+                    out += "\\u";
+                    break;
+                default: out += *_p; break;
+                }
+                ++_p;
+            } else {
+                out += *_p++;
+            }
+        }
+        expect('"');
+        return out;
+    }
+
+    size_t integer() {
+        ws();
+        if (_p == _end || *_p < '0' || *_p > '9') {
+            fail("expected an unsigned integer");
+        }
+        size_t v = 0;
+        while (_p < _end && *_p >= '0' && *_p <= '9') {
+            size_t next = v * 10 + static_cast<size_t>(*_p++ - '0');
+            if (next / 10 != v) {
+                fail("integer overflow");
+            }
+            v = next;
+        }
+        return v;
+    }
+
+    void skip() {
+        ws();
+        if (_p == _end) {
+            fail("unexpected end");
+        }
+        if (*_p == '"') {
+            string();
+        } else if (accept('{')) {
+            if (!accept('}')) {
+                do {
+                    string();
+                    expect(':');
+                    skip();
+                } while (accept(','));
+                expect('}');
+            }
+        } else if (accept('[')) {
+            if (!accept(']')) {
+                do {
+                    skip();
+                } while (accept(','));
+                expect(']');
+            }
+        } else {
+            // number, true, false, null
+            while (_p < _end && std::strchr(",}] \t\n\r", *_p) == nullptr) {
+                ++_p;
+            }
+        }
+    }
+
+    bool atEnd() {
+        ws();
+        return _p == _end;
+    }
+
+    [[noreturn]] void fail(const std::string &what) const {
+        throw std::runtime_error(_path + ": safetensors header: " + what);
+    }
+
+private:
+    const std::string &_path;
+    const char *_p;
+    const char *_end;
+};
+
+SafetensorsFile::SafetensorsFile(std::shared_ptr<utils::MappedFile> file) : _file(std::move(file)) {
+    _storage = core::Storage::wrap(_file->data(), _file->size(), _file);
+}
+
+std::unique_ptr<SafetensorsFile> SafetensorsFile::open(const std::string &path) {
+    std::unique_ptr<SafetensorsFile> st(new SafetensorsFile(utils::MappedFile::open(path)));
+    const std::byte *base = st->_file->data();
+    size_t size = st->_file->size();
+
+    uint64_t header_len = 0;
+    if (size < sizeof(header_len)) {
+        throw std::runtime_error(path + ": too small for a safetensors file");
+    }
+    for (size_t i = 0; i < sizeof(header_len); ++i) {
+        header_len |= static_cast<uint64_t>(base[i]) << (8 * i);
+    }
+    if (header_len > size - sizeof(header_len)) {
+        throw std::runtime_error(path + ": header runs past the end of the file");
+    }
+    size_t data_start = sizeof(header_len) + header_len;
+    size_t data_size = size - data_start;
+
+    const char *text = reinterpret_cast<const char *>(base + sizeof(header_len));
+    HeaderParser parser(path, text, text + header_len);
+    parser.expect('{');
+    if (!parser.accept('}')) {
+        do {
+            std::string name = parser.string();
+            parser.expect(':');
+            if (name == "__metadata__") {
+                parser.skip();
+                continue;
+            }
+            Entry e{LLAISYS_DTYPE_INVALID, {}, 0, 0};
+            size_t begin = 0, end = 0;
+            bool has_dtype = false, has_shape = false, has_offsets = false;
+            parser.expect('{');
+            do {
+                std::string key = parser.string();
+                parser.expect(':');
+                if (key == "dtype") {
+                    e.dtype = parse_dtype(parser.string());
+                    has_dtype = true;
+                } else if (key == "shape") {
+                    parser.expect('[');
+                    if (!parser.accept(']')) {
+                        do {
+                            if (e.shape.size() == TENSOR_MAX_NDIM) {
+                                parser.fail(name + " has too many dimensions");
+                            }
+                            e.shape.push_back(parser.integer());
+                        } while (parser.accept(','));
+                        parser.expect(']');
+                    }
+                    has_shape = true;
+                } else if (key == "data_offsets") {
+                    parser.expect('[');
+                    begin = parser.integer();
+                    parser.expect(',');
+                    end = parser.integer();
+                    parser.expect(']');
+                    has_offsets = true;
+                } else {
+                    parser.skip();
+                }
+            } while (parser.accept(','));
+            parser.expect('}');
+
+            if (!has_dtype || !has_shape || !has_offsets) {
+                parser.fail(name + " lacks dtype, shape or data_offsets");
+            }
+            if (begin > end || end > data_size) {
+                parser.fail(name + " lies outside the data section");
+            }
+            e.offset = data_start + begin;
+            e.bytes = end - begin;
+            if (e.dtype != LLAISYS_DTYPE_INVALID) {
+                size_t numel = 1;
+                for (size_t d : e.shape) {
+                    numel *= d;
+                }
+                if (numel * utils::dsize(e.dtype) != e.bytes) {
+                    parser.fail(name + " has a byte size that does not match its shape");
+                }
+            }
+            st->_entries.emplace(std::move(name), std::move(e));
+        } while (parser.accept(','));
+        parser.expect('}');
+    }
+    if (!parser.atEnd()) {
+        parser.fail("trailing characters");
+    }
+    return st;
+}
+
+tensor_t SafetensorsFile::view(const Entry &e) const {
+    CHECK_ARGUMENT(e.dtype != LLAISYS_DTYPE_INVALID, "Safetensors: tensor dtype has no llaisys counterpart.");
+    return Tensor::fromStorage(_storage, e.offset, e.shape, e.dtype);
+}
+
+} // namespace llaisys::models
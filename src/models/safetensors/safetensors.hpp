@@ -0,0 +1,48 @@
+#pragma once
+#include "../../tensor/tensor.hpp"
+#include "../../utils/mapped_file.hpp"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace llaisys::models {
+
+// A .safetensors file mapped read-only into memory. The format is an 8-byte
+// little-endian header length, a JSON header
+//   {"<name>": {"dtype": "BF16", "shape": [..], "data_offsets": [begin, end]}, "__metadata__": {..}}
+// and then the raw little-endian tensor bytes, offsets being relative to the end of the header.
+class SafetensorsFile {
+public:
+    struct Entry {
+        llaisysDataType_t dtype; // LLAISYS_DTYPE_INVALID for types llaisys has no counterpart of
+        tensor_shape_t shape;
+        size_t offset; // from the start of the file
+        size_t bytes;
+    };
+
+    // Maps and parses `path`. Throws std::runtime_error if the file cannot be mapped or is not
+    // valid safetensors.
+    static std::unique_ptr<SafetensorsFile> open(const std::string &path);
+
+    // Starts reading the whole file in the background
+    void prefetchAsync() { _file->prefetchAsync(); }
+    // Reads the whole file in before returning
+    void populate() { _file->populate(); }
+
+    const std::string &path() const { return _file->path(); }
+    const std::map<std::string, Entry> &entries() const { return _entries; }
+    const std::byte *data(const Entry &e) const { return _file->data() + e.offset; }
+
+    // A read-only CPU tensor over the entry's mapped bytes, without copying. It keeps the
+    // mapping alive, and its pages stay shared with the page cache.
+    tensor_t view(const Entry &e) const;
+
+private:
+    explicit SafetensorsFile(std::shared_ptr<utils::MappedFile> file);
+
+    std::shared_ptr<utils::MappedFile> _file;
+    core::storage_t _storage; // the whole mapping, shared by every view
+    std::map<std::string, Entry> _entries;
+};
+
+} // namespace llaisys::models
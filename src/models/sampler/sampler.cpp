@@ -0,0 +1,175 @@
+// fast_exp.hpp pulls in immintrin.h, which must come before llaisys.h.
+#include "../../utils/fast_exp.hpp"
+
+#include "sampler.hpp"
+
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+#ifdef LLAISYS_X86_SIMD
+// The 8-wide part of exp_shift_: adds its sum to `sum` and returns how many elements it did
+LLAISYS_AVX2_FMA static size_t exp_shift_avx2_(float *out, const float *x, size_t n, float max, float scale,
+                                               float &sum) {
+    size_t i = 0;
+    const __m256 vmax = _mm256_set1_ps(max);
+    const __m256 vscale = _mm256_set1_ps(scale);
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m256 e = llaisys::utils::fast_exp(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), vmax), vscale));
+        _mm256_storeu_ps(out + i, e);
+        acc = _mm256_add_ps(acc, e);
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, acc);
+    for (float v : lanes) {
+        sum += v;
+    }
+    return i;
+}
+#endif
+
+// out[i] = exp((x[i] - max) * scale), returns the sum
+static float exp_shift_(float *out, const float *x, size_t n, float max, float scale) {
+    size_t i = 0;
+    float sum = 0.0f;
+#ifdef LLAISYS_X86_SIMD
+    if (llaisys::utils::has_avx2_fma()) {
+        i = exp_shift_avx2_(out, x, n, max, scale, sum);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = llaisys::utils::fast_exp((x[i] - max) * scale);
+        sum += out[i];
+    }
+    return sum;
+}
+
+static bool penalized_(const LlaisysSamplingParams &params) {
+    return params.repetition_penalty != 1.0f || params.frequency_penalty != 0.0f || params.presence_penalty != 0.0f;
+}
+
+namespace llaisys::models {
+
+Sampler::Sampler(uint64_t seed) {
+    this->seed(seed);
+}
+
+void Sampler::seed(uint64_t seed) {
+    // splitmix64 expands the seed into the four state words
+    for (auto &s : _rng) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        s = z ^ (z >> 31);
+    }
+}
+
+uint64_t Sampler::next_() {
+    auto rotl = [](uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+    uint64_t result = rotl(_rng[1] * 5, 7) * 9;
+    uint64_t t = _rng[1] << 17;
+    _rng[2] ^= _rng[0];
+    _rng[3] ^= _rng[1];
+    _rng[1] ^= _rng[2];
+    _rng[0] ^= _rng[3];
+    _rng[2] ^= t;
+    _rng[3] = rotl(_rng[3], 45);
+    return result;
+}
+
+bool Sampler::isArgmax(const LlaisysSamplingParams &params) {
+    return (params.temperature <= 0.0f || params.top_k == 1) && !penalized_(params);
+}
+
+int64_t Sampler::sample(const float *logits, size_t voc, const LlaisysSamplingParams &params,
+                        const std::vector<int64_t> &history) {
+    CHECK_ARGUMENT(voc > 0, "Sampler: empty logits.");
+    CHECK_ARGUMENT(params.repetition_penalty > 0.0f, "Sampler: repetition_penalty must be positive.");
+    CHECK_ARGUMENT(params.top_p > 0.0f, "Sampler: top_p must be positive.");
+
+    // 1. Penalties over the history (HF repetition penalty, OpenAI frequency/presence)
+    _logits.assign(logits, logits + voc);
+    if (penalized_(params)) {
+        std::unordered_map<int64_t, uint32_t> counts;
+        for (int64_t t : history) {
+            if (t >= 0 && static_cast<size_t>(t) < voc) {
+                ++counts[t];
+            }
+        }
+        for (const auto &[t, n] : counts) {
+            float &l = _logits[t];
+            l = l < 0.0f ? l * params.repetition_penalty : l / params.repetition_penalty;
+            l -= params.frequency_penalty * n + params.presence_penalty;
+        }
+    }
+
+    // 高分在前，同分取较小的 id，与 argmax 一致
+    auto better = [this](int64_t a, int64_t b) {
+        return _logits[a] > _logits[b] || (_logits[a] == _logits[b] && a < b);
+    };
+
+    // 2. Greedy
+    if (params.temperature <= 0.0f || params.top_k == 1) {
+        int64_t best = 0;
+        for (size_t i = 1; i < voc; ++i) {
+            if (better(static_cast<int64_t>(i), best)) {
+                best = static_cast<int64_t>(i);
+            }
+        }
+        return best;
+    }
+
+    // 3. Top-k by partial selection; top-p then needs the survivors in order
+    size_t k = params.top_k > 0 ? std::min(static_cast<size_t>(params.top_k), voc) : voc;
+    _cand.resize(voc);
+    std::iota(_cand.begin(), _cand.end(), int64_t(0));
+    if (k < voc) {
+        std::nth_element(_cand.begin(), _cand.begin() + (k - 1), _cand.end(), better);
+        _cand.resize(k);
+    }
+    bool nucleus = params.top_p < 1.0f;
+    if (nucleus) {
+        std::sort(_cand.begin(), _cand.end(), better);
+    }
+
+    // 4. Softmax with temperature over the survivors
+    _prob.resize(_cand.size());
+    float max = -std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < _cand.size(); ++i) {
+        _prob[i] = _logits[_cand[i]];
+        max = std::max(max, _prob[i]);
+    }
+    float mass = exp_shift_(_prob.data(), _prob.data(), _prob.size(), max, 1.0f / params.temperature);
+
+    // 5. Top-p: the shortest prefix whose probability reaches top_p
+    size_t n = _cand.size();
+    if (nucleus) {
+        float target = params.top_p * mass;
+        float cum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            cum += _prob[i];
+            if (cum >= target) {
+                n = i + 1;
+                mass = cum;
+                break;
+            }
+        }
+    }
+
+    // 6. Draw
+    double u = static_cast<double>(next_() >> 11) * 0x1.0p-53 * mass;
+    double cum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        cum += _prob[i];
+        if (u < cum) {
+            return _cand[i];
+        }
+    }
+    return _cand[n - 1];
+}
+
+} // namespace llaisys::models
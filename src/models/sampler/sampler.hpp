@@ -0,0 +1,37 @@
+#pragma once
+#include "llaisys/models/qwen2.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace llaisys::models {
+
+// Draws the next token from one F32 logits row. Holds its own RNG, so every model
+// (session) has an independently seedable stream.
+class Sampler {
+public:
+    explicit Sampler(uint64_t seed);
+
+    void seed(uint64_t seed);
+
+    // True when `params` reduce to a plain argmax of the raw logits, so the caller can
+    // skip materializing them.
+    static bool isArgmax(const LlaisysSamplingParams &params);
+
+    int64_t sample(const float *logits, size_t voc, const LlaisysSamplingParams &params,
+                   const std::vector<int64_t> &history);
+
+private:
+    // xoshiro256** state; <random> is avoided because it pulls in x86 intrinsics
+    // headers, which must not follow llaisys.h
+    uint64_t _rng[4];
+
+    uint64_t next_();
+
+    // Scratch reused across calls: penalized logits, candidate ids and their weights
+    std::vector<float> _logits;
+    std::vector<int64_t> _cand;
+    std::vector<float> _prob;
+};
+
+} // namespace llaisys::models
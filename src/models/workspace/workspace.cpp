@@ -0,0 +1,82 @@
+#include "workspace.hpp"
+
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace llaisys::models {
+
+// 每个 buffer 按 64 字节对齐，便于向量化访问
+static constexpr size_t WORKSPACE_ALIGN = 64;
+
+size_t Workspace::add(size_t bytes, int first, int last) {
+    CHECK_ARGUMENT(first <= last, "Workspace: a buffer must end after it starts.");
+    _buffers.push_back({(bytes + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN * WORKSPACE_ALIGN, first, last, 0});
+    return _buffers.size() - 1;
+}
+
+void Workspace::plan(llaisysDeviceType_t device_type, int device_id) {
+    // Greedy by size: place the largest buffers first, each at the lowest offset that does
+    // not collide with an already placed buffer whose lifetime overlaps.
+    std::vector<size_t> order(_buffers.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(),
+                     [this](size_t a, size_t b) { return _buffers[a].bytes > _buffers[b].bytes; });
+
+    size_t total = 0;
+    std::vector<const Buffer *> placed;
+    for (size_t id : order) {
+        Buffer &buf = _buffers[id];
+        std::vector<const Buffer *> live;
+        for (const Buffer *other : placed) {
+            if (other->first <= buf.last && buf.first <= other->last) {
+                live.push_back(other);
+            }
+        }
+        std::sort(live.begin(), live.end(), [](const Buffer *a, const Buffer *b) { return a->offset < b->offset; });
+        size_t offset = 0;
+        for (const Buffer *other : live) {
+            if (offset + buf.bytes <= other->offset) {
+                break;
+            }
+            offset = std::max(offset, other->offset + other->bytes);
+        }
+        buf.offset = offset;
+        total = std::max(total, offset + buf.bytes);
+        placed.push_back(&buf);
+    }
+
+    if (!_arena || _arena->numel() < total) {
+        _arena.reset(); // release the old arena before allocating a larger one
+        _arena = Tensor::create({std::max(total, WORKSPACE_ALIGN)}, LLAISYS_DTYPE_BYTE, device_type, device_id);
+    }
+}
+
+tensor_t Workspace::get(size_t id, const tensor_shape_t &shape, llaisysDataType_t dtype) const {
+    const Buffer &buf = _buffers[id];
+    size_t bytes = utils::dsize(dtype);
+    for (size_t s : shape) {
+        bytes *= s;
+    }
+    ASSERT(bytes <= buf.bytes, "Workspace: tensor exceeds its planned buffer.");
+    return _arena->carve(buf.offset, shape, dtype);
+}
+
+void Workspace::clear() {
+    _buffers.clear();
+}
+
+size_t Workspace::bytes() const {
+    return _arena ? _arena->numel() : 0;
+}
+
+size_t Workspace::unplannedBytes() const {
+    size_t total = 0;
+    for (const Buffer &buf : _buffers) {
+        total += buf.bytes;
+    }
+    return total;
+}
+
+} // namespace llaisys::models
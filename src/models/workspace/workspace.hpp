@@ -0,0 +1,37 @@
+#pragma once
+#include "../../tensor/tensor.hpp"
+
+#include <vector>
+
+namespace llaisys::models {
+
+// Activation buffers with planned lifetimes, carved from one arena. Buffers whose
+// lifetimes (inclusive step ranges) do not overlap may share memory.
+class Workspace {
+public:
+    // Registers a buffer of `bytes` live over steps [first, last]; returns its id.
+    size_t add(size_t bytes, int first, int last);
+
+    // Assigns every buffer an offset and allocates the arena. Registered buffers are kept,
+    // so calling it again after add() replans the whole set.
+    void plan(llaisysDeviceType_t device_type, int device_id);
+
+    // Buffer `id` as a contiguous tensor; it may be smaller than the registered size.
+    tensor_t get(size_t id, const tensor_shape_t &shape, llaisysDataType_t dtype) const;
+
+    void clear();
+
+    size_t bytes() const;          // arena size
+    size_t unplannedBytes() const; // sum of all buffer sizes, i.e. without any sharing
+
+private:
+    struct Buffer {
+        size_t bytes;
+        int first, last;
+        size_t offset;
+    };
+    std::vector<Buffer> _buffers;
+    tensor_t _arena;
+};
+
+} // namespace llaisys::models
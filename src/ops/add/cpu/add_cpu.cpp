@@ -1,20 +1,68 @@
 #include "add_cpu.hpp"
 
+#include "../../../core/thread_pool/thread_pool.hpp"
 #include "../../../utils.hpp"
 
+#include <algorithm>
 #include <cmath>
 
+static constexpr size_t ADD_BLOCK = 1024;
+static constexpr size_t ADD_PARALLEL_MIN = 1 << 15;
+
 template <typename T>
 void add_(T *c, const T *a, const T *b, size_t numel) {
-    for (size_t i = 0; i < numel; i++) {
-        if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-            c[i] = llaisys::utils::cast<T>(llaisys::utils::cast<float>(a[i]) + llaisys::utils::cast<float>(b[i]));
-        } else {
+    if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
+        // 分块整行转换成 float 再相加
+        float fa[ADD_BLOCK], fb[ADD_BLOCK];
+        for (size_t i = 0; i < numel; i += ADD_BLOCK) {
+            size_t n = std::min(ADD_BLOCK, numel - i);
+            llaisys::utils::to_f32(fa, a + i, n);
+            llaisys::utils::to_f32(fb, b + i, n);
+            for (size_t j = 0; j < n; ++j) {
+                fa[j] += fb[j];
+            }
+            llaisys::utils::from_f32(c + i, fa, n);
+        }
+    } else {
+        for (size_t i = 0; i < numel; i++) {
             c[i] = a[i] + b[i];
         }
     }
 }
 
+// 任意 stride：合并维度后按最内层的段处理；段内 stride 为 1 时走连续实现，
+// 否则按块读成 float 计算后写回
+template <typename T>
+void add_strided_(T *c, const T *a, const T *b, const llaisys::utils::StridedRuns<3> &runs) {
+    const ptrdiff_t nrun = static_cast<ptrdiff_t>(runs.count());
+    const bool unit = runs.unit_inner();
+    const auto &s = runs.inner_strides;
+    auto run = [&](ptrdiff_t from, ptrdiff_t to) {
+        for (ptrdiff_t r = from; r < to; ++r) {
+            auto off = runs.offsets(r);
+            if (unit) {
+                add_(c + off[0], a + off[1], b + off[2], runs.inner);
+                continue;
+            }
+            float fa[ADD_BLOCK], fb[ADD_BLOCK];
+            for (size_t i = 0; i < runs.inner; i += ADD_BLOCK) {
+                size_t n = std::min(ADD_BLOCK, runs.inner - i);
+                llaisys::utils::to_f32(fa, a + off[1] + i * s[1], n, s[1]);
+                llaisys::utils::to_f32(fb, b + off[2] + i * s[2], n, s[2]);
+                for (size_t j = 0; j < n; ++j) {
+                    fa[j] += fb[j];
+                }
+                llaisys::utils::from_f32(c + off[0] + i * s[0], fa, n, s[0]);
+            }
+        }
+    };
+    if (nrun > 1 && nrun * runs.inner >= ADD_PARALLEL_MIN) {
+        llaisys::core::parallel_for(nrun, run);
+    } else {
+        run(0, nrun);
+    }
+}
+
 namespace llaisys::ops::cpu {
 void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t type, size_t numel) {
     switch (type) {
@@ -30,4 +78,23 @@ void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
 }
+
+void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t type,
+         const tensor_shape_t &shape, const tensor_strides_t &c_strides,
+         const tensor_strides_t &a_strides, const tensor_strides_t &b_strides) {
+    auto runs = llaisys::utils::strided_runs<3>(shape, {&c_strides, &a_strides, &b_strides});
+    switch (type) {
+    case LLAISYS_DTYPE_F32:
+        return add_strided_(reinterpret_cast<float *>(c), reinterpret_cast<const float *>(a),
+                            reinterpret_cast<const float *>(b), runs);
+    case LLAISYS_DTYPE_BF16:
+        return add_strided_(reinterpret_cast<llaisys::bf16_t *>(c), reinterpret_cast<const llaisys::bf16_t *>(a),
+                            reinterpret_cast<const llaisys::bf16_t *>(b), runs);
+    case LLAISYS_DTYPE_F16:
+        return add_strided_(reinterpret_cast<llaisys::fp16_t *>(c), reinterpret_cast<const llaisys::fp16_t *>(a),
+                            reinterpret_cast<const llaisys::fp16_t *>(b), runs);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+    }
+}
 } // namespace llaisys::ops::cpu
@@ -1,8 +1,15 @@
 #pragma once
 #include "llaisys.h"
 
+#include "../../../tensor/tensor_meta.hpp"
+
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
 void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t type, size_t size);
+
+// Same-shape tensors with arbitrary strides (in elements)
+void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t type,
+         const tensor_shape_t &shape, const tensor_strides_t &c_strides,
+         const tensor_strides_t &a_strides, const tensor_strides_t &b_strides);
 }
\ No newline at end of file
@@ -2,20 +2,26 @@
 
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/add_cpu.hpp"
 
 namespace llaisys::ops {
-void add(tensor_t c, tensor_t a, tensor_t b) {
+void add(const tensor_t &c, const tensor_t &a, const tensor_t &b) {
     CHECK_SAME_DEVICE(c, a, b);
-    // Only support contiguous inputs with same shape for now.
+    // Same shape; any strides (permuted / sliced views are read and written in place).
     CHECK_SAME_SHAPE(c->shape(), a->shape(), b->shape());
     CHECK_SAME_DTYPE(c->dtype(), a->dtype(), b->dtype());
-    ASSERT(c->isContiguous() && a->isContiguous() && b->isContiguous(), "Add: all tensors must be contiguous.");
+    bool contiguous = c->isContiguous() && a->isContiguous() && b->isContiguous();
 
     // always support cpu calculation
     if (c->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->numel());
+        ASSERT(!Graph::capturing(), "Add: has no graph-captured form.");
+        if (contiguous) {
+            return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->numel());
+        }
+        return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->shape(), c->strides(), a->strides(),
+                        b->strides());
     }
 
     llaisys::core::context().setDevice(c->deviceType(), c->deviceId());
@@ -25,6 +31,7 @@ void add(tensor_t c, tensor_t a, tensor_t b) {
         return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->numel());
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
+        ASSERT(contiguous, "Add: non-contiguous tensors are only supported on CPU.");
         TO_BE_IMPLEMENTED();
         return;
 #endif
@@ -3,5 +3,5 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void add(tensor_t c, tensor_t a, tensor_t b);
+void add(const tensor_t &c, const tensor_t &a, const tensor_t &b);
 }
@@ -0,0 +1,184 @@
+// simd.hpp pulls in immintrin.h, which must come before llaisys.h.
+#include "../../../utils/simd.hpp"
+
+#include "add_rms_norm_cpu.hpp"
+
+#include "../../../core/thread_pool/thread_pool.hpp"
+#include "../../../utils.hpp"
+
+#include <cmath>
+#include <vector>
+
+#ifdef LLAISYS_X86_SIMD
+LLAISYS_AVX2_FMA static inline float hsum_(__m256 acc) {
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    lo = _mm_hadd_ps(lo, lo);
+    lo = _mm_hadd_ps(lo, lo);
+    return _mm_cvtss_f32(lo);
+}
+
+// The 8-wide parts of the helpers below; each returns how many elements it did
+LLAISYS_AVX2_FMA static size_t add_sum_sq_avx2_(float *x, const float *a, const float *b, size_t n, float &sum_sq) {
+    size_t j = 0;
+    __m256 acc = _mm256_setzero_ps();
+    for (; j + 8 <= n; j += 8) {
+        __m256 v = _mm256_add_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(b + j));
+        _mm256_storeu_ps(x + j, v);
+        acc = _mm256_fmadd_ps(v, v, acc);
+    }
+    sum_sq = hsum_(acc);
+    return j;
+}
+
+LLAISYS_AVX2_FMA static size_t sum_sq_avx2_(const float *x, size_t n, float &sum_sq) {
+    size_t j = 0;
+    __m256 acc = _mm256_setzero_ps();
+    for (; j + 8 <= n; j += 8) {
+        __m256 v = _mm256_loadu_ps(x + j);
+        acc = _mm256_fmadd_ps(v, v, acc);
+    }
+    sum_sq = hsum_(acc);
+    return j;
+}
+
+LLAISYS_AVX2_FMA static size_t scale_mul_avx2_(float *y, const float *x, const float *w, float scale, size_t n) {
+    size_t j = 0;
+    __m256 vs = _mm256_set1_ps(scale);
+    for (; j + 8 <= n; j += 8) {
+        _mm256_storeu_ps(y + j, _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(x + j), vs), _mm256_loadu_ps(w + j)));
+    }
+    return j;
+}
+#endif
+
+// x[j] = a[j] + b[j], returns sum(x[j]^2). x may alias a or b.
+static inline float add_sum_sq_(float *x, const float *a, const float *b, size_t n) {
+    size_t j = 0;
+    float sum_sq = 0.0f;
+#ifdef LLAISYS_X86_SIMD
+    if (llaisys::utils::has_avx2_fma()) {
+        j = add_sum_sq_avx2_(x, a, b, n, sum_sq);
+    }
+#endif
+    for (; j < n; ++j) {
+        x[j] = a[j] + b[j];
+        sum_sq += x[j] * x[j];
+    }
+    return sum_sq;
+}
+
+// returns sum(x[j]^2)
+static inline float sum_sq_(const float *x, size_t n) {
+    size_t j = 0;
+    float sum_sq = 0.0f;
+#ifdef LLAISYS_X86_SIMD
+    if (llaisys::utils::has_avx2_fma()) {
+        j = sum_sq_avx2_(x, n, sum_sq);
+    }
+#endif
+    for (; j < n; ++j) {
+        sum_sq += x[j] * x[j];
+    }
+    return sum_sq;
+}
+
+// y[j] = x[j] * scale * w[j]
+static inline void scale_mul_(float *y, const float *x, const float *w, float scale, size_t n) {
+    size_t j = 0;
+#ifdef LLAISYS_X86_SIMD
+    if (llaisys::utils::has_avx2_fma()) {
+        j = scale_mul_avx2_(y, x, w, scale, n);
+    }
+#endif
+    for (; j < n; ++j) {
+        y[j] = x[j] * scale * w[j];
+    }
+}
+
+using RowStrides = llaisys::ops::cpu::AddRmsNormStrides;
+
+template <typename T>
+void add_rms_norm_(std::byte *out, llaisysDataType_t out_type, T *res_out, const T *a, const T *b, const float *w,
+                   const RowStrides &ld, size_t rows, size_t cols, float eps) {
+    // 输出可以与残差类型不同（例如 f32 残差流 + bf16 归一化输出），
+    // 非 f32 的输出先写到 float 缓冲区再整行转换。
+    const size_t out_size = llaisys::utils::dsize(out_type);
+    if constexpr (std::is_same_v<T, float>) {
+        llaisys::core::parallel_for(rows, [&](ptrdiff_t from, ptrdiff_t to) {
+            std::vector<float> y_buf(out_type == LLAISYS_DTYPE_F32 ? 0 : cols);
+            for (ptrdiff_t i = from; i < to; ++i) {
+                float *x = res_out + i * ld.res;
+                std::byte *ry = out + i * ld.out * out_size;
+                float *y = out_type == LLAISYS_DTYPE_F32 ? reinterpret_cast<float *>(ry) : y_buf.data();
+                float sum_sq = add_sum_sq_(x, a + i * ld.a, b + i * ld.b, cols);
+                float inv_rms = 1.0f / std::sqrt(sum_sq / static_cast<float>(cols) + eps);
+                scale_mul_(y, x, w, inv_rms, cols);
+                if (out_type != LLAISYS_DTYPE_F32) {
+                    llaisys::utils::convert(ry, out_type, y, LLAISYS_DTYPE_F32, cols);
+                }
+            }
+        });
+    } else {
+        // 半精度：每行在 float 缓冲区中完成加法、平方和与归一化。
+        // 残差先舍入到 T 再参与归一化，与分开调用 add + rms_norm 的结果一致。
+        llaisys::core::parallel_for(rows, [&](ptrdiff_t from, ptrdiff_t to) {
+            std::vector<float> xa(cols), xb(cols);
+            for (ptrdiff_t i = from; i < to; ++i) {
+                const T *ra = a + i * ld.a;
+                const T *rb = b + i * ld.b;
+                T *rx = res_out + i * ld.res;
+                std::byte *ry = out + i * ld.out * out_size;
+                llaisys::utils::to_f32(xa.data(), ra, cols);
+                llaisys::utils::to_f32(xb.data(), rb, cols);
+                for (size_t j = 0; j < cols; ++j) {
+                    xa[j] += xb[j];
+                }
+                llaisys::utils::from_f32(rx, xa.data(), cols);
+                llaisys::utils::to_f32(xa.data(), rx, cols);
+                float sum_sq = sum_sq_(xa.data(), cols);
+                float inv_rms = 1.0f / std::sqrt(sum_sq / static_cast<float>(cols) + eps);
+                float *y = out_type == LLAISYS_DTYPE_F32 ? reinterpret_cast<float *>(ry) : xb.data();
+                scale_mul_(y, xa.data(), w, inv_rms, cols);
+                if (out_type != LLAISYS_DTYPE_F32) {
+                    llaisys::utils::convert(ry, out_type, y, LLAISYS_DTYPE_F32, cols);
+                }
+            }
+        });
+    }
+}
+
+namespace llaisys::ops::cpu {
+void add_rms_norm(std::byte *out, llaisysDataType_t out_type, std::byte *res_out, const std::byte *a,
+                  const std::byte *b, llaisysDataType_t type, const std::byte *w, llaisysDataType_t w_type,
+                  const AddRmsNormStrides &ld, size_t rows, size_t cols, float eps) {
+    // weight 只转换一次
+    std::vector<float> w_buf(w_type == LLAISYS_DTYPE_F32 ? 0 : cols);
+    const float *weight = llaisys::utils::as_f32(w, w_type, w_buf.data(), cols);
+
+    switch (type) {
+    case LLAISYS_DTYPE_F32:
+        return add_rms_norm_(
+            out, out_type,
+            reinterpret_cast<float *>(res_out),
+            reinterpret_cast<const float *>(a),
+            reinterpret_cast<const float *>(b),
+            weight, ld, rows, cols, eps);
+    case LLAISYS_DTYPE_BF16:
+        return add_rms_norm_(
+            out, out_type,
+            reinterpret_cast<llaisys::bf16_t *>(res_out),
+            reinterpret_cast<const llaisys::bf16_t *>(a),
+            reinterpret_cast<const llaisys::bf16_t *>(b),
+            weight, ld, rows, cols, eps);
+    case LLAISYS_DTYPE_F16:
+        return add_rms_norm_(
+            out, out_type,
+            reinterpret_cast<llaisys::fp16_t *>(res_out),
+            reinterpret_cast<const llaisys::fp16_t *>(a),
+            reinterpret_cast<const llaisys::fp16_t *>(b),
+            weight, ld, rows, cols, eps);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,33 @@
+#pragma once
+#include "llaisys.h"
+
+#include <cstddef>
+
+namespace llaisys::ops::cpu {
+// Row strides (leading dimensions) of the four row-major operands, in elements
+struct AddRmsNormStrides {
+    ptrdiff_t out;
+    ptrdiff_t res;
+    ptrdiff_t a;
+    ptrdiff_t b;
+};
+
+/**
+ * @brief CPU implementation for fused residual add + RMS Norm
+ * @param out Normalized output pointer
+ * @param out_type Data type of the normalized output
+ * @param res_out Residual output pointer (a + b), may alias a or b
+ * @param a First input pointer
+ * @param b Second input pointer
+ * @param type Data type of res_out, a and b
+ * @param w Weight pointer
+ * @param w_type Weight data type
+ * @param ld Row strides of out, res_out, a and b
+ * @param rows Number of rows (Batch size, M)
+ * @param cols Number of columns (Hidden dim, d)
+ * @param eps Epsilon
+ */
+void add_rms_norm(std::byte *out, llaisysDataType_t out_type, std::byte *res_out, const std::byte *a,
+                  const std::byte *b, llaisysDataType_t type, const std::byte *w, llaisysDataType_t w_type,
+                  const AddRmsNormStrides &ld, size_t rows, size_t cols, float eps);
+}
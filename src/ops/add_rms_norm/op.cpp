@@ -0,0 +1,69 @@
+#include "op.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+#include "../graph/graph.hpp"
+
+#include "cpu/add_rms_norm_cpu.hpp"
+
+namespace llaisys::ops {
+void add_rms_norm(const tensor_t &out, const tensor_t &res_out, const tensor_t &a, const tensor_t &b, const tensor_t &weight, float eps) {
+    // 1. Check Device Consistency
+    CHECK_SAME_DEVICE(out, res_out, a, b, weight);
+
+    // 2. Check Dtype
+    // The residual and both inputs share one dtype; the normalized output and the
+    // weight may be any floating-point type.
+    CHECK_SAME_DTYPE(res_out->dtype(), a->dtype(), b->dtype());
+    CHECK_FLOAT_DTYPE(out->dtype(), res_out->dtype(), weight->dtype());
+
+    // 3. Check Shapes
+    // Inputs/Outputs: [M, d], Weight: [d]
+    ASSERT(a->ndim() == 2, "AddRMSNorm: Input must be 2D");
+    ASSERT(weight->ndim() == 1, "AddRMSNorm: Weight must be 1D");
+    CHECK_SAME_SHAPE(out->shape(), res_out->shape(), a->shape(), b->shape());
+
+    size_t M = a->shape()[0];
+    size_t d = a->shape()[1];
+    ASSERT(weight->shape()[0] == d, "AddRMSNorm: Weight dim must match input feature dim.");
+    // out is written while res_out is still being read, so only res_out may be in-place.
+    ASSERT(out->data() != res_out->data() && out->data() != a->data() && out->data() != b->data(),
+           "AddRMSNorm: out must not alias the residual or the inputs.");
+
+    // 4. Check Row Layout
+    // Only the feature dim has to be dense; every operand may have its own row stride.
+    ASSERT(out->strides()[1] == 1 && res_out->strides()[1] == 1 && a->strides()[1] == 1 && b->strides()[1] == 1
+               && weight->isContiguous(),
+           "AddRMSNorm: the last dim of inputs/outputs and the weight must be contiguous.");
+    cpu::AddRmsNormStrides ld{out->strides()[0], res_out->strides()[0], a->strides()[0], b->strides()[0]};
+
+    // 5. Dispatch
+    if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        if (auto *graph = Graph::capturing()) {
+            auto o = graph->data(out), r = graph->data(res_out), x = graph->data(a), y = graph->data(b);
+            auto w = weight->data();
+            auto o_type = out->dtype(), x_type = a->dtype(), w_type = weight->dtype();
+            graph->record([=](ptrdiff_t p) {
+                cpu::add_rms_norm(o.at(p), o_type, r.at(p), x.at(p), y.at(p), x_type, w, w_type, ld, M, d, eps);
+            }, {a, b, weight}, {out, res_out});
+        }
+        return cpu::add_rms_norm(out->data(), out->dtype(), res_out->data(), a->data(), b->data(), a->dtype(),
+                                 weight->data(), weight->dtype(), ld, M, d, eps);
+    }
+
+    llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
+
+    switch (out->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return cpu::add_rms_norm(out->data(), out->dtype(), res_out->data(), a->data(), b->data(), a->dtype(),
+                                 weight->data(), weight->dtype(), ld, M, d, eps);
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+} // namespace llaisys::ops
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+// res_out = a + b; out = rms_norm(res_out) * weight. res_out may alias a or b.
+void add_rms_norm(const tensor_t &out, const tensor_t &res_out, const tensor_t &a, const tensor_t &b, const tensor_t &weight, float eps);
+}
@@ -2,11 +2,12 @@
 
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/argmax_cpu.hpp"
 
 namespace llaisys::ops {
-void argmax(tensor_t max_idx, tensor_t max_val, tensor_t vals) {
+void argmax(const tensor_t &max_idx, const tensor_t &max_val, const tensor_t &vals) {
     // 1. Check Device Consistency
     CHECK_SAME_DEVICE(max_idx, max_val, vals);
 
@@ -33,6 +34,7 @@ void argmax(tensor_t max_idx, tensor_t max_val, tensor_t vals) {
 
     // 5. Dispatch
     if (vals->deviceType() == LLAISYS_DEVICE_CPU) {
+        ASSERT(!Graph::capturing(), "Argmax: has no graph-captured form.");
         return cpu::argmax(
             max_idx->data(),
             max_val->data(),
@@ -3,5 +3,5 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void argmax(tensor_t max_idx, tensor_t max_val, tensor_t vals);
+void argmax(const tensor_t &max_idx, const tensor_t &max_val, const tensor_t &vals);
 }
@@ -0,0 +1,25 @@
+#include "cast_cpu.hpp"
+
+#include "../../../core/thread_pool/thread_pool.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+
+// 每块转换量足够大，块间并行
+static constexpr size_t CAST_BLOCK = 1 << 14;
+
+namespace llaisys::ops::cpu {
+void cast(std::byte *out, llaisysDataType_t out_type, const std::byte *in, llaisysDataType_t in_type, size_t numel) {
+    size_t out_size = llaisys::utils::dsize(out_type);
+    size_t in_size = llaisys::utils::dsize(in_type);
+    ptrdiff_t nblock = static_cast<ptrdiff_t>((numel + CAST_BLOCK - 1) / CAST_BLOCK);
+    auto run = [&](ptrdiff_t from, ptrdiff_t to) {
+        for (ptrdiff_t b = from; b < to; ++b) {
+            size_t begin = b * CAST_BLOCK;
+            size_t n = std::min(CAST_BLOCK, numel - begin);
+            llaisys::utils::convert(out + begin * out_size, out_type, in + begin * in_size, in_type, n);
+        }
+    };
+    llaisys::core::parallel_for(nblock, run);
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,16 @@
+#pragma once
+#include "llaisys.h"
+
+#include <cstddef>
+
+namespace llaisys::ops::cpu {
+/**
+ * @brief CPU implementation for dtype conversion
+ * @param out Output pointer
+ * @param out_type Output data type
+ * @param in Input pointer
+ * @param in_type Input data type
+ * @param numel Number of elements
+ */
+void cast(std::byte *out, llaisysDataType_t out_type, const std::byte *in, llaisysDataType_t in_type, size_t numel);
+}
@@ -0,0 +1,43 @@
+#include "op.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+#include "../graph/graph.hpp"
+
+#include "cpu/cast_cpu.hpp"
+
+namespace llaisys::ops {
+void cast(const tensor_t &out, const tensor_t &in) {
+    // 1. Check Device Consistency
+    CHECK_SAME_DEVICE(out, in);
+
+    // 2. Check Contiguity
+    ASSERT(out->isContiguous() && in->isContiguous(), "Cast: all tensors must be contiguous.");
+
+    // 3. Check Dtype
+    CHECK_FLOAT_DTYPE(out->dtype(), in->dtype());
+
+    // 4. Check Shapes
+    CHECK_SAME_SHAPE(out->shape(), in->shape());
+
+    // 5. Dispatch
+    if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        ASSERT(!Graph::capturing(), "Cast: has no graph-captured form.");
+        return cpu::cast(out->data(), out->dtype(), in->data(), in->dtype(), out->numel());
+    }
+
+    llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
+
+    switch (out->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return cpu::cast(out->data(), out->dtype(), in->data(), in->dtype(), out->numel());
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+} // namespace llaisys::ops
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+// Converts in to out's dtype (F32 / F16 / BF16). Shapes must match.
+void cast(const tensor_t &out, const tensor_t &in);
+}
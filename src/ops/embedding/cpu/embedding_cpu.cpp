@@ -1,85 +1,67 @@
 #include "embedding_cpu.hpp"
 
+#include "../../../core/thread_pool/thread_pool.hpp"
 #include "../../../utils.hpp"
 
-#include <cmath>
 #include <cstring>
+#include <string>
 
 
-template <typename T_DATA, typename T_IDX>
-void embedding_(T_DATA *out, const T_IDX *index, const T_DATA *weight, 
+// 长 prefill 时按行并行；行太少时线程启动开销不划算
+static constexpr size_t EMBEDDING_PARALLEL_MIN = 1 << 18; // bytes written
+
+template <typename T_IDX>
+void embedding_(std::byte *out, llaisysDataType_t out_type, const T_IDX *index,
+                const std::byte *weight, llaisysDataType_t w_type,
                 size_t num_indices, size_t embedding_dim, size_t vocab_size) {
-    
-    // 遍历每一个索引
-    for (size_t i = 0; i < num_indices; i++) {
-        T_IDX idx = index[i];
-        
-        // 简单的越界检查 (可选，但在Debug模式下很有用)
-        // 生产环境为了性能通常会省略，或者使用 ASSERT
-        if (idx < 0 || static_cast<size_t>(idx) >= vocab_size) {
-            // 这里简单处理，越界可能导致 segfault，实际工程中应抛出异常
-            continue; 
-        }
+    const size_t out_row = embedding_dim * llaisys::utils::dsize(out_type);
+    const size_t w_row = embedding_dim * llaisys::utils::dsize(w_type);
 
-        const T_DATA* src_row = weight + idx * embedding_dim;
-        T_DATA* dst_row = out + i * embedding_dim;
+    // 先检查所有索引，越界直接报错（不能在并行区里抛异常）
+    for (size_t i = 0; i < num_indices; i++) {
+        CHECK_ARGUMENT(index[i] >= 0 && static_cast<size_t>(index[i]) < vocab_size,
+                       "Embedding: index " + std::to_string(index[i]) + " out of range [0, "
+                           + std::to_string(vocab_size) + ").");
+    }
 
-        // Embedding 就是整行拷贝
-        // 使用 memcpy 效率最高，因为它利用了 SIMD
-        std::memcpy(dst_row, src_row, embedding_dim * sizeof(T_DATA));
+    // Embedding 就是整行拷贝
+    // 同类型时使用 memcpy 效率最高；类型不同（如 bf16 权重 -> f32 残差）则整行转换
+    const ptrdiff_t n = static_cast<ptrdiff_t>(num_indices);
+    auto run = [&](ptrdiff_t from, ptrdiff_t to) {
+        for (ptrdiff_t i = from; i < to; ++i) {
+            const std::byte *src_row = weight + static_cast<size_t>(index[i]) * w_row;
+            std::byte *dst_row = out + i * out_row;
+            if (out_type == w_type) {
+                std::memcpy(dst_row, src_row, out_row);
+            } else {
+                llaisys::utils::convert(dst_row, out_type, src_row, w_type, embedding_dim);
+            }
+        }
+    };
+    if (num_indices * out_row >= EMBEDDING_PARALLEL_MIN) {
+        llaisys::core::parallel_for(n, run);
+    } else {
+        run(0, n);
     }
 }
 
 namespace llaisys::ops::cpu {
 
-void embedding(std::byte *c, const std::byte *idx, const std::byte *w, 
-               llaisysDataType_t type, llaisysDataType_t index_type, 
+void embedding(std::byte *c, llaisysDataType_t type, const std::byte *idx, llaisysDataType_t index_type,
+               const std::byte *w, llaisysDataType_t w_type,
                size_t num_indices, size_t embedding_dim, size_t vocab_size) {
 
-    // 双重 Switch 分发：先分发数据类型，再分发索引类型
-    switch (type) {
-    case LLAISYS_DTYPE_F32: {
-        switch (index_type) {
-        case LLAISYS_DTYPE_I32:
-            return embedding_(reinterpret_cast<float *>(c), reinterpret_cast<const int32_t *>(idx), 
-                              reinterpret_cast<const float *>(w), num_indices, embedding_dim, vocab_size);
-        case LLAISYS_DTYPE_I64:
-            return embedding_(reinterpret_cast<float *>(c), reinterpret_cast<const int64_t *>(idx), 
-                              reinterpret_cast<const float *>(w), num_indices, embedding_dim, vocab_size);
-        default:
-            EXCEPTION_UNSUPPORTED_DATATYPE(index_type);
-        }
-        break;
-    }
-    case LLAISYS_DTYPE_BF16: {
-        switch (index_type) {
-        case LLAISYS_DTYPE_I32:
-            return embedding_(reinterpret_cast<llaisys::bf16_t *>(c), reinterpret_cast<const int32_t *>(idx), 
-                              reinterpret_cast<const llaisys::bf16_t *>(w), num_indices, embedding_dim, vocab_size);
-        case LLAISYS_DTYPE_I64:
-            return embedding_(reinterpret_cast<llaisys::bf16_t *>(c), reinterpret_cast<const int64_t *>(idx), 
-                              reinterpret_cast<const llaisys::bf16_t *>(w), num_indices, embedding_dim, vocab_size);
-        default:
-            EXCEPTION_UNSUPPORTED_DATATYPE(index_type);
-        }
-        break;
-    }
-    case LLAISYS_DTYPE_F16: {
-        switch (index_type) {
-        case LLAISYS_DTYPE_I32:
-            return embedding_(reinterpret_cast<llaisys::fp16_t *>(c), reinterpret_cast<const int32_t *>(idx), 
-                              reinterpret_cast<const llaisys::fp16_t *>(w), num_indices, embedding_dim, vocab_size);
-        case LLAISYS_DTYPE_I64:
-            return embedding_(reinterpret_cast<llaisys::fp16_t *>(c), reinterpret_cast<const int64_t *>(idx), 
-                              reinterpret_cast<const llaisys::fp16_t *>(w), num_indices, embedding_dim, vocab_size);
-        default:
-            EXCEPTION_UNSUPPORTED_DATATYPE(index_type);
-        }
-        break;
-    }
+    // 数据类型按行处理，只需要分发索引类型
+    switch (index_type) {
+    case LLAISYS_DTYPE_I32:
+        return embedding_(c, type, reinterpret_cast<const int32_t *>(idx), w, w_type,
+                          num_indices, embedding_dim, vocab_size);
+    case LLAISYS_DTYPE_I64:
+        return embedding_(c, type, reinterpret_cast<const int64_t *>(idx), w, w_type,
+                          num_indices, embedding_dim, vocab_size);
     default:
-        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+        EXCEPTION_UNSUPPORTED_DATATYPE(index_type);
     }
 }
 
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+} // namespace llaisys::ops::cpu
@@ -7,7 +7,8 @@
 
 namespace llaisys::ops::cpu {
 // void embedding(tensor_t out, tensor_t index, tensor_t weight);
-void embedding(std::byte *c, const std::byte *idx, const std::byte *w, 
-               llaisysDataType_t type, llaisysDataType_t index_type, 
+// out 与 weight 的浮点类型可以不同，拷贝时逐行转换
+void embedding(std::byte *c, llaisysDataType_t type, const std::byte *idx, llaisysDataType_t index_type,
+               const std::byte *w, llaisysDataType_t w_type,
                size_t num_indices, size_t embedding_dim, size_t vocab_size);
 }
\ No newline at end of file
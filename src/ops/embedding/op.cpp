@@ -4,11 +4,12 @@
 
 
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/embedding_cpu.hpp"
 
 namespace llaisys::ops {
-void embedding(tensor_t out, tensor_t index, tensor_t weight) {
+void embedding(const tensor_t &out, const tensor_t &index, const tensor_t &weight) {
     // 1. 检查 Device: out 和 weight 通常需要在同一个设备上
     // index 在很多框架中可以在 CPU，但为了简单起见，这里假设都在同一设备，或者遵循框架的 CHECK_SAME_DEVICE 逻辑
     CHECK_SAME_DEVICE(out, weight); 
@@ -17,8 +18,8 @@ void embedding(tensor_t out, tensor_t index, tensor_t weight) {
     ASSERT(out->isContiguous() && index->isContiguous() && weight->isContiguous(), 
            "Embedding: all tensors must be contiguous.");
 
-    // 3. 检查 dtype: out 和 weight 必须一致 (float/half)，index 必须是整型
-    CHECK_SAME_DTYPE(out->dtype(), weight->dtype());
+    // 3. 检查 dtype: out 和 weight 是浮点类型 (可以不同，按行转换)，index 必须是整型
+    CHECK_FLOAT_DTYPE(out->dtype(), weight->dtype());
     ASSERT(index->dtype() == LLAISYS_DTYPE_I32 || index->dtype() == LLAISYS_DTYPE_I64,
            "Embedding: index must be I32 or I64.");
 
@@ -38,8 +39,16 @@ void embedding(tensor_t out, tensor_t index, tensor_t weight) {
     
     // Always support cpu calculation
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::embedding(out->data(), index->data(), weight->data(), 
-                              out->dtype(), index->dtype(), 
+        if (auto *graph = Graph::capturing()) {
+            auto o = graph->data(out), idx = graph->data(index);
+            auto w = weight->data();
+            auto o_type = out->dtype(), idx_type = index->dtype(), w_type = weight->dtype();
+            graph->record([=](ptrdiff_t p) {
+                cpu::embedding(o.at(p), o_type, idx.at(p), idx_type, w, w_type, num_indices, embedding_dim, vocab_size);
+            }, {index, weight}, {out});
+        }
+        return cpu::embedding(out->data(), out->dtype(), index->data(), index->dtype(),
+                              weight->data(), weight->dtype(),
                               num_indices, embedding_dim, vocab_size);
     }
 
@@ -47,8 +56,8 @@ void embedding(tensor_t out, tensor_t index, tensor_t weight) {
 
     switch (out->deviceType()) {
     case LLAISYS_DEVICE_CPU:
-        return cpu::embedding(out->data(), index->data(), weight->data(), 
-                              out->dtype(), index->dtype(), 
+        return cpu::embedding(out->data(), out->dtype(), index->data(), index->dtype(),
+                              weight->data(), weight->dtype(),
                               num_indices, embedding_dim, vocab_size);
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
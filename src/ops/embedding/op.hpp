@@ -3,5 +3,5 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void embedding(tensor_t out, tensor_t index, tensor_t weight);
+void embedding(const tensor_t &out, const tensor_t &index, const tensor_t &weight);
 }
@@ -0,0 +1,158 @@
+#include "graph.hpp"
+
+#include "../../core/thread_pool/thread_pool.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+
+namespace llaisys::ops {
+static thread_local Graph *capturing_graph = nullptr;
+
+void Graph::beginCapture() {
+    ASSERT(capturing_graph == nullptr, "Graph: another graph is already capturing on this thread.");
+    clear();
+    capturing_graph = this;
+}
+
+void Graph::endCapture() {
+    ASSERT(capturing_graph == this, "Graph: this graph is not capturing.");
+    capturing_graph = nullptr;
+    _motions.clear();
+    link_();
+}
+
+Graph *Graph::capturing() {
+    return capturing_graph;
+}
+
+void Graph::slidesWithPosition(const tensor_t &t) {
+    auto &m = _motions.emplace(t.get(), Motion{t, 0, 0}).first->second;
+    m.data_step = t->strides()[0] * static_cast<ptrdiff_t>(t->elementSize());
+}
+
+void Graph::growsWithPosition(const tensor_t &t) {
+    auto &m = _motions.emplace(t.get(), Motion{t, 0, 0}).first->second;
+    m.dim0_step = 1;
+}
+
+Graph::Arg<std::byte *> Graph::data(const tensor_t &t) const {
+    auto it = _motions.find(t.get());
+    return {t->data(), it == _motions.end() ? 0 : it->second.data_step};
+}
+
+Graph::Arg<size_t> Graph::dim0(const tensor_t &t) const {
+    auto it = _motions.find(t.get());
+    return {t->shape()[0], it == _motions.end() ? 0 : it->second.dim0_step};
+}
+
+void Graph::record(Node node, std::initializer_list<tensor_t> reads, std::initializer_list<tensor_t> writes) {
+    Entry e{std::move(node), {}, {}, {}, 0};
+    for (const auto &t : reads) {
+        if (t) {
+            e.reads.push_back(range_(t));
+        }
+    }
+    for (const auto &t : writes) {
+        if (t) {
+            e.writes.push_back(range_(t));
+        }
+    }
+    _nodes.push_back(std::move(e));
+}
+
+// Bytes spanned by `t`'s elements (the whole box for strided views)
+Graph::Range Graph::range_(const tensor_t &t) {
+    ptrdiff_t lo = 0, hi = 0;
+    for (size_t i = 0; i < t->ndim(); i++) {
+        if (t->shape()[i] == 0) {
+            return {0, 0};
+        }
+        ptrdiff_t span = t->strides()[i] * static_cast<ptrdiff_t>(t->shape()[i] - 1);
+        (span < 0 ? lo : hi) += span;
+    }
+    const auto esize = static_cast<ptrdiff_t>(t->elementSize());
+    const auto base = reinterpret_cast<uintptr_t>(t->data());
+    return {base + lo * esize, base + (hi + 1) * esize};
+}
+
+void Graph::link_() {
+    auto any_overlap = [](const std::vector<Range> &a, const std::vector<Range> &b) {
+        for (const auto &x : a) {
+            for (const auto &y : b) {
+                if (x.lo < y.hi && y.lo < x.hi) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    std::vector<size_t> depth(_nodes.size(), 1);
+    _depth = 0;
+    for (size_t j = 0; j < _nodes.size(); j++) {
+        auto &b = _nodes[j];
+        for (size_t i = 0; i < j; i++) {
+            auto &a = _nodes[i];
+            if (any_overlap(a.writes, b.reads) || any_overlap(a.writes, b.writes) || any_overlap(a.reads, b.writes)) {
+                a.next.push_back(j);
+                b.npred++;
+                depth[j] = std::max(depth[j], depth[i] + 1);
+            }
+        }
+        _depth = std::max(_depth, depth[j]);
+    }
+    for (auto &e : _nodes) {
+        e.reads = {};
+        e.writes = {};
+    }
+    _pending.reset(new std::atomic<size_t>[_nodes.size()]);
+}
+
+void Graph::replay(ptrdiff_t delta) const {
+    auto &pool = core::ThreadPool::instance();
+    if (pool.size() == 1 || _depth == _nodes.size()) {
+        for (const auto &e : _nodes) {
+            e.fn(delta);
+        }
+        return;
+    }
+    for (size_t i = 0; i < _nodes.size(); i++) {
+        _pending[i].store(_nodes[i].npred, std::memory_order_relaxed);
+    }
+    core::TaskGroup group(pool);
+    // Runs node i, queues the successors it made ready and continues with one of them
+    // itself. A node that throws releases none, so the group drains and wait() rethrows.
+    std::function<void(size_t)> run = [&](size_t i) {
+        while (true) {
+            _nodes[i].fn(delta);
+            size_t cont = _nodes.size();
+            for (size_t j : _nodes[i].next) {
+                if (_pending[j].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                    continue;
+                }
+                if (cont == _nodes.size()) {
+                    cont = j;
+                } else {
+                    group.run([&run, j] { run(j); });
+                }
+            }
+            if (cont == _nodes.size()) {
+                return;
+            }
+            i = cont;
+        }
+    };
+    for (size_t i = 0; i < _nodes.size(); i++) {
+        if (_nodes[i].npred == 0) {
+            group.run([&run, i] { run(i); });
+        }
+    }
+    group.wait();
+}
+
+void Graph::clear() {
+    _nodes.clear();
+    _motions.clear();
+    _depth = 0;
+    _pending.reset();
+}
+} // namespace llaisys::ops
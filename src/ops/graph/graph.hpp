@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace llaisys::ops {
+// A recorded sequence of kernel calls with every check and dispatch already resolved.
+//
+// While a graph captures on a thread, each op called there validates and runs as usual and
+// also appends its resolved kernel call to the graph. replay() then re-issues exactly those
+// calls, skipping validation, device selection and dtype switches. Ops without a captured
+// form refuse to run while a graph captures, so a replay never silently drops a call.
+//
+// Captured arguments are fixed, except for tensors declared to move with the position
+// (e.g. this step's KV cache slot, or the cache prefix attention reads): replay(delta)
+// shifts their data pointers / leading dims by `delta` positions from the captured step.
+//
+// Every node also records the byte ranges it reads and writes. Two nodes depend on each
+// other when one writes what the other reads or writes; with a multi-threaded pool, replay
+// starts each node as soon as its predecessors are done, so independent ops (the q/k/v or
+// gate/up projections of a decode step) overlap instead of each waiting for the last.
+// Moving tensors keep their overlaps at every position, so the edges found at capture hold.
+class Graph {
+public:
+    using Node = std::function<void(ptrdiff_t)>;
+
+    // A captured value that advances by `step` per position
+    template <typename T>
+    struct Arg {
+        T base;
+        ptrdiff_t step;
+        T at(ptrdiff_t delta) const { return base + delta * step; }
+    };
+
+    void beginCapture();
+    void endCapture();
+    // The graph capturing on this thread, if any
+    static Graph *capturing();
+
+    // Declares, during capture, that `t`'s data moves by one dim-0 row per position
+    void slidesWithPosition(const tensor_t &t);
+    // Declares, during capture, that `t`'s dim 0 grows by one per position
+    void growsWithPosition(const tensor_t &t);
+
+    // Used by ops while capturing
+    Arg<std::byte *> data(const tensor_t &t) const;
+    Arg<size_t> dim0(const tensor_t &t) const;
+    // Used by ops while capturing: `node` reads `reads` and writes `writes` (null tensors
+    // are ignored)
+    void record(Node node, std::initializer_list<tensor_t> reads, std::initializer_list<tensor_t> writes);
+
+    void replay(ptrdiff_t delta) const;
+    void clear();
+
+    bool empty() const { return _nodes.empty(); }
+    size_t size() const { return _nodes.size(); }
+    // Nodes on the longest dependency chain
+    size_t depth() const { return _depth; }
+
+private:
+    struct Range {
+        uintptr_t lo, hi; // [lo, hi)
+    };
+    struct Entry {
+        Node fn;
+        std::vector<Range> reads, writes; // capture only
+        std::vector<size_t> next;         // nodes waiting on this one
+        size_t npred;
+    };
+    static Range range_(const tensor_t &t);
+    void link_();
+
+    struct Motion {
+        tensor_t tensor; // held so a pooled Tensor is not reused under the same address
+        ptrdiff_t data_step;
+        ptrdiff_t dim0_step;
+    };
+    std::vector<Entry> _nodes;
+    std::unordered_map<const Tensor *, Motion> _motions; // capture only
+    size_t _depth = 0;
+    // Predecessors still running, per node, during a concurrent replay
+    mutable std::unique_ptr<std::atomic<size_t>[]> _pending;
+};
+} // namespace llaisys::ops
@@ -1,87 +1,147 @@
 #include "linear_cpu.hpp"
 
+#include "../../../core/thread_pool/thread_pool.hpp"
 #include "../../../utils.hpp"
 
 #include <cmath>
+#include <vector>
 
-// Template implementation
-template <typename T>
-void linear_(T *out, const T *in, const T *weight, const T *bias, size_t M, size_t N, size_t K) {
+// Float scratch kept per thread and reused across calls, so converting activations and
+// weight rows does not hit the heap every time. A thread waiting in parallel_for may run
+// another linear (decode-graph nodes run concurrently), so a slot already in use falls back
+// to a buffer of its own, as do requests too large to keep around.
+struct ScratchSlot {
+    std::vector<float> buf;
+    bool busy = false;
+};
+
+class Scratch {
+public:
+    static constexpr size_t MAX_KEPT = size_t(4) << 20; // floats, i.e. 16 MB per slot
+
+    Scratch(ScratchSlot &slot, size_t n) : _slot(slot.busy || n == 0 || n > MAX_KEPT ? nullptr : &slot) {
+        if (_slot) {
+            _slot->busy = true;
+            if (_slot->buf.size() < n) {
+                _slot->buf.resize(n);
+            }
+            _data = _slot->buf.data();
+        } else {
+            _own.resize(n);
+            _data = _own.data();
+        }
+    }
+    ~Scratch() {
+        if (_slot) {
+            _slot->busy = false;
+        }
+    }
+
+    Scratch(const Scratch &) = delete;
+    Scratch &operator=(const Scratch &) = delete;
+
+    float *data() { return _data; }
+
+private:
+    ScratchSlot *_slot;
+    std::vector<float> _own;
+    float *_data = nullptr;
+};
+
+static thread_local ScratchSlot x_slot, b_slot, y_slot, w_slot;
+
+// Template implementation, on the weight type. X is already float; Y is written as float
+// and converted by the caller.
+template <typename TW>
+void linear_(float *y, const float *x, const TW *weight, ptrdiff_t ldw, const float *bias, size_t M, size_t N,
+             size_t K) {
     // Naive Matrix Multiplication: O(M * N * K)
     // Y[m, n] = dot(X[m, :], W[n, :]) + b[n]
-    
-    // Parallelize outer loops if OMP is enabled (optional/implied context)
-    // #pragma omp parallel for collapse(2)
-    for (size_t m = 0; m < M; ++m) {
-        for (size_t n = 0; n < N; ++n) {
-            float sum = 0.0f;
-            
-            // Dot product
-            // in is [M, K], accessed as in[m * K + k]
-            // weight is [N, K], accessed as weight[n * K + k]
-            for (size_t k = 0; k < K; ++k) {
-                float x_val = 0.f;
-                float w_val = 0.f;
-
-                if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                     x_val = llaisys::utils::cast<float>(in[m * K + k]);
-                     w_val = llaisys::utils::cast<float>(weight[n * K + k]);
-                } else {
-                     x_val = static_cast<float>(in[m * K + k]);
-                     w_val = static_cast<float>(weight[n * K + k]);
-                }
-                
-                sum += x_val * w_val;
+    //
+    // 半精度权重每行只整体转换一次，而不是在最内层循环里逐元素转换。
+    //
+    // Rows of W are split into equal contiguous blocks, one per pool thread, so with
+    // NUMA-pinned threads and LLAISYS_NUMA_PARTITION weights each thread streams node-local rows.
+    auto run = [&](size_t from, size_t to) {
+        Scratch w_row(w_slot, std::is_same_v<TW, float> ? 0 : K);
+
+        for (size_t n = from; n < to; ++n) {
+            const float *w = nullptr;
+            if constexpr (std::is_same_v<TW, float>) {
+                w = weight + n * ldw;
+            } else {
+                llaisys::utils::to_f32(w_row.data(), weight + n * ldw, K);
+                w = w_row.data();
             }
 
-            // Add bias if provided
-            if (bias) {
-                float b_val = 0.f;
-                if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                    b_val = llaisys::utils::cast<float>(bias[n]);
-                } else {
-                    b_val = static_cast<float>(bias[n]);
+            for (size_t m = 0; m < M; ++m) {
+                // Dot product: x is [M, K], w is row n of [N, K]
+                const float *x_row = x + m * K;
+                float sum = 0.0f;
+                for (size_t k = 0; k < K; ++k) {
+                    sum += x_row[k] * w[k];
                 }
-                sum += b_val;
-            }
 
-            // Write back to output
-            if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                out[m * N + n] = llaisys::utils::cast<T>(sum);
-            } else {
-                out[m * N + n] = static_cast<T>(sum);
+                // Add bias if provided
+                if (bias) {
+                    sum += bias[n];
+                }
+
+                y[m * N + n] = sum;
             }
         }
+    };
+    if (N * K >= (size_t(1) << 16)) {
+        llaisys::core::parallel_for(N, run);
+    } else {
+        run(0, N);
     }
 }
 
 namespace llaisys::ops::cpu {
-void linear(std::byte *c, const std::byte *a, const std::byte *w, const std::byte *b, 
-            llaisysDataType_t type, size_t M, size_t N, size_t K) {
-    switch (type) {
+void linear(std::byte *c, llaisysDataType_t c_type, ptrdiff_t ldc, const std::byte *a, llaisysDataType_t a_type,
+            ptrdiff_t lda, const std::byte *w, ptrdiff_t ldw, const std::byte *b, llaisysDataType_t w_type,
+            size_t M, size_t N, size_t K) {
+    // Activations and bias are handled in float; the output is converted at the end
+    // unless it is already dense F32. Strided rows are packed into dense buffers.
+    const bool x_direct = a_type == LLAISYS_DTYPE_F32 && (M == 1 || lda == static_cast<ptrdiff_t>(K));
+    const bool y_direct = c_type == LLAISYS_DTYPE_F32 && (M == 1 || ldc == static_cast<ptrdiff_t>(N));
+    const size_t a_size = llaisys::utils::dsize(a_type);
+    const size_t c_size = llaisys::utils::dsize(c_type);
+
+    Scratch x_buf(x_slot, x_direct ? 0 : M * K);
+    const float *x = reinterpret_cast<const float *>(a);
+    if (!x_direct) {
+        for (size_t m = 0; m < M; ++m) {
+            llaisys::utils::convert(x_buf.data() + m * K, LLAISYS_DTYPE_F32, a + m * lda * a_size, a_type, K);
+        }
+        x = x_buf.data();
+    }
+
+    Scratch b_buf(b_slot, b && w_type != LLAISYS_DTYPE_F32 ? N : 0);
+    const float *bias = b ? llaisys::utils::as_f32(b, w_type, b_buf.data(), N) : nullptr;
+
+    Scratch y_buf(y_slot, y_direct ? 0 : M * N);
+    float *y = y_direct ? reinterpret_cast<float *>(c) : y_buf.data();
+
+    switch (w_type) {
     case LLAISYS_DTYPE_F32:
-        return linear_(
-            reinterpret_cast<float *>(c), 
-            reinterpret_cast<const float *>(a),
-            reinterpret_cast<const float *>(w), 
-            reinterpret_cast<const float *>(b), 
-            M, N, K);
+        linear_(y, x, reinterpret_cast<const float *>(w), ldw, bias, M, N, K);
+        break;
     case LLAISYS_DTYPE_BF16:
-        return linear_(
-            reinterpret_cast<llaisys::bf16_t *>(c), 
-            reinterpret_cast<const llaisys::bf16_t *>(a),
-            reinterpret_cast<const llaisys::bf16_t *>(w),
-            reinterpret_cast<const llaisys::bf16_t *>(b), 
-            M, N, K);
+        linear_(y, x, reinterpret_cast<const llaisys::bf16_t *>(w), ldw, bias, M, N, K);
+        break;
     case LLAISYS_DTYPE_F16:
-        return linear_(
-            reinterpret_cast<llaisys::fp16_t *>(c), 
-            reinterpret_cast<const llaisys::fp16_t *>(a),
-            reinterpret_cast<const llaisys::fp16_t *>(w),
-            reinterpret_cast<const llaisys::fp16_t *>(b), 
-            M, N, K);
+        linear_(y, x, reinterpret_cast<const llaisys::fp16_t *>(w), ldw, bias, M, N, K);
+        break;
     default:
-        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+        EXCEPTION_UNSUPPORTED_DATATYPE(w_type);
+    }
+
+    if (!y_direct) {
+        for (size_t m = 0; m < M; ++m) {
+            llaisys::utils::convert(c + m * ldc * c_size, c_type, y + m * N, LLAISYS_DTYPE_F32, N);
+        }
     }
 }
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+} // namespace llaisys::ops::cpu
@@ -7,14 +7,20 @@ namespace llaisys::ops::cpu {
 /**
  * @brief CPU implementation for Linear
  * @param c Output pointer (Y)
+ * @param c_type Output data type
+ * @param ldc Row stride of Y, in elements
  * @param a Input pointer (X)
+ * @param a_type Input data type
+ * @param lda Row stride of X, in elements
  * @param w Weight pointer (W)
+ * @param ldw Row stride of W, in elements
  * @param b Bias pointer (b), can be nullptr
- * @param type Data type
+ * @param w_type Data type of weight and bias
  * @param M Batch size (rows of X)
  * @param N Output features (rows of W)
  * @param K Input features (cols of X and cols of W)
  */
-void linear(std::byte *c, const std::byte *a, const std::byte *w, const std::byte *b, 
-            llaisysDataType_t type, size_t M, size_t N, size_t K);
+void linear(std::byte *c, llaisysDataType_t c_type, ptrdiff_t ldc, const std::byte *a, llaisysDataType_t a_type,
+            ptrdiff_t lda, const std::byte *w, ptrdiff_t ldw, const std::byte *b, llaisysDataType_t w_type,
+            size_t M, size_t N, size_t K);
 }
\ No newline at end of file
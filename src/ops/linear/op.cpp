@@ -2,31 +2,27 @@
 
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/linear_cpu.hpp"
 
 namespace llaisys::ops {
-void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
+void linear(const tensor_t &out, const tensor_t &in, const tensor_t &weight, const tensor_t &bias) {
 // 1. Check Device Consistency
     CHECK_SAME_DEVICE(out, in, weight);
     if (bias) {
         CHECK_SAME_DEVICE(out, bias);
     }
 
-    // 2. Check Input Contiguity
-    ASSERT(out->isContiguous() && in->isContiguous() && weight->isContiguous(), 
-           "Linear: inputs/weight/output must be contiguous.");
+    // 2. Check Dtype
+    // Activations and output may differ from the weight dtype (e.g. an F32 residual
+    // stream feeding BF16 weights); the bias always matches the weight.
+    CHECK_FLOAT_DTYPE(out->dtype(), in->dtype(), weight->dtype());
     if (bias) {
-        ASSERT(bias->isContiguous(), "Linear: bias must be contiguous.");
-    }
-
-    // 3. Check Dtype
-    CHECK_SAME_DTYPE(out->dtype(), in->dtype(), weight->dtype());
-    if (bias) {
-        CHECK_SAME_DTYPE(out->dtype(), bias->dtype());
+        CHECK_SAME_DTYPE(weight->dtype(), bias->dtype());
     }
 
-    // 4. Check Shapes for MatMul: Y(M, N) = X(M, K) * W^T(K, N) + b(N)
+    // 3. Check Shapes for MatMul: Y(M, N) = X(M, K) * W^T(K, N) + b(N)
     // weight shape is [N, K] physically.
     ASSERT(in->ndim() == 2, "Linear: Input must be 2D");
     ASSERT(weight->ndim() == 2, "Linear: Weight must be 2D");
@@ -45,15 +41,33 @@ void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
         ASSERT(bias->shape()[0] == N, "Linear: Bias dim must match output feature dim (N).");
     }
 
+    // 4. Check Row Layout
+    // Rows only need a dense feature dim; the row stride (leading dimension) is free, so
+    // column slices of a packed projection can be read or written in place.
+    ASSERT(out->strides()[1] == 1 && in->strides()[1] == 1 && weight->strides()[1] == 1,
+           "Linear: the last dim of inputs/weight/output must be contiguous.");
+    if (bias) {
+        ASSERT(bias->isContiguous(), "Linear: bias must be contiguous.");
+    }
+
     // 5. Dispatch
     // Always support cpu calculation
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        if (auto *graph = Graph::capturing()) {
+            auto c = graph->data(out), a = graph->data(in);
+            auto w = weight->data(), b = bias ? bias->data() : nullptr;
+            auto c_type = out->dtype(), a_type = in->dtype(), w_type = weight->dtype();
+            ptrdiff_t ldc = out->strides()[0], lda = in->strides()[0], ldw = weight->strides()[0];
+            graph->record([=](ptrdiff_t p) {
+                cpu::linear(c.at(p), c_type, ldc, a.at(p), a_type, lda, w, ldw, b, w_type, M, N, K);
+            }, {in, weight, bias}, {out});
+        }
         return cpu::linear(
-            out->data(), 
-            in->data(), 
-            weight->data(), 
+            out->data(), out->dtype(), out->strides()[0],
+            in->data(), in->dtype(), in->strides()[0],
+            weight->data(), weight->strides()[0],
             bias ? bias->data() : nullptr, // Handle optional bias
-            out->dtype(), 
+            weight->dtype(), 
             M, N, K
         );
     }
@@ -62,7 +76,9 @@ void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
 
     switch (out->deviceType()) {
     case LLAISYS_DEVICE_CPU:
-        return cpu::linear(out->data(), in->data(), weight->data(), bias ? bias->data() : nullptr, out->dtype(), M, N, K);
+        return cpu::linear(out->data(), out->dtype(), out->strides()[0], in->data(), in->dtype(), in->strides()[0],
+                           weight->data(), weight->strides()[0], bias ? bias->data() : nullptr, weight->dtype(),
+                           M, N, K);
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
         TO_BE_IMPLEMENTED();
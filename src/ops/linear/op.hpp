@@ -3,5 +3,5 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias);
+void linear(const tensor_t &out, const tensor_t &in, const tensor_t &weight, const tensor_t &bias);
 }
@@ -0,0 +1,169 @@
+// simd.hpp pulls in immintrin.h, which must come before llaisys.h.
+#include "../../../utils/simd.hpp"
+
+#include "lm_head_topk_cpu.hpp"
+
+#include "../../../core/thread_pool/thread_pool.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// 词表按固定大小分片，分片之间并行；分片数与线程数无关，结果是确定的
+static constexpr size_t LM_HEAD_SHARD = 4096;
+
+#ifdef LLAISYS_X86_SIMD
+// The 16-wide part of dot_; returns how many elements it did
+LLAISYS_AVX2_FMA static size_t dot_avx2_(const float *x, const float *w, size_t n, float &sum) {
+    size_t i = 0;
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(w + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(w + i + 8), acc1);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    lo = _mm_hadd_ps(lo, lo);
+    lo = _mm_hadd_ps(lo, lo);
+    sum = _mm_cvtss_f32(lo);
+    return i;
+}
+#endif
+
+static inline float dot_(const float *x, const float *w, size_t n) {
+    size_t i = 0;
+    float sum = 0.0f;
+#ifdef LLAISYS_X86_SIMD
+    if (llaisys::utils::has_avx2_fma()) {
+        i = dot_avx2_(x, w, n, sum);
+    }
+#endif
+    for (; i < n; ++i) {
+        sum += x[i] * w[i];
+    }
+    return sum;
+}
+
+namespace {
+struct Cand {
+    float val;
+    int64_t idx;
+};
+
+// a ranks before b: larger logit first, lower index on ties (same as argmax)
+inline bool better_(const Cand &a, const Cand &b) {
+    return a.val > b.val || (a.val == b.val && a.idx < b.idx);
+}
+
+// The k best candidates seen so far, as a heap whose front is the worst kept one
+struct TopK {
+    size_t k = 0;
+    std::vector<Cand> heap;
+
+    void push(const Cand &c) {
+        if (heap.size() < k) {
+            heap.push_back(c);
+            std::push_heap(heap.begin(), heap.end(), better_);
+        } else if (better_(c, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better_);
+            heap.back() = c;
+            std::push_heap(heap.begin(), heap.end(), better_);
+        }
+    }
+};
+
+// Running log-sum-exp: sum(exp(x - max))
+struct Lse {
+    float max = -std::numeric_limits<float>::infinity();
+    float sum = 0.0f;
+
+    void push(float v) {
+        if (v > max) {
+            sum = sum * std::exp(max - v) + 1.0f;
+            max = v;
+        } else {
+            sum += std::exp(v - max);
+        }
+    }
+
+    void merge(const Lse &o) {
+        if (o.sum == 0.0f) {
+            return;
+        }
+        if (o.max > max) {
+            sum = sum * std::exp(max - o.max) + o.sum;
+            max = o.max;
+        } else {
+            sum += o.sum * std::exp(o.max - max);
+        }
+    }
+};
+
+struct Shard {
+    std::vector<TopK> top; // per row
+    std::vector<Lse> lse;  // per row
+};
+} // namespace
+
+namespace llaisys::ops::cpu {
+void lm_head_topk(int64_t *out_idx, float *out_val, float *lse, const std::byte *hidden, llaisysDataType_t h_type,
+                  ptrdiff_t ldh, const std::byte *w, llaisysDataType_t w_type, size_t M, size_t V, size_t K,
+                  size_t k) {
+    // Hidden rows are converted to float once; each weight row is converted once and
+    // dotted against every hidden row, so W is streamed exactly once per call.
+    std::vector<float> x(M * K);
+    const size_t h_size = llaisys::utils::dsize(h_type);
+    for (size_t m = 0; m < M; ++m) {
+        llaisys::utils::convert(x.data() + m * K, LLAISYS_DTYPE_F32, hidden + m * ldh * h_size, h_type, K);
+    }
+    const size_t w_row = K * llaisys::utils::dsize(w_type);
+
+    const ptrdiff_t nshard = static_cast<ptrdiff_t>((V + LM_HEAD_SHARD - 1) / LM_HEAD_SHARD);
+    std::vector<Shard> shards(nshard);
+
+    // Shards are handed out one at a time and balanced by stealing
+    llaisys::core::parallel_for(nshard, [&](ptrdiff_t from, ptrdiff_t to) {
+        std::vector<float> w_buf(w_type == LLAISYS_DTYPE_F32 ? 0 : K);
+        for (ptrdiff_t s = from; s < to; ++s) {
+            Shard &shard = shards[s];
+            shard.top.assign(M, TopK{k, {}});
+            shard.lse.assign(lse ? M : 0, Lse{});
+            size_t begin = s * LM_HEAD_SHARD;
+            size_t end = std::min(V, begin + LM_HEAD_SHARD);
+            for (size_t n = begin; n < end; ++n) {
+                const float *wr = llaisys::utils::as_f32(w + n * w_row, w_type, w_buf.data(), K);
+                for (size_t m = 0; m < M; ++m) {
+                    float logit = dot_(x.data() + m * K, wr, K);
+                    shard.top[m].push({logit, static_cast<int64_t>(n)});
+                    if (lse) {
+                        shard.lse[m].push(logit);
+                    }
+                }
+            }
+        }
+    }, 1);
+
+    // 合并各分片：候选排序后取前 k 个，log-sum-exp 按最大值对齐后相加
+    for (size_t m = 0; m < M; ++m) {
+        std::vector<Cand> cands;
+        Lse total;
+        for (auto &shard : shards) {
+            cands.insert(cands.end(), shard.top[m].heap.begin(), shard.top[m].heap.end());
+            if (lse) {
+                total.merge(shard.lse[m]);
+            }
+        }
+        std::partial_sort(cands.begin(), cands.begin() + k, cands.end(), better_);
+        for (size_t j = 0; j < k; ++j) {
+            out_idx[m * k + j] = cands[j].idx;
+            out_val[m * k + j] = cands[j].val;
+        }
+        if (lse) {
+            lse[m] = total.max + std::log(total.sum);
+        }
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,26 @@
+#pragma once
+#include "llaisys.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llaisys::ops::cpu {
+/**
+ * @brief CPU implementation for the fused LM head + top-k
+ * @param out_idx Output indices [M, k]
+ * @param out_val Output logits [M, k], F32
+ * @param lse Output log-sum-exp [M], F32, can be nullptr
+ * @param hidden Hidden states pointer [M, K]
+ * @param h_type Hidden states data type
+ * @param ldh Row stride of the hidden states, in elements
+ * @param w Weight pointer [V, K], contiguous
+ * @param w_type Weight data type
+ * @param M Number of rows
+ * @param V Vocabulary size (rows of W)
+ * @param K Hidden size
+ * @param k Number of candidates kept per row
+ */
+void lm_head_topk(int64_t *out_idx, float *out_val, float *lse, const std::byte *hidden, llaisysDataType_t h_type,
+                  ptrdiff_t ldh, const std::byte *w, llaisysDataType_t w_type, size_t M, size_t V, size_t K,
+                  size_t k);
+} // namespace llaisys::ops::cpu
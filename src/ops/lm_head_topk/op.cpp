@@ -0,0 +1,82 @@
+#include "op.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+#include "../graph/graph.hpp"
+
+#include "cpu/lm_head_topk_cpu.hpp"
+
+namespace llaisys::ops {
+void lm_head_topk(const tensor_t &out_idx, const tensor_t &out_val, const tensor_t &lse, const tensor_t &hidden, const tensor_t &weight) {
+    // 1. Check Device Consistency
+    CHECK_SAME_DEVICE(out_idx, out_val, hidden, weight);
+    if (lse) {
+        CHECK_SAME_DEVICE(out_idx, lse);
+    }
+
+    // 2. Check Dtype
+    ASSERT(out_idx->dtype() == LLAISYS_DTYPE_I64, "LMHeadTopK: out_idx must be INT64.");
+    ASSERT(out_val->dtype() == LLAISYS_DTYPE_F32, "LMHeadTopK: out_val must be F32.");
+    if (lse) {
+        ASSERT(lse->dtype() == LLAISYS_DTYPE_F32, "LMHeadTopK: lse must be F32.");
+    }
+    CHECK_FLOAT_DTYPE(hidden->dtype(), weight->dtype());
+
+    // 3. Check Shapes
+    // hidden: [M, K], weight: [V, K], out_idx / out_val: [M, k], lse: [M]
+    ASSERT(hidden->ndim() == 2, "LMHeadTopK: hidden must be 2D");
+    ASSERT(weight->ndim() == 2, "LMHeadTopK: weight must be 2D");
+    ASSERT(out_idx->ndim() == 2, "LMHeadTopK: out_idx must be 2D");
+
+    size_t M = hidden->shape()[0];
+    size_t K = hidden->shape()[1];
+    size_t V = weight->shape()[0];
+    size_t k = out_idx->shape()[1];
+
+    ASSERT(weight->shape()[1] == K, "LMHeadTopK: weight feature dim must match hidden feature dim.");
+    CHECK_SAME_SHAPE(out_idx->shape(), out_val->shape());
+    ASSERT(out_idx->shape()[0] == M, "LMHeadTopK: output rows must match hidden rows.");
+    ASSERT(k >= 1 && k <= V, "LMHeadTopK: k must be in [1, vocab size].");
+    if (lse) {
+        ASSERT(lse->ndim() == 1 && lse->shape()[0] == M, "LMHeadTopK: lse must be [M].");
+    }
+
+    // 4. Check Contiguity
+    ASSERT(hidden->strides()[1] == 1, "LMHeadTopK: the last dim of hidden must be contiguous.");
+    ASSERT(weight->isContiguous() && out_idx->isContiguous() && out_val->isContiguous()
+               && (!lse || lse->isContiguous()),
+           "LMHeadTopK: weight and outputs must be contiguous.");
+
+    // 5. Dispatch
+    if (out_idx->deviceType() == LLAISYS_DEVICE_CPU) {
+        if (auto *graph = Graph::capturing()) {
+            auto idx = graph->data(out_idx), val = graph->data(out_val), h = graph->data(hidden);
+            auto l = lse ? graph->data(lse) : Graph::Arg<std::byte *>{nullptr, 0};
+            auto w = weight->data();
+            auto h_type = hidden->dtype(), w_type = weight->dtype();
+            ptrdiff_t ldh = hidden->strides()[0];
+            graph->record([=](ptrdiff_t p) {
+                cpu::lm_head_topk(reinterpret_cast<int64_t *>(idx.at(p)), reinterpret_cast<float *>(val.at(p)),
+                                  reinterpret_cast<float *>(l.at(p)), h.at(p), h_type, ldh, w, w_type, M, V, K, k);
+            }, {hidden, weight}, {out_idx, out_val, lse});
+        }
+        return cpu::lm_head_topk(reinterpret_cast<int64_t *>(out_idx->data()),
+                                 reinterpret_cast<float *>(out_val->data()),
+                                 lse ? reinterpret_cast<float *>(lse->data()) : nullptr,
+                                 hidden->data(), hidden->dtype(), hidden->strides()[0],
+                                 weight->data(), weight->dtype(), M, V, K, k);
+    }
+
+    llaisys::core::context().setDevice(out_idx->deviceType(), out_idx->deviceId());
+
+    switch (out_idx->deviceType()) {
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+} // namespace llaisys::ops
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+// Top-k of logits = hidden @ weight^T without materializing the logits.
+// out_idx: I64 [M, k], out_val: F32 [M, k], both sorted best-first (ties go to the lower
+// index). lse (F32 [M], may be null) receives log(sum(exp(logits))) of every row.
+void lm_head_topk(const tensor_t &out_idx, const tensor_t &out_val, const tensor_t &lse, const tensor_t &hidden, const tensor_t &weight);
+}
@@ -1,92 +1,250 @@
 #include "rearrange_cpu.hpp"
 
+#include "../../../core/thread_pool/thread_pool.hpp"
 #include "../../../utils.hpp"
-#include <type_traits>
-
-// Recursive function to handle N-dimensional iteration
-template <typename T>
-void rearrange_recursive(T *out_ptr, const T *in_ptr,
-                         const std::vector<size_t>& shape,      // shape 是 size_t
-                         const std::vector<int64_t>& out_strides, // strides 是 int64_t
-                         const std::vector<int64_t>& in_strides, // strides 是 int64_t
-                         size_t ndim,
-                         size_t current_dim,
-                         int64_t out_offset,
-                         int64_t in_offset) {
-    
-    // Base case: If we are at the last dimension, iterate and copy
-    if (current_dim == ndim - 1) {
-        size_t len = shape[current_dim];
-        int64_t s_out = out_strides[current_dim];
-        int64_t s_in = in_strides[current_dim];
-
-        for (size_t i = 0; i < len; ++i) {
-            // Copy value
-            out_ptr[out_offset + i * s_out] = in_ptr[in_offset + i * s_in];
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+// 多线程阈值与分块大小（字节）
+static constexpr size_t REARRANGE_PARALLEL_MIN = 1 << 20;
+static constexpr size_t REARRANGE_CHUNK = 1 << 16;
+// 转置分块边长（元素）
+static constexpr size_t TRANSPOSE_TILE = 32;
+
+namespace {
+// One loop dimension, strides in bytes
+struct Dim {
+    size_t n;
+    ptrdiff_t so;
+    ptrdiff_t si;
+};
+
+// Per-element strided copy along one dimension
+template <typename E>
+void copy_strided_(std::byte *out, const std::byte *in, size_t n, ptrdiff_t so, ptrdiff_t si) {
+    for (size_t i = 0; i < n; ++i) {
+        *reinterpret_cast<E *>(out + i * so) = *reinterpret_cast<const E *>(in + i * si);
+    }
+}
+
+// out[r * so_r + c * sizeof(E)] = in[r * sizeof(E) + c * si_c], tiled so both sides stay in cache
+template <typename E>
+void transpose_(std::byte *out, const std::byte *in, size_t rows, size_t cols, ptrdiff_t so_r, ptrdiff_t si_c) {
+    E *o = reinterpret_cast<E *>(out);
+    const E *x = reinterpret_cast<const E *>(in);
+    const ptrdiff_t so = so_r / static_cast<ptrdiff_t>(sizeof(E));
+    const ptrdiff_t si = si_c / static_cast<ptrdiff_t>(sizeof(E));
+    for (size_t r0 = 0; r0 < rows; r0 += TRANSPOSE_TILE) {
+        size_t r1 = std::min(rows, r0 + TRANSPOSE_TILE);
+        for (size_t c0 = 0; c0 < cols; c0 += TRANSPOSE_TILE) {
+            size_t c1 = std::min(cols, c0 + TRANSPOSE_TILE);
+            for (size_t r = r0; r < r1; ++r) {
+                for (size_t c = c0; c < c1; ++c) {
+                    o[r * so + c] = x[r + c * si];
+                }
+            }
         }
-        return;
+    }
+}
+
+// Copy one element of `size` bytes, loop over one dimension, or transpose two
+enum class Kernel { MEMCPY, STRIDED, TRANSPOSE };
+
+struct Plan {
+    llaisys::utils::SmallVector<Dim, llaisys::TENSOR_MAX_NDIM> outer; // 外层循环维度，由 odometer 遍历
+    Kernel kernel;
+    size_t run;             // MEMCPY: 连续字节数
+    Dim inner;              // STRIDED: 最内层维度；TRANSPOSE: 列维度 (out 连续)
+    Dim rows;               // TRANSPOSE: 行维度 (in 连续)
+};
+
+// 去掉长度为 1 的维度，按输出 stride 从大到小排序，合并可以合并的相邻维度，
+// 然后挑选最内层的拷贝方式。
+Plan make_plan(size_t es, const llaisys::tensor_shape_t &shape, const llaisys::tensor_strides_t &out_strides,
+               const llaisys::tensor_strides_t &in_strides, size_t ndim) {
+    llaisys::utils::SmallVector<Dim, llaisys::TENSOR_MAX_NDIM> dims;
+    for (size_t i = 0; i < ndim; ++i) {
+        if (shape[i] != 1) {
+            dims.push_back({shape[i], static_cast<ptrdiff_t>(out_strides[i] * es),
+                            static_cast<ptrdiff_t>(in_strides[i] * es)});
+        }
+    }
+    std::stable_sort(dims.begin(), dims.end(), [](const Dim &a, const Dim &b) { return a.so > b.so; });
+
+    llaisys::utils::SmallVector<Dim, llaisys::TENSOR_MAX_NDIM> merged;
+    for (const auto &d : dims) {
+        if (!merged.empty()) {
+            Dim &p = merged.back();
+            if (p.so == d.so * static_cast<ptrdiff_t>(d.n) && p.si == d.si * static_cast<ptrdiff_t>(d.n)) {
+                p = {p.n * d.n, d.so, d.si};
+                continue;
+            }
+        }
+        merged.push_back(d);
     }
 
-    // Recursive step: Iterate over current dimension and go deeper
-    size_t len = shape[current_dim];
-    int64_t s_out = out_strides[current_dim];
-    int64_t s_in = in_strides[current_dim];
-
-    for (size_t i = 0; i < len; ++i) {
-        rearrange_recursive(out_ptr, in_ptr, 
-                            shape, out_strides, in_strides, 
-                            ndim, current_dim + 1,
-                            out_offset + i * s_out,
-                            in_offset + i * s_in);
+    Plan plan{};
+    const ptrdiff_t ses = static_cast<ptrdiff_t>(es);
+    if (merged.empty()) {
+        plan.kernel = Kernel::MEMCPY;
+        plan.run = es;
+        return plan;
     }
+    Dim last = merged.back();
+    if (last.so == ses && last.si == ses) {
+        merged.pop_back();
+        plan.kernel = Kernel::MEMCPY;
+        plan.run = last.n * es;
+        plan.outer = std::move(merged);
+        return plan;
+    }
+    if (last.so == ses) {
+        // 输出最内层连续、输入在另一维上连续：按块转置
+        auto it = std::find_if(merged.begin(), merged.end() - 1, [&](const Dim &d) { return d.si == ses; });
+        if (it != merged.end() - 1) {
+            plan.kernel = Kernel::TRANSPOSE;
+            plan.rows = *it;
+            plan.inner = last;
+            merged.pop_back();
+            merged.erase(it);
+            plan.outer = std::move(merged);
+            return plan;
+        }
+    }
+    merged.pop_back();
+    plan.kernel = Kernel::STRIDED;
+    plan.inner = last;
+    plan.outer = std::move(merged);
+    return plan;
 }
 
-template <typename T>
-void rearrange_(T *out, const T *in,
-                const std::vector<size_t>& shape,
-                const std::vector<int64_t>& out_strides,
-                const std::vector<int64_t>& in_strides,
-                size_t ndim) {
-    
-    // Handle 0-dim tensor (scalar) edge case
-    if (ndim == 0) {
-        out[0] = in[0];
+// rb: TRANSPOSE 的行块编号，每个行块是一个独立的并行工作项
+template <typename E>
+void run_kernel_(const Plan &plan, std::byte *out, const std::byte *in, size_t rb) {
+    switch (plan.kernel) {
+    case Kernel::MEMCPY:
+        std::memcpy(out, in, plan.run);
+        break;
+    case Kernel::STRIDED:
+        copy_strided_<E>(out, in, plan.inner.n, plan.inner.so, plan.inner.si);
+        break;
+    case Kernel::TRANSPOSE: {
+        size_t r0 = rb * TRANSPOSE_TILE;
+        size_t r1 = std::min(plan.rows.n, r0 + TRANSPOSE_TILE);
+        transpose_<E>(out + r0 * plan.rows.so, in + r0 * plan.rows.si, r1 - r0, plan.inner.n, plan.rows.so,
+                      plan.inner.si);
+        break;
+    }
+    }
+}
+
+template <typename E>
+void rearrange_(std::byte *out, const std::byte *in, const Plan &plan, size_t total_bytes) {
+    if (plan.outer.empty() && plan.kernel == Kernel::MEMCPY) {
+        // 整块连续：分块并行 memcpy
+        const ptrdiff_t nchunk = static_cast<ptrdiff_t>((plan.run + REARRANGE_CHUNK - 1) / REARRANGE_CHUNK);
+        auto run = [&](ptrdiff_t from, ptrdiff_t to) {
+            for (ptrdiff_t c = from; c < to; ++c) {
+                size_t begin = c * REARRANGE_CHUNK;
+                std::memcpy(out + begin, in + begin, std::min(REARRANGE_CHUNK, plan.run - begin));
+            }
+        };
+        if (total_bytes >= REARRANGE_PARALLEL_MIN) {
+            llaisys::core::parallel_for(nchunk, run);
+        } else {
+            run(0, nchunk);
+        }
         return;
     }
 
-    rearrange_recursive(out, in, shape, out_strides, in_strides, ndim, 0, 0, 0);
+    const auto &outer = plan.outer;
+    const size_t nd = outer.size();
+    size_t count = 1;
+    for (const auto &d : outer) {
+        count *= d.n;
+    }
+    // 工作项：外层下标 x 转置行块
+    const size_t nrb = plan.kernel == Kernel::TRANSPOSE ? (plan.rows.n + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE : 1;
+    const size_t items = count * nrb;
+    const size_t step_bytes = std::max<size_t>(1, total_bytes / items);
+    const size_t per_chunk = std::max<size_t>(1, REARRANGE_CHUNK / step_bytes);
+    const ptrdiff_t nchunk = static_cast<ptrdiff_t>((items + per_chunk - 1) / per_chunk);
+
+    // 每块从线性下标还原出起始坐标，之后按 odometer 递增
+    auto run = [&](ptrdiff_t from, ptrdiff_t to) {
+        for (ptrdiff_t c = from; c < to; ++c) {
+            size_t begin = c * per_chunk;
+            size_t end = std::min(items, begin + per_chunk);
+            llaisys::tensor_shape_t idx(nd);
+            ptrdiff_t oo = 0, io = 0;
+            size_t rb = begin % nrb;
+            size_t rem = begin / nrb;
+            for (size_t d = nd; d-- > 0;) {
+                idx[d] = rem % outer[d].n;
+                rem /= outer[d].n;
+                oo += idx[d] * outer[d].so;
+                io += idx[d] * outer[d].si;
+            }
+            for (size_t k = begin; k < end; ++k) {
+                run_kernel_<E>(plan, out + oo, in + io, rb);
+                if (++rb < nrb) {
+                    continue;
+                }
+                rb = 0;
+                for (size_t d = nd; d-- > 0;) {
+                    oo += outer[d].so;
+                    io += outer[d].si;
+                    if (++idx[d] < outer[d].n) {
+                        break;
+                    }
+                    oo -= outer[d].so * static_cast<ptrdiff_t>(outer[d].n);
+                    io -= outer[d].si * static_cast<ptrdiff_t>(outer[d].n);
+                    idx[d] = 0;
+                }
+            }
+        }
+    };
+    if (total_bytes >= REARRANGE_PARALLEL_MIN && nchunk > 1) {
+        llaisys::core::parallel_for(nchunk, run);
+    } else {
+        run(0, nchunk);
+    }
 }
+} // namespace
 
 namespace llaisys::ops::cpu {
 void rearrange(std::byte *out, const std::byte *in, 
                llaisysDataType_t type, 
-               const std::vector<size_t>& shape,
-               const std::vector<int64_t>& out_strides,
-               const std::vector<int64_t>& in_strides,
+               const tensor_shape_t &shape,
+               const tensor_strides_t &out_strides,
+               const tensor_strides_t &in_strides,
                size_t ndim) {
-    switch (type) {
-    case LLAISYS_DTYPE_F32:
-        return rearrange_(
-            reinterpret_cast<float *>(out), 
-            reinterpret_cast<const float *>(in),
-            shape, out_strides, in_strides, ndim);
-    case LLAISYS_DTYPE_BF16:
-        return rearrange_(
-            reinterpret_cast<llaisys::bf16_t *>(out), 
-            reinterpret_cast<const llaisys::bf16_t *>(in),
-            shape, out_strides, in_strides, ndim);
-    case LLAISYS_DTYPE_F16:
-        return rearrange_(
-            reinterpret_cast<llaisys::fp16_t *>(out), 
-            reinterpret_cast<const llaisys::fp16_t *>(in),
-            shape, out_strides, in_strides, ndim);
-    case LLAISYS_DTYPE_I64:
-         return rearrange_(
-            reinterpret_cast<int64_t *>(out), 
-            reinterpret_cast<const int64_t *>(in),
-            shape, out_strides, in_strides, ndim);
+    size_t numel = 1;
+    for (size_t i = 0; i < ndim; ++i) {
+        numel *= shape[i];
+    }
+    if (numel == 0) {
+        return;
+    }
+
+    // 纯搬运，只与元素大小有关
+    const size_t es = llaisys::utils::dsize(type);
+    Plan plan = make_plan(es, shape, out_strides, in_strides, ndim);
+    const size_t total_bytes = numel * es;
+
+    switch (es) {
+    case 1:
+        return rearrange_<uint8_t>(out, in, plan, total_bytes);
+    case 2:
+        return rearrange_<uint16_t>(out, in, plan, total_bytes);
+    case 4:
+        return rearrange_<uint32_t>(out, in, plan, total_bytes);
+    case 8:
+        return rearrange_<uint64_t>(out, in, plan, total_bytes);
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
 }
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+} // namespace llaisys::ops::cpu
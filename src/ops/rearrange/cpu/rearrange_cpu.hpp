@@ -1,27 +1,32 @@
 #pragma once
 #include "llaisys.h"
 
+#include "../../../tensor/tensor_meta.hpp"
+
 #include <cstddef>
-#include <vector>
 #include <cstdint>
 
 namespace llaisys::ops::cpu {
 
 /**
  * @brief CPU implementation for Rearrange
+ *
+ * Drops size-1 dims, coalesces dims that are contiguous in both tensors, then copies with
+ * memcpy runs, a cache-tiled transpose, or a strided element loop. Large copies are split
+ * across threads.
  * @param out Output data pointer
  * @param in Input data pointer
  * @param type Data type
- * @param shape Shape vector (std::vector<size_t>)
- * @param out_strides Output strides vector (std::vector<int64_t>)
- * @param in_strides Input strides vector (std::vector<int64_t>)
+ * @param shape Shape (tensor_shape_t)
+ * @param out_strides Output strides in elements (tensor_strides_t)
+ * @param in_strides Input strides in elements (tensor_strides_t)
  * @param ndim Number of dimensions
  */
 void rearrange(std::byte *out, const std::byte *in, 
                llaisysDataType_t type, 
-               const std::vector<size_t>& shape,      // 注意：这里用 size_t
-               const std::vector<int64_t>& out_strides, // 注意：这里用 int64_t
-               const std::vector<int64_t>& in_strides, // 注意：这里用 int64_t
+               const tensor_shape_t &shape,
+               const tensor_strides_t &out_strides,
+               const tensor_strides_t &in_strides,
                size_t ndim);
 
 } // namespace llaisys::ops::cpu
\ No newline at end of file
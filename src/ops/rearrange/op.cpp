@@ -2,13 +2,12 @@
 
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/rearrange_cpu.hpp"
 
-#include <cstring> // for std::memcpy
-
 namespace llaisys::ops {
-void rearrange(tensor_t out, tensor_t in) {
+void rearrange(const tensor_t &out, const tensor_t &in) {
     // 1. Check Device Consistency
     CHECK_SAME_DEVICE(out, in);
 
@@ -19,22 +18,23 @@ void rearrange(tensor_t out, tensor_t in) {
     // Rearrange requires the logical shape to be exactly the same.
     CHECK_SAME_SHAPE(out->shape(), in->shape());
 
-    // 4. Optimization: If both are contiguous, just memcpy
-    if (out->isContiguous() && in->isContiguous()) {
-        size_t bytes = out->numel() * out->elementSize();
-        // Assuming tensor_t->data() returns void* or byte*
-        std::memcpy(out->data(), in->data(), bytes);
-        return;
-    }
-
-    // 5. Prepare Metadata for generic stride copy
+    // 4. Prepare Metadata for generic stride copy
+    // The CPU engine coalesces dimensions itself, so contiguous copies need no special case here.
     size_t ndim = out->ndim();
     const auto& shape = out->shape();
     const auto& out_strides = out->strides();
     const auto& in_strides = in->strides();
 
-    // 6. Dispatch
+    // 5. Dispatch
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        if (auto *graph = Graph::capturing()) {
+            auto o = graph->data(out), x = graph->data(in);
+            auto type = out->dtype();
+            tensor_shape_t shape_ = shape;
+            tensor_strides_t o_st = out_strides, i_st = in_strides;
+            graph->record([=](ptrdiff_t p) { cpu::rearrange(o.at(p), x.at(p), type, shape_, o_st, i_st, ndim); },
+                          {in}, {out});
+        }
         return cpu::rearrange(
             out->data(), in->data(),
             out->dtype(),
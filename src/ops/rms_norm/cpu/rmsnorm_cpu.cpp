@@ -3,26 +3,30 @@
 #include "../../../utils.hpp"
 
 #include <cmath>
+#include <vector>
+
+namespace llaisys::ops::cpu {
+void rms_norm(std::byte *c, llaisysDataType_t c_type, ptrdiff_t ldc, const std::byte *a, llaisysDataType_t a_type,
+              ptrdiff_t lda, const std::byte *w, llaisysDataType_t w_type, size_t rows, size_t cols, float eps) {
+    // 所有计算都在 float 行上进行：非 f32 的输入/输出逐行批量转换，
+    // 权重只转换一次。输入、输出和权重的类型可以各不相同。
+    std::vector<float> w_buf(w_type == LLAISYS_DTYPE_F32 ? 0 : cols);
+    const float *weight = llaisys::utils::as_f32(w, w_type, w_buf.data(), cols);
+
+    std::vector<float> x_buf(a_type == LLAISYS_DTYPE_F32 ? 0 : cols);
+    std::vector<float> y_buf(c_type == LLAISYS_DTYPE_F32 ? 0 : cols);
+    const size_t a_size = llaisys::utils::dsize(a_type);
+    const size_t c_size = llaisys::utils::dsize(c_type);
 
-template <typename T>
-void rms_norm_(T *out, const T *in, const T *weight, size_t rows, size_t cols, float eps) {
     // Iterate over each row (sample)
     for (size_t i = 0; i < rows; ++i) {
-        float sum_sq = 0.0f;
-        
-        // Offset for the current row
-        const T* row_in = in + i * cols;
-        T* row_out = out + i * cols;
+        const float *x = llaisys::utils::as_f32(a + i * lda * a_size, a_type, x_buf.data(), cols);
+        float *y = c_type == LLAISYS_DTYPE_F32 ? reinterpret_cast<float *>(c) + i * ldc : y_buf.data();
 
         // 1. Calculate Sum of Squares
+        float sum_sq = 0.0f;
         for (size_t j = 0; j < cols; ++j) {
-            float val = 0.f;
-            if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                val = llaisys::utils::cast<float>(row_in[j]);
-            } else {
-                val = static_cast<float>(row_in[j]);
-            }
-            sum_sq += val * val;
+            sum_sq += x[j] * x[j];
         }
 
         // 2. Calculate RMS and Inverse RMS
@@ -33,51 +37,12 @@ void rms_norm_(T *out, const T *in, const T *weight, size_t rows, size_t cols, f
         // 3. Normalize and Scale
         // y = (x * inv_rms) * w
         for (size_t j = 0; j < cols; ++j) {
-            float val = 0.f;
-            float w_val = 0.f;
-
-            if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                val = llaisys::utils::cast<float>(row_in[j]);
-                w_val = llaisys::utils::cast<float>(weight[j]);
-            } else {
-                val = static_cast<float>(row_in[j]);
-                w_val = static_cast<float>(weight[j]);
-            }
-
-            float result = val * inv_rms * w_val;
-
-            if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                row_out[j] = llaisys::utils::cast<T>(result);
-            } else {
-                row_out[j] = static_cast<T>(result);
-            }
+            y[j] = x[j] * inv_rms * weight[j];
         }
-    }
-}
 
-namespace llaisys::ops::cpu {
-void rms_norm(std::byte *c, const std::byte *a, const std::byte *w, llaisysDataType_t type, size_t rows, size_t cols, float eps) {
-    switch (type) {
-    case LLAISYS_DTYPE_F32:
-        return rms_norm_(
-            reinterpret_cast<float *>(c), 
-            reinterpret_cast<const float *>(a), 
-            reinterpret_cast<const float *>(w), 
-            rows, cols, eps);
-    case LLAISYS_DTYPE_BF16:
-        return rms_norm_(
-            reinterpret_cast<llaisys::bf16_t *>(c), 
-            reinterpret_cast<const llaisys::bf16_t *>(a),
-            reinterpret_cast<const llaisys::bf16_t *>(w), 
-            rows, cols, eps);
-    case LLAISYS_DTYPE_F16:
-        return rms_norm_(
-            reinterpret_cast<llaisys::fp16_t *>(c), 
-            reinterpret_cast<const llaisys::fp16_t *>(a),
-            reinterpret_cast<const llaisys::fp16_t *>(w), 
-            rows, cols, eps);
-    default:
-        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+        if (c_type != LLAISYS_DTYPE_F32) {
+            llaisys::utils::convert(c + i * ldc * c_size, c_type, y, LLAISYS_DTYPE_F32, cols);
+        }
     }
 }
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+} // namespace llaisys::ops::cpu
@@ -7,12 +7,17 @@ namespace llaisys::ops::cpu {
 /**
  * @brief CPU implementation for RMS Norm
  * @param c Output pointer
+ * @param c_type Output data type
+ * @param ldc Row stride of the output, in elements
  * @param a Input pointer
+ * @param a_type Input data type
+ * @param lda Row stride of the input, in elements
  * @param w Weight pointer
- * @param type Data type
+ * @param w_type Weight data type
  * @param rows Number of rows (Batch size, M)
  * @param cols Number of columns (Hidden dim, d)
  * @param eps Epsilon
  */
-void rms_norm(std::byte *c, const std::byte *a, const std::byte *w, llaisysDataType_t type, size_t rows, size_t cols, float eps);
+void rms_norm(std::byte *c, llaisysDataType_t c_type, ptrdiff_t ldc, const std::byte *a, llaisysDataType_t a_type,
+              ptrdiff_t lda, const std::byte *w, llaisysDataType_t w_type, size_t rows, size_t cols, float eps);
 }
\ No newline at end of file
@@ -2,22 +2,20 @@
 
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/rmsnorm_cpu.hpp"
 
 namespace llaisys::ops {
-void rms_norm(tensor_t out, tensor_t in, tensor_t weight, float eps) {
+void rms_norm(const tensor_t &out, const tensor_t &in, const tensor_t &weight, float eps) {
 // 1. Check Device Consistency
     CHECK_SAME_DEVICE(out, in, weight);
 
-    // 2. Check Contiguity
-    ASSERT(out->isContiguous() && in->isContiguous() && weight->isContiguous(), 
-           "RMSNorm: inputs/weight/output must be contiguous.");
+    // 2. Check Dtype
+    // Input, output and weight may each be any floating-point type.
+    CHECK_FLOAT_DTYPE(out->dtype(), in->dtype(), weight->dtype());
 
-    // 3. Check Dtype
-    CHECK_SAME_DTYPE(out->dtype(), in->dtype(), weight->dtype());
-
-    // 4. Check Shapes
+    // 3. Check Shapes
     // Input/Output: [M, d], Weight: [d]
     ASSERT(in->ndim() == 2, "RMSNorm: Input must be 2D");
     ASSERT(out->ndim() == 2, "RMSNorm: Output must be 2D");
@@ -30,16 +28,32 @@ void rms_norm(tensor_t out, tensor_t in, tensor_t weight, float eps) {
     ASSERT(out->shape()[1] == d, "RMSNorm: Output feature dim must match input.");
     ASSERT(weight->shape()[0] == d, "RMSNorm: Weight dim must match input feature dim.");
 
+    // 4. Check Row Layout
+    // Only the feature dim has to be dense; rows may be strided (e.g. per-head views).
+    ASSERT(out->strides()[1] == 1 && in->strides()[1] == 1 && weight->isContiguous(),
+           "RMSNorm: the last dim of input/output and the weight must be contiguous.");
+
     // 5. Dispatch
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::rms_norm(out->data(), in->data(), weight->data(), out->dtype(), M, d, eps);
+        if (auto *graph = Graph::capturing()) {
+            auto o = graph->data(out), x = graph->data(in);
+            auto w = weight->data();
+            auto o_type = out->dtype(), x_type = in->dtype(), w_type = weight->dtype();
+            ptrdiff_t o_ld = out->strides()[0], x_ld = in->strides()[0];
+            graph->record([=](ptrdiff_t p) {
+                cpu::rms_norm(o.at(p), o_type, o_ld, x.at(p), x_type, x_ld, w, w_type, M, d, eps);
+            }, {in, weight}, {out});
+        }
+        return cpu::rms_norm(out->data(), out->dtype(), out->strides()[0], in->data(), in->dtype(), in->strides()[0],
+                             weight->data(), weight->dtype(), M, d, eps);
     }
 
     llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
 
     switch (out->deviceType()) {
     case LLAISYS_DEVICE_CPU:
-        return cpu::rms_norm(out->data(), in->data(), weight->data(), out->dtype(), M, d, eps);
+        return cpu::rms_norm(out->data(), out->dtype(), out->strides()[0], in->data(), in->dtype(), in->strides()[0],
+                             weight->data(), weight->dtype(), M, d, eps);
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
         TO_BE_IMPLEMENTED();
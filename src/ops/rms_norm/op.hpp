@@ -3,5 +3,5 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void rms_norm(tensor_t out, tensor_t in, tensor_t weight, float eps);
+void rms_norm(const tensor_t &out, const tensor_t &in, const tensor_t &weight, float eps);
 }
@@ -1,102 +1,160 @@
+// simd.hpp pulls in immintrin.h, which must come before llaisys.h.
+#include "../../../utils/simd.hpp"
+
 #include "rope_cpu.hpp"
 
 #include "../../../utils.hpp"
 
 #include <cmath>
+#include <vector>
 
-template <typename T>
-void rope_(T *out, const T *in, const int64_t *pos_ids, size_t L, size_t H, size_t D, float theta) {
+// 频率/角度仍用 double 计算（避免 pow 与 pos * inv_freq 的精度损失），
+// 只在写入 cos/sin 表时转成 float。
+static void rope_angles_(float *cos_out, float *sin_out, int64_t pos, size_t D, float theta) {
     size_t half_D = D / 2;
+    for (size_t j = 0; j < half_D; ++j) {
+        double freq_exponent = (2.0 * static_cast<double>(j)) / static_cast<double>(D);
+        double inv_freq = 1.0 / std::pow(static_cast<double>(theta), freq_exponent);
+        double angle = static_cast<double>(pos) * inv_freq;
+        cos_out[j] = static_cast<float>(std::cos(angle));
+        sin_out[j] = static_cast<float>(std::sin(angle));
+    }
+}
 
-    // Iterate over Sequence Length
-    for (size_t i = 0; i < L; ++i) {
-        for (size_t h = 0; h < H; ++h) {
-            
-            int64_t pos = pos_ids[i];
-            
-            // Base offset for this token and this head
-            size_t base_offset = (i * H * D) + (h * D);
-
-            // Iterate over half the dimension
-            for (size_t j = 0; j < half_D; ++j) {
-                // ====================================================
-                // 【关键修改】：使用 double 进行中间频率和角度计算
-                // ====================================================
-                
-                // 计算 exponent: 2j / d
-                double freq_exponent = (2.0 * static_cast<double>(j)) / static_cast<double>(D);
-                
-                // 计算 inv_freq: theta ^ (-2j/d)
-                // 使用 double 避免 pow 的精度损失
-                double inv_freq = 1.0 / std::pow(static_cast<double>(theta), freq_exponent);
-                
-                // 计算角度: pos * inv_freq
-                // pos 是 int64，直接乘 float 会损失精度，必须乘 double
-                double angle = static_cast<double>(pos) * inv_freq;
-
-                // 使用 double精度的 cos/sin
-                double cos_val = std::cos(angle);
-                double sin_val = std::sin(angle);
-
-                // ====================================================
-
-                // Indices for the pair [a, b]
-                size_t idx_a = base_offset + j;
-                size_t idx_b = base_offset + j + half_D;
+#ifdef LLAISYS_X86_SIMD
+// The 8-wide part of rotate_; returns how many frequencies it did
+LLAISYS_AVX2_FMA static size_t rotate_avx2_(float *out_a, float *out_b, const float *a, const float *b,
+                                            const float *c, const float *s, size_t n) {
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256 va = _mm256_loadu_ps(a + j);
+        __m256 vb = _mm256_loadu_ps(b + j);
+        __m256 vc = _mm256_loadu_ps(c + j);
+        __m256 vs = _mm256_loadu_ps(s + j);
+        _mm256_storeu_ps(out_a + j, _mm256_fmsub_ps(va, vc, _mm256_mul_ps(vb, vs)));
+        _mm256_storeu_ps(out_b + j, _mm256_fmadd_ps(vb, vc, _mm256_mul_ps(va, vs)));
+    }
+    return j;
+}
+#endif
 
-                // Load values (Cast input to float for calculation)
-                float val_a = 0.f;
-                float val_b = 0.f;
+// out_a = a * cos - b * sin, out_b = b * cos + a * sin over n frequencies.
+// Each chunk is loaded before it is stored, so out may alias the input.
+static inline void rotate_(float *out_a, float *out_b, const float *a, const float *b,
+                           const float *c, const float *s, size_t n) {
+    size_t j = 0;
+#ifdef LLAISYS_X86_SIMD
+    if (llaisys::utils::has_avx2_fma()) {
+        j = rotate_avx2_(out_a, out_b, a, b, c, s, n);
+    }
+#endif
+    for (; j < n; ++j) {
+        float x = a[j];
+        float y = b[j];
+        out_a[j] = x * c[j] - y * s[j];
+        out_b[j] = y * c[j] + x * s[j];
+    }
+}
 
-                if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                    val_a = llaisys::utils::cast<float>(in[idx_a]);
-                    val_b = llaisys::utils::cast<float>(in[idx_b]);
-                } else {
-                    val_a = static_cast<float>(in[idx_a]);
-                    val_b = static_cast<float>(in[idx_b]);
-                }
+// Rotates every head of one token with the given cos/sin row.
+template <typename T>
+void rope_token_(T *out, const T *in, size_t H, size_t D, ptrdiff_t out_sh, ptrdiff_t in_sh,
+                 const float *c, const float *s, float *buf) {
+    size_t half_D = D / 2;
+    for (size_t h = 0; h < H; ++h) {
+        const T *x = in + h * in_sh;
+        T *y = out + h * out_sh;
+        if constexpr (std::is_same_v<T, float>) {
+            rotate_(y, y + half_D, x, x + half_D, c, s, half_D);
+        } else {
+            // 半精度先整行转 float，旋转后再写回
+            llaisys::utils::to_f32(buf, x, D);
+            rotate_(buf, buf + half_D, buf, buf + half_D, c, s, half_D);
+            llaisys::utils::from_f32(y, buf, D);
+        }
+    }
+}
 
-                // Apply rotation
-                // 计算时使用 double 的 cos/sin 结果，但在乘法前可以转回 float，
-                // 或者全程 double 计算后再转回 T。
-                // 为了最高精度对齐，建议运算也用 double，最后再转 T
-                double res_a = static_cast<double>(val_a) * cos_val - static_cast<double>(val_b) * sin_val;
-                double res_b = static_cast<double>(val_b) * cos_val + static_cast<double>(val_a) * sin_val;
+template <typename T>
+void rope_(T *out, const T *in, const int64_t *pos_ids, size_t L, size_t H, size_t D,
+           ptrdiff_t out_sl, ptrdiff_t out_sh, ptrdiff_t in_sl, ptrdiff_t in_sh, float theta) {
+    size_t half_D = D / 2;
+    // 同一 token 的所有 head 共用一组角度，每个 token 只算一次
+    std::vector<float> cos_row(half_D), sin_row(half_D), buf(D);
+    for (size_t i = 0; i < L; ++i) {
+        rope_angles_(cos_row.data(), sin_row.data(), pos_ids[i], D, theta);
+        rope_token_(out + i * out_sl, in + i * in_sl, H, D, out_sh, in_sh,
+                    cos_row.data(), sin_row.data(), buf.data());
+    }
+}
 
-                // Store values
-                if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                    out[idx_a] = llaisys::utils::cast<T>(static_cast<float>(res_a));
-                    out[idx_b] = llaisys::utils::cast<T>(static_cast<float>(res_b));
-                } else {
-                    out[idx_a] = static_cast<T>(res_a);
-                    out[idx_b] = static_cast<T>(res_b);
-                }
-            }
-        }
+template <typename T>
+void rope_cached_(T *out, const T *in, const int64_t *pos_ids, size_t L, size_t H, size_t D,
+                  ptrdiff_t out_sl, ptrdiff_t out_sh, ptrdiff_t in_sl, ptrdiff_t in_sh,
+                  const float *cos_table, const float *sin_table) {
+    size_t half_D = D / 2;
+    std::vector<float> buf(D);
+    for (size_t i = 0; i < L; ++i) {
+        size_t row = static_cast<size_t>(pos_ids[i]) * half_D;
+        rope_token_(out + i * out_sl, in + i * in_sl, H, D, out_sh, in_sh,
+                    cos_table + row, sin_table + row, buf.data());
     }
 }
 
 namespace llaisys::ops::cpu {
 void rope(std::byte *out, const std::byte *in, const int64_t *pos_ids, 
-          llaisysDataType_t type, size_t L, size_t H, size_t D, float theta) {
+          llaisysDataType_t type, size_t L, size_t H, size_t D,
+          ptrdiff_t out_sl, ptrdiff_t out_sh, ptrdiff_t in_sl, ptrdiff_t in_sh, float theta) {
     switch (type) {
     case LLAISYS_DTYPE_F32:
         return rope_(
             reinterpret_cast<float *>(out), 
             reinterpret_cast<const float *>(in), 
-            pos_ids, L, H, D, theta);
+            pos_ids, L, H, D, out_sl, out_sh, in_sl, in_sh, theta);
     case LLAISYS_DTYPE_BF16:
         return rope_(
             reinterpret_cast<llaisys::bf16_t *>(out), 
             reinterpret_cast<const llaisys::bf16_t *>(in), 
-            pos_ids, L, H, D, theta);
+            pos_ids, L, H, D, out_sl, out_sh, in_sl, in_sh, theta);
     case LLAISYS_DTYPE_F16:
         return rope_(
             reinterpret_cast<llaisys::fp16_t *>(out), 
             reinterpret_cast<const llaisys::fp16_t *>(in), 
-            pos_ids, L, H, D, theta);
+            pos_ids, L, H, D, out_sl, out_sh, in_sl, in_sh, theta);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+    }
+}
+
+void rope(std::byte *out, const std::byte *in, const int64_t *pos_ids,
+          llaisysDataType_t type, size_t L, size_t H, size_t D,
+          ptrdiff_t out_sl, ptrdiff_t out_sh, ptrdiff_t in_sl, ptrdiff_t in_sh,
+          const float *cos_table, const float *sin_table) {
+    switch (type) {
+    case LLAISYS_DTYPE_F32:
+        return rope_cached_(
+            reinterpret_cast<float *>(out),
+            reinterpret_cast<const float *>(in),
+            pos_ids, L, H, D, out_sl, out_sh, in_sl, in_sh, cos_table, sin_table);
+    case LLAISYS_DTYPE_BF16:
+        return rope_cached_(
+            reinterpret_cast<llaisys::bf16_t *>(out),
+            reinterpret_cast<const llaisys::bf16_t *>(in),
+            pos_ids, L, H, D, out_sl, out_sh, in_sl, in_sh, cos_table, sin_table);
+    case LLAISYS_DTYPE_F16:
+        return rope_cached_(
+            reinterpret_cast<llaisys::fp16_t *>(out),
+            reinterpret_cast<const llaisys::fp16_t *>(in),
+            pos_ids, L, H, D, out_sl, out_sh, in_sl, in_sh, cos_table, sin_table);
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
 }
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+
+void rope_table(float *cos_table, float *sin_table, size_t npos, size_t D, float theta) {
+    size_t half_D = D / 2;
+    for (size_t p = 0; p < npos; ++p) {
+        rope_angles_(cos_table + p * half_D, sin_table + p * half_D, static_cast<int64_t>(p), D, theta);
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -14,8 +14,35 @@ namespace llaisys::ops::cpu {
  * @param L Sequence length (dim 0)
  * @param H Number of heads (dim 1)
  * @param D Head dimension (dim 2)
+ * @param out_sl Output stride of dim 0, in elements
+ * @param out_sh Output stride of dim 1, in elements
+ * @param in_sl Input stride of dim 0, in elements
+ * @param in_sh Input stride of dim 1, in elements
  * @param theta Base frequency
  */
 void rope(std::byte *out, const std::byte *in, const int64_t *pos_ids, 
-          llaisysDataType_t type, size_t L, size_t H, size_t D, float theta);
+          llaisysDataType_t type, size_t L, size_t H, size_t D,
+          ptrdiff_t out_sl, ptrdiff_t out_sh, ptrdiff_t in_sl, ptrdiff_t in_sh, float theta);
+
+/**
+ * @brief CPU implementation for RoPE with precomputed angles
+ * @param cos_table cos values, [npos, D / 2] float, indexed by position
+ * @param sin_table sin values, [npos, D / 2] float, indexed by position
+ *
+ * Other parameters are the same as above.
+ */
+void rope(std::byte *out, const std::byte *in, const int64_t *pos_ids,
+          llaisysDataType_t type, size_t L, size_t H, size_t D,
+          ptrdiff_t out_sl, ptrdiff_t out_sh, ptrdiff_t in_sl, ptrdiff_t in_sh,
+          const float *cos_table, const float *sin_table);
+
+/**
+ * @brief Fills RoPE cos/sin tables for positions [0, npos)
+ * @param cos_table Output cos values, [npos, D / 2] float
+ * @param sin_table Output sin values, [npos, D / 2] float
+ * @param npos Number of positions
+ * @param D Head dimension
+ * @param theta Base frequency
+ */
+void rope_table(float *cos_table, float *sin_table, size_t npos, size_t D, float theta);
 }
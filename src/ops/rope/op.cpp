@@ -2,22 +2,19 @@
 
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/rope_cpu.hpp"
 
 namespace llaisys::ops {
-void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
+void rope(const tensor_t &out, const tensor_t &in, const tensor_t &pos_ids, float theta) {
     // 1. Check Device Consistency
     CHECK_SAME_DEVICE(out, in, pos_ids);
 
-    // 2. Check Contiguity
-    ASSERT(out->isContiguous() && in->isContiguous() && pos_ids->isContiguous(), 
-           "RoPE: inputs/output/pos_ids must be contiguous.");
-
-    // 3. Check Dtype
+    // 2. Check Dtype
     CHECK_SAME_DTYPE(out->dtype(), in->dtype());
 
-    // 4. Check Shapes
+    // 3. Check Shapes
     // Input/Output: [SeqLen, Heads, Dim]
     ASSERT(in->ndim() == 3, "RoPE: Input must be 3D [seqlen, nhead, d]");
     ASSERT(out->ndim() == 3, "RoPE: Output must be 3D [seqlen, nhead, d]");
@@ -31,14 +28,23 @@ void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
     ASSERT(pos_ids->shape()[0] == L, "RoPE: pos_ids length must match sequence length.");
     ASSERT(D % 2 == 0, "RoPE: Head dimension must be even.");
 
+    // 4. Check Contiguity
+    // Only the head dim has to be dense; seq/head strides are free so RoPE can
+    // write straight into a strided KV cache slot.
+    ASSERT(out->strides()[2] == 1 && in->strides()[2] == 1 && pos_ids->isContiguous(),
+           "RoPE: head dim of inputs/output and pos_ids must be contiguous.");
+
     // 5. Dispatch
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        ASSERT(!Graph::capturing(), "RoPE: has no graph-captured form.");
         return cpu::rope(
             out->data(), 
             in->data(), 
             reinterpret_cast<const int64_t*>(pos_ids->data()), 
             out->dtype(), 
             L, H, D, 
+            out->strides()[0], out->strides()[1],
+            in->strides()[0], in->strides()[1],
             theta
         );
     }
@@ -47,7 +53,103 @@ void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
 
     switch (out->deviceType()) {
     case LLAISYS_DEVICE_CPU:
-        return cpu::rope(out->data(), in->data(), reinterpret_cast<const int64_t*>(pos_ids->data()), out->dtype(), L, H, D, theta);
+        return cpu::rope(out->data(), in->data(), reinterpret_cast<const int64_t*>(pos_ids->data()), out->dtype(), L, H, D,
+                         out->strides()[0], out->strides()[1], in->strides()[0], in->strides()[1], theta);
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+
+void rope(const tensor_t &out, const tensor_t &in, const tensor_t &pos_ids, const tensor_t &cos_table, const tensor_t &sin_table) {
+    // 1. Check Device Consistency
+    CHECK_SAME_DEVICE(out, in, pos_ids, cos_table, sin_table);
+
+    // 2. Check Dtype
+    CHECK_SAME_DTYPE(out->dtype(), in->dtype());
+    ASSERT(cos_table->dtype() == LLAISYS_DTYPE_F32 && sin_table->dtype() == LLAISYS_DTYPE_F32,
+           "RoPE: cos/sin tables must be F32.");
+
+    // 3. Check Shapes
+    ASSERT(in->ndim() == 3, "RoPE: Input must be 3D [seqlen, nhead, d]");
+    ASSERT(out->ndim() == 3, "RoPE: Output must be 3D [seqlen, nhead, d]");
+    ASSERT(pos_ids->ndim() == 1, "RoPE: pos_ids must be 1D [seqlen]");
+
+    size_t L = in->shape()[0];
+    size_t H = in->shape()[1];
+    size_t D = in->shape()[2];
+
+    CHECK_SAME_SHAPE(out->shape(), in->shape());
+    CHECK_SAME_SHAPE(cos_table->shape(), sin_table->shape());
+    ASSERT(pos_ids->shape()[0] == L, "RoPE: pos_ids length must match sequence length.");
+    ASSERT(D % 2 == 0, "RoPE: Head dimension must be even.");
+    ASSERT(cos_table->ndim() == 2 && cos_table->shape()[1] == D / 2, "RoPE: tables must be [npos, d / 2].");
+
+    // 4. Check Contiguity
+    ASSERT(out->strides()[2] == 1 && in->strides()[2] == 1 && pos_ids->isContiguous(),
+           "RoPE: head dim of inputs/output and pos_ids must be contiguous.");
+    ASSERT(cos_table->isContiguous() && sin_table->isContiguous(), "RoPE: tables must be contiguous.");
+
+    // 5. Dispatch
+    if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        const int64_t *pos = reinterpret_cast<const int64_t *>(pos_ids->data());
+        for (size_t i = 0; i < L; ++i) {
+            ASSERT(pos[i] >= 0 && static_cast<size_t>(pos[i]) < cos_table->shape()[0],
+                   "RoPE: position is outside the cos/sin tables.");
+        }
+        // A replay reads new positions from pos_ids; the caller keeps them inside the tables.
+        if (auto *graph = Graph::capturing()) {
+            auto o = graph->data(out), x = graph->data(in);
+            auto type = out->dtype();
+            ptrdiff_t o_s0 = out->strides()[0], o_s1 = out->strides()[1];
+            ptrdiff_t i_s0 = in->strides()[0], i_s1 = in->strides()[1];
+            auto cos = reinterpret_cast<const float *>(cos_table->data());
+            auto sin = reinterpret_cast<const float *>(sin_table->data());
+            graph->record([=](ptrdiff_t p) {
+                cpu::rope(o.at(p), x.at(p), pos, type, L, H, D, o_s0, o_s1, i_s0, i_s1, cos, sin);
+            }, {in, pos_ids, cos_table, sin_table}, {out});
+        }
+        return cpu::rope(out->data(), in->data(), pos, out->dtype(), L, H, D,
+                         out->strides()[0], out->strides()[1], in->strides()[0], in->strides()[1],
+                         reinterpret_cast<const float *>(cos_table->data()),
+                         reinterpret_cast<const float *>(sin_table->data()));
+    }
+
+    llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
+
+    switch (out->deviceType()) {
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+
+void rope_table(const tensor_t &cos_table, const tensor_t &sin_table, float theta) {
+    CHECK_SAME_DEVICE(cos_table, sin_table);
+    ASSERT(cos_table->dtype() == LLAISYS_DTYPE_F32 && sin_table->dtype() == LLAISYS_DTYPE_F32,
+           "RoPE: cos/sin tables must be F32.");
+    ASSERT(cos_table->ndim() == 2, "RoPE: tables must be [npos, d / 2].");
+    CHECK_SAME_SHAPE(cos_table->shape(), sin_table->shape());
+    ASSERT(cos_table->isContiguous() && sin_table->isContiguous(), "RoPE: tables must be contiguous.");
+
+    if (cos_table->deviceType() == LLAISYS_DEVICE_CPU) {
+        ASSERT(!Graph::capturing(), "RoPE: has no graph-captured form.");
+        return cpu::rope_table(reinterpret_cast<float *>(cos_table->data()),
+                               reinterpret_cast<float *>(sin_table->data()),
+                               cos_table->shape()[0], cos_table->shape()[1] * 2, theta);
+    }
+
+    llaisys::core::context().setDevice(cos_table->deviceType(), cos_table->deviceId());
+
+    switch (cos_table->deviceType()) {
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
         TO_BE_IMPLEMENTED();
@@ -57,4 +159,4 @@ void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
         EXCEPTION_UNSUPPORTED_DEVICE;
     }
 }
-} // namespace llaisys::ops
\ No newline at end of file
+} // namespace llaisys::ops
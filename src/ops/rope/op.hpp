@@ -3,5 +3,9 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta);
+void rope(const tensor_t &out, const tensor_t &in, const tensor_t &pos_ids, float theta);
+// RoPE with precomputed F32 cos/sin tables of shape [npos, d / 2] (see rope_table).
+void rope(const tensor_t &out, const tensor_t &in, const tensor_t &pos_ids, const tensor_t &cos_table, const tensor_t &sin_table);
+// Fills cos_table/sin_table ([npos, d / 2], F32) with the angles for positions [0, npos).
+void rope_table(const tensor_t &cos_table, const tensor_t &sin_table, float theta);
 }
@@ -13,6 +13,8 @@ void self_attention_(T *out, const T *q, const T *k, const T *v,
                      size_t seqlen, size_t total_len,
                      size_t nhead, size_t nkvhead,
                      size_t d, size_t dv,
+                     ptrdiff_t k_st, ptrdiff_t k_sh,
+                     ptrdiff_t v_st, ptrdiff_t v_sh,
                      float scale) {
     
     // Group size for GQA
@@ -43,7 +45,7 @@ void self_attention_(T *out, const T *q, const T *k, const T *v,
                     continue;
                 }
 
-                const T* k_vec = k + (t * nkvhead * d) + (kv_h * d);
+                const T* k_vec = k + (t * k_st) + (kv_h * k_sh);
                 
                 float score = 0.0f;
                 for (size_t j = 0; j < d; ++j) {
@@ -92,7 +94,7 @@ void self_attention_(T *out, const T *q, const T *k, const T *v,
 
                 float prob = logits[t] * inv_sum;
                 
-                const T* v_vec = v + (t * nkvhead * dv) + (kv_h * dv);
+                const T* v_vec = v + (t * v_st) + (kv_h * v_sh);
 
                 for (size_t j = 0; j < dv; ++j) {
                     float v_val = 0.f;
@@ -127,23 +129,25 @@ void self_attention(std::byte *out, const std::byte *q, const std::byte *k, cons
                     size_t seqlen, size_t total_len, 
                     size_t nhead, size_t nkvhead, 
                     size_t d, size_t dv, 
+                    ptrdiff_t k_st, ptrdiff_t k_sh,
+                    ptrdiff_t v_st, ptrdiff_t v_sh,
                     float scale) {
     switch (type) {
     case LLAISYS_DTYPE_F32:
         return self_attention_(
             reinterpret_cast<float *>(out), reinterpret_cast<const float *>(q),
             reinterpret_cast<const float *>(k), reinterpret_cast<const float *>(v),
-            seqlen, total_len, nhead, nkvhead, d, dv, scale);
+            seqlen, total_len, nhead, nkvhead, d, dv, k_st, k_sh, v_st, v_sh, scale);
     case LLAISYS_DTYPE_BF16:
         return self_attention_(
             reinterpret_cast<llaisys::bf16_t *>(out), reinterpret_cast<const llaisys::bf16_t *>(q),
             reinterpret_cast<const llaisys::bf16_t *>(k), reinterpret_cast<const llaisys::bf16_t *>(v),
-            seqlen, total_len, nhead, nkvhead, d, dv, scale);
+            seqlen, total_len, nhead, nkvhead, d, dv, k_st, k_sh, v_st, v_sh, scale);
     case LLAISYS_DTYPE_F16:
         return self_attention_(
             reinterpret_cast<llaisys::fp16_t *>(out), reinterpret_cast<const llaisys::fp16_t *>(q),
             reinterpret_cast<const llaisys::fp16_t *>(k), reinterpret_cast<const llaisys::fp16_t *>(v),
-            seqlen, total_len, nhead, nkvhead, d, dv, scale);
+            seqlen, total_len, nhead, nkvhead, d, dv, k_st, k_sh, v_st, v_sh, scale);
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
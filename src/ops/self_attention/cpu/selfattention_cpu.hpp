@@ -5,11 +5,22 @@
 
 namespace llaisys::ops::cpu {
 
+/**
+ * @brief CPU implementation for causal self-attention
+ * @param out Output pointer [seqlen, nhead, dv], contiguous
+ * @param q Query pointer [seqlen, nhead, d], contiguous
+ * @param k Key pointer [total_len, nkvhead, d]
+ * @param v Value pointer [total_len, nkvhead, dv]
+ * @param k_st, k_sh Key strides of the token and head dims, in elements
+ * @param v_st, v_sh Value strides of the token and head dims, in elements
+ */
 void self_attention(std::byte *out, const std::byte *q, const std::byte *k, const std::byte *v,
                     llaisysDataType_t type, 
                     size_t seqlen, size_t total_len, 
                     size_t nhead, size_t nkvhead, 
                     size_t d, size_t dv, 
+                    ptrdiff_t k_st, ptrdiff_t k_sh,
+                    ptrdiff_t v_st, ptrdiff_t v_sh,
                     float scale);
 
 } // namespace llaisys::ops::cpu
\ No newline at end of file
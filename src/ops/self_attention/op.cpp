@@ -2,24 +2,21 @@
 
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/selfattention_cpu.hpp"
 
 namespace llaisys::ops {
-void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale) {
+void self_attention(const tensor_t &attn_val, const tensor_t &q, const tensor_t &k, const tensor_t &v, float scale) {
     // 1. Check Device Consistency
     CHECK_SAME_DEVICE(attn_val, q, k);
     CHECK_SAME_DEVICE(attn_val, v);
 
-    // 2. Check Contiguity
-    ASSERT(attn_val->isContiguous() && q->isContiguous() && k->isContiguous() && v->isContiguous(),
-           "SelfAttention: all inputs must be contiguous.");
-
-    // 3. Check Dtype
+    // 2. Check Dtype
     CHECK_SAME_DTYPE(attn_val->dtype(), q->dtype(), k->dtype());
     CHECK_SAME_DTYPE(attn_val->dtype(), v->dtype());
 
-    // 4. Check Shapes
+    // 3. Check Shapes
     // q: [seqlen, nhead, d]
     // k: [total_len, nkvhead, d]
     // v: [total_len, nkvhead, dv]
@@ -51,8 +48,25 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
     ASSERT(attn_val->shape()[1] == nhead, "SelfAttention: Out head num mismatch.");
     ASSERT(attn_val->shape()[2] == dv, "SelfAttention: Out head dim mismatch.");
 
+    // 4. Check Contiguity
+    // K/V may be any strided view with a dense head dim (e.g. a head-major KV cache).
+    ASSERT(attn_val->isContiguous() && q->isContiguous(),
+           "SelfAttention: q and output must be contiguous.");
+    ASSERT(k->strides()[2] == 1 && v->strides()[2] == 1,
+           "SelfAttention: head dim of k/v must be contiguous.");
+
     // 5. Dispatch
     if (attn_val->deviceType() == LLAISYS_DEVICE_CPU) {
+        if (auto *graph = Graph::capturing()) {
+            auto o = graph->data(attn_val), qp = graph->data(q), kp = graph->data(k), vp = graph->data(v);
+            auto len = graph->dim0(k);
+            auto type = attn_val->dtype();
+            ptrdiff_t k_st = k->strides()[0], k_sh = k->strides()[1], v_st = v->strides()[0], v_sh = v->strides()[1];
+            graph->record([=](ptrdiff_t p) {
+                cpu::self_attention(o.at(p), qp.at(p), kp.at(p), vp.at(p), type, seqlen, len.at(p), nhead, nkvhead,
+                                    d, dv, k_st, k_sh, v_st, v_sh, scale);
+            }, {q, k, v}, {attn_val});
+        }
         return cpu::self_attention(
             attn_val->data(),
             q->data(),
@@ -60,6 +74,8 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
             v->data(),
             attn_val->dtype(),
             seqlen, total_len, nhead, nkvhead, d, dv,
+            k->strides()[0], k->strides()[1],
+            v->strides()[0], v->strides()[1],
             scale
         );
     }
@@ -70,7 +86,8 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
     case LLAISYS_DEVICE_CPU:
          return cpu::self_attention(
             attn_val->data(), q->data(), k->data(), v->data(),
-            attn_val->dtype(), seqlen, total_len, nhead, nkvhead, d, dv, scale);
+            attn_val->dtype(), seqlen, total_len, nhead, nkvhead, d, dv,
+            k->strides()[0], k->strides()[1], v->strides()[0], v->strides()[1], scale);
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
         TO_BE_IMPLEMENTED();
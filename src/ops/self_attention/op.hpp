@@ -3,5 +3,5 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale);
+void self_attention(const tensor_t &attn_val, const tensor_t &q, const tensor_t &k, const tensor_t &v, float scale);
 }
@@ -1,39 +1,104 @@
+// fast_exp.hpp pulls in immintrin.h, which must come before llaisys.h.
+#include "../../../utils/fast_exp.hpp"
+
 #include "swiglu_cpu.hpp"
 
+#include "../../../core/thread_pool/thread_pool.hpp"
 #include "../../../utils.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <type_traits>
 
-template <typename T>
-void swiglu_(T *out, const T *gate, const T *up, size_t numel) {
-    // Parallelize loop
-    // #pragma omp parallel for
-    for (size_t i = 0; i < numel; ++i) {
-        float val_gate = 0.0f;
-        float val_up = 0.0f;
+#ifdef LLAISYS_X86_SIMD
+// The 8-wide part of swiglu_f32_; returns how many elements it did
+LLAISYS_AVX2_FMA static size_t swiglu_f32_avx2_(float *out, const float *gate, const float *up, size_t n) {
+    size_t i = 0;
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 g = _mm256_loadu_ps(gate + i);
+        __m256 u = _mm256_loadu_ps(up + i);
+        __m256 e = llaisys::utils::fast_exp(_mm256_xor_ps(g, sign));
+        _mm256_storeu_ps(out + i, _mm256_div_ps(_mm256_mul_ps(u, g), _mm256_add_ps(one, e)));
+    }
+    return i;
+}
+#endif
 
-        // Load and convert to float
-        if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-            val_gate = llaisys::utils::cast<float>(gate[i]);
-            val_up = llaisys::utils::cast<float>(up[i]);
-        } else {
-            val_gate = static_cast<float>(gate[i]);
-            val_up = static_cast<float>(up[i]);
-        }
+// out[i] = up[i] * gate[i] / (1 + exp(-gate[i])). out may alias gate or up.
+static inline void swiglu_f32_(float *out, const float *gate, const float *up, size_t n) {
+    size_t i = 0;
+#ifdef LLAISYS_X86_SIMD
+    if (llaisys::utils::has_avx2_fma()) {
+        i = swiglu_f32_avx2_(out, gate, up, n);
+    }
+#endif
+    for (; i < n; ++i) {
+        float g = gate[i];
+        out[i] = up[i] * g / (1.0f + llaisys::utils::fast_exp(-g));
+    }
+}
 
-        // Calculate SiLU(gate) = gate / (1 + exp(-gate))
-        float silu = val_gate / (1.0f + std::exp(-val_gate));
+// 按块处理：块内先把半精度转成 float 再做向量计算，块之间并行
+static constexpr size_t SWIGLU_BLOCK = 1024;
+static constexpr size_t SWIGLU_PARALLEL_MIN = 1 << 15;
 
-        // Calculate result = up * SiLU(gate)
-        float res = val_up * silu;
+template <typename T>
+void swiglu_(T *out, const T *gate, const T *up, size_t numel) {
+    ptrdiff_t nblock = static_cast<ptrdiff_t>((numel + SWIGLU_BLOCK - 1) / SWIGLU_BLOCK);
+    auto run = [&](ptrdiff_t from, ptrdiff_t to) {
+        for (ptrdiff_t b = from; b < to; ++b) {
+            size_t begin = b * SWIGLU_BLOCK;
+            size_t n = std::min(SWIGLU_BLOCK, numel - begin);
+            if constexpr (std::is_same_v<T, float>) {
+                swiglu_f32_(out + begin, gate + begin, up + begin, n);
+            } else {
+                float g[SWIGLU_BLOCK], u[SWIGLU_BLOCK];
+                llaisys::utils::to_f32(g, gate + begin, n);
+                llaisys::utils::to_f32(u, up + begin, n);
+                swiglu_f32_(g, g, u, n);
+                llaisys::utils::from_f32(out + begin, g, n);
+            }
+        }
+    };
+    if (numel >= SWIGLU_PARALLEL_MIN) {
+        llaisys::core::parallel_for(nblock, run);
+    } else {
+        run(0, nblock);
+    }
+}
 
-        // Store result
-        if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-            out[i] = llaisys::utils::cast<T>(res);
-        } else {
-            out[i] = static_cast<T>(res);
+// 任意 stride：按合并后的最内层段处理，段内连续时直接复用上面的块实现
+template <typename T>
+void swiglu_strided_(T *out, const T *gate, const T *up, const llaisys::utils::StridedRuns<3> &runs) {
+    const ptrdiff_t nrun = static_cast<ptrdiff_t>(runs.count());
+    const bool unit = runs.unit_inner();
+    const auto &s = runs.inner_strides;
+    auto run = [&](ptrdiff_t from, ptrdiff_t to) {
+        for (ptrdiff_t r = from; r < to; ++r) {
+            auto off = runs.offsets(r);
+            for (size_t begin = 0; begin < runs.inner; begin += SWIGLU_BLOCK) {
+                size_t n = std::min(SWIGLU_BLOCK, runs.inner - begin);
+                if constexpr (std::is_same_v<T, float>) {
+                    if (unit) {
+                        swiglu_f32_(out + off[0] + begin, gate + off[1] + begin, up + off[2] + begin, n);
+                        continue;
+                    }
+                }
+                float g[SWIGLU_BLOCK], u[SWIGLU_BLOCK];
+                llaisys::utils::to_f32(g, gate + off[1] + begin * s[1], n, s[1]);
+                llaisys::utils::to_f32(u, up + off[2] + begin * s[2], n, s[2]);
+                swiglu_f32_(g, g, u, n);
+                llaisys::utils::from_f32(out + off[0] + begin * s[0], g, n, s[0]);
+            }
         }
+    };
+    if (nrun > 1 && nrun * runs.inner >= SWIGLU_PARALLEL_MIN) {
+        llaisys::core::parallel_for(nrun, run);
+    } else {
+        run(0, nrun);
     }
 }
 
@@ -63,4 +128,25 @@ void swiglu(std::byte *out, const std::byte *gate, const std::byte *up,
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
 }
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+
+void swiglu(std::byte *out, const std::byte *gate, const std::byte *up, llaisysDataType_t type,
+            const tensor_shape_t &shape, const tensor_strides_t &out_strides,
+            const tensor_strides_t &gate_strides, const tensor_strides_t &up_strides) {
+    auto runs = llaisys::utils::strided_runs<3>(shape, {&out_strides, &gate_strides, &up_strides});
+    switch (type) {
+    case LLAISYS_DTYPE_F32:
+        return swiglu_strided_(reinterpret_cast<float *>(out), reinterpret_cast<const float *>(gate),
+                               reinterpret_cast<const float *>(up), runs);
+    case LLAISYS_DTYPE_BF16:
+        return swiglu_strided_(reinterpret_cast<llaisys::bf16_t *>(out),
+                               reinterpret_cast<const llaisys::bf16_t *>(gate),
+                               reinterpret_cast<const llaisys::bf16_t *>(up), runs);
+    case LLAISYS_DTYPE_F16:
+        return swiglu_strided_(reinterpret_cast<llaisys::fp16_t *>(out),
+                               reinterpret_cast<const llaisys::fp16_t *>(gate),
+                               reinterpret_cast<const llaisys::fp16_t *>(up), runs);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+    }
+}
+} // namespace llaisys::ops::cpu
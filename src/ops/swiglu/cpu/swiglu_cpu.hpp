@@ -1,6 +1,8 @@
 #pragma once
 #include "llaisys.h"
 
+#include "../../../tensor/tensor_meta.hpp"
+
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
@@ -14,4 +16,11 @@ namespace llaisys::ops::cpu {
  */
 void swiglu(std::byte *out, const std::byte *gate, const std::byte *up, 
             llaisysDataType_t type, size_t numel);
+
+/**
+ * @brief CPU implementation for SwiGLU on same-shape tensors with arbitrary strides (in elements)
+ */
+void swiglu(std::byte *out, const std::byte *gate, const std::byte *up, llaisysDataType_t type,
+            const tensor_shape_t &shape, const tensor_strides_t &out_strides,
+            const tensor_strides_t &gate_strides, const tensor_strides_t &up_strides);
 } // namespace llaisys::ops::cpu
\ No newline at end of file
@@ -2,17 +2,19 @@
 
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../graph/graph.hpp"
 
 #include "cpu/swiglu_cpu.hpp"
 
 namespace llaisys::ops {
-void swiglu(tensor_t out, tensor_t gate, tensor_t up) {
+void swiglu(const tensor_t &out, const tensor_t &gate, const tensor_t &up) {
     // 1. Check Device Consistency
     CHECK_SAME_DEVICE(out, gate, up);
 
     // 2. Check Contiguity
-    ASSERT(out->isContiguous() && gate->isContiguous() && up->isContiguous(),
-           "SwiGLU: all tensors must be contiguous.");
+    // Any strides are accepted (e.g. the gate/up halves of a packed projection);
+    // contiguous tensors take the flat fast path.
+    bool contiguous = out->isContiguous() && gate->isContiguous() && up->isContiguous();
 
     // 3. Check Dtype
     CHECK_SAME_DTYPE(out->dtype(), gate->dtype(), up->dtype());
@@ -26,7 +28,25 @@ void swiglu(tensor_t out, tensor_t gate, tensor_t up) {
     size_t numel = out->numel();
 
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::swiglu(out->data(), gate->data(), up->data(), out->dtype(), numel);
+        if (auto *graph = Graph::capturing()) {
+            auto o = graph->data(out), g = graph->data(gate), u = graph->data(up);
+            auto type = out->dtype();
+            if (contiguous) {
+                graph->record([=](ptrdiff_t p) { cpu::swiglu(o.at(p), g.at(p), u.at(p), type, numel); },
+                              {gate, up}, {out});
+            } else {
+                tensor_shape_t shape = out->shape();
+                tensor_strides_t o_st = out->strides(), g_st = gate->strides(), u_st = up->strides();
+                graph->record([=](ptrdiff_t p) {
+                    cpu::swiglu(o.at(p), g.at(p), u.at(p), type, shape, o_st, g_st, u_st);
+                }, {gate, up}, {out});
+            }
+        }
+        if (contiguous) {
+            return cpu::swiglu(out->data(), gate->data(), up->data(), out->dtype(), numel);
+        }
+        return cpu::swiglu(out->data(), gate->data(), up->data(), out->dtype(), out->shape(), out->strides(),
+                           gate->strides(), up->strides());
     }
 
     llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
@@ -36,6 +56,7 @@ void swiglu(tensor_t out, tensor_t gate, tensor_t up) {
         return cpu::swiglu(out->data(), gate->data(), up->data(), out->dtype(), numel);
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
+        ASSERT(contiguous, "SwiGLU: non-contiguous tensors are only supported on CPU.");
         TO_BE_IMPLEMENTED();
         return;
 #endif
@@ -3,5 +3,5 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void swiglu(tensor_t out, tensor_t gate, tensor_t up);
+void swiglu(const tensor_t &out, const tensor_t &gate, const tensor_t &up);
 }
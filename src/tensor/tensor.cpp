@@ -1,6 +1,9 @@
 #include "tensor.hpp"
 
 #include "../utils.hpp"
+#include "../utils/pool_allocator.hpp"
+
+#include "../ops/rearrange/op.hpp"
 
 #include <cstring>
 #include <numeric>
@@ -8,15 +11,22 @@
 
 namespace llaisys {
 
-Tensor::Tensor(TensorMeta meta, core::storage_t storage, size_t offset)
+Tensor::Tensor(Key, TensorMeta meta, core::storage_t storage, size_t offset)
     : _meta(std::move(meta)), _storage(std::move(storage)), _offset(offset) {}
 
-tensor_t Tensor::create(const std::vector<size_t> &shape,
+// Views are made on every op of a forward pass: object and control block come from one
+// pooled block instead of two mallocs.
+tensor_t Tensor::make(TensorMeta meta, core::storage_t storage, size_t offset) {
+    return std::allocate_shared<Tensor>(utils::PoolAllocator<Tensor>(), Key(), std::move(meta), std::move(storage),
+                                        offset);
+}
+
+tensor_t Tensor::create(const tensor_shape_t &shape,
                         llaisysDataType_t dtype,
                         llaisysDeviceType_t device_type,
                         int device) {
     size_t ndim_ = shape.size();
-    std::vector<ptrdiff_t> strides(ndim_);
+    tensor_strides_t strides(ndim_);
     size_t stride = 1;
     for (size_t i = 1; i <= ndim_; i++) {
         strides[ndim_ - i] = stride;
@@ -28,11 +38,11 @@ tensor_t Tensor::create(const std::vector<size_t> &shape,
 
     if (device_type == LLAISYS_DEVICE_CPU && core::context().runtime().deviceType() != LLAISYS_DEVICE_CPU) {
         auto storage = core::context().runtime().allocateHostStorage(total_elems * dtype_size);
-        return std::shared_ptr<Tensor>(new Tensor(meta, storage));
+        return make(meta, storage);
     } else {
         core::context().setDevice(device_type, device);
         auto storage = core::context().runtime().allocateDeviceStorage(total_elems * dtype_size);
-        return std::shared_ptr<Tensor>(new Tensor(meta, storage));
+        return make(meta, storage);
     }
 }
 
@@ -48,11 +58,11 @@ size_t Tensor::ndim() const {
     return _meta.shape.size();
 }
 
-const std::vector<size_t> &Tensor::shape() const {
+const tensor_shape_t &Tensor::shape() const {
     return _meta.shape;
 }
 
-const std::vector<ptrdiff_t> &Tensor::strides() const {
+const tensor_strides_t &Tensor::strides() const {
     return _meta.strides;
 }
 
@@ -94,7 +104,7 @@ std::string Tensor::info() const {
 }
 
 template <typename T>
-void print_data(const T *data, const std::vector<size_t> &shape, const std::vector<ptrdiff_t> &strides, size_t dim) {
+void print_data(const T *data, const tensor_shape_t &shape, const tensor_strides_t &strides, size_t dim) {
     if (dim == shape.size() - 1) {
         for (size_t i = 0; i < shape[dim]; i++) {
             if constexpr (std::is_same_v<T, bf16_t> || std::is_same_v<T, fp16_t>) {
@@ -111,7 +121,7 @@ void print_data(const T *data, const std::vector<size_t> &shape, const std::vect
     }
 }
 
-void debug_print(const std::byte *data, const std::vector<size_t> &shape, const std::vector<ptrdiff_t> &strides, llaisysDataType_t dtype) {
+void debug_print(const std::byte *data, const tensor_shape_t &shape, const tensor_strides_t &strides, llaisysDataType_t dtype) {
     switch (dtype) {
     case LLAISYS_DTYPE_BYTE:
         return print_data(reinterpret_cast<const char *>(data), shape, strides, 0);
@@ -188,7 +198,11 @@ bool Tensor::isContiguous() const {
     return true;
 }
 
-tensor_t Tensor::permute(const std::vector<size_t> &order) const {
+bool Tensor::isReadOnly() const {
+    return _storage->isReadOnly();
+}
+
+tensor_t Tensor::permute(const tensor_shape_t &order) const {
     // TO_BE_IMPLEMENTED();
     if (order.size() != this->ndim()) {
         printf("Permute dimensions must match tensor dimensions");
@@ -208,10 +222,10 @@ tensor_t Tensor::permute(const std::vector<size_t> &order) const {
         new_meta.strides[i] = _meta.strides[old_dim_index];
     }
 
-    return std::shared_ptr<Tensor>(new Tensor(new_meta, _storage, _offset));
+    return make(new_meta, _storage, _offset);
 }
 
-tensor_t Tensor::view(const std::vector<size_t> &shape) const {
+tensor_t Tensor::view(const tensor_shape_t &shape) const {
     // TO_BE_IMPLEMENTED();
     // 1.要求连续
     if (!this->isContiguous()) {
@@ -230,7 +244,7 @@ tensor_t Tensor::view(const std::vector<size_t> &shape) const {
     }
 
     // 3.构造新的 strides 
-    std::vector<ptrdiff_t> new_strides(shape.size());
+    tensor_strides_t new_strides(shape.size());
     ptrdiff_t accumulated_stride = 1;
     
     // 从最后一个维度向前倒推
@@ -245,7 +259,23 @@ tensor_t Tensor::view(const std::vector<size_t> &shape) const {
     new_meta.strides = new_strides;
     new_meta.dtype = _meta.dtype; // 保持数据类型不变
 
-    return std::shared_ptr<Tensor>(new Tensor(new_meta, _storage, _offset));
+    return make(new_meta, _storage, _offset);
+}
+
+tensor_t Tensor::fromStorage(core::storage_t storage, size_t offset, const tensor_shape_t &shape,
+                             llaisysDataType_t dtype) {
+    tensor_strides_t strides(shape.size());
+    size_t numel = 1;
+    for (size_t i = shape.size(); i-- > 0;) {
+        strides[i] = static_cast<ptrdiff_t>(numel);
+        numel *= shape[i];
+    }
+    ASSERT(offset + numel * utils::dsize(dtype) <= storage->size(), "Tensor: region exceeds the storage.");
+    return make(TensorMeta{dtype, shape, strides}, std::move(storage), offset);
+}
+
+tensor_t Tensor::carve(size_t offset, const tensor_shape_t &shape, llaisysDataType_t dtype) const {
+    return fromStorage(_storage, _offset + offset, shape, dtype);
 }
 
 tensor_t Tensor::slice(size_t dim, size_t start, size_t end) const {
@@ -309,11 +339,12 @@ tensor_t Tensor::slice(size_t dim, size_t start, size_t end) const {
     // 加上旧的 offset (支持多次连续切片)
     size_t new_offset = _offset + shift_bytes;
 
-    return std::shared_ptr<Tensor>(new Tensor(new_meta, _storage, new_offset));
+    return make(new_meta, _storage, new_offset);
 }
 
 void Tensor::load(const void *src_) {
     // TO_BE_IMPLEMENTED();
+    ASSERT(!isReadOnly(), "Tensor: cannot load into read-only (file-mapped) storage.");
     if (!this->isContiguous()) {
          // 在实际框架中，这里应该抛出异常或进行处理
          printf("Error: Cannot load into non-contiguous tensor!\n");
@@ -331,19 +362,111 @@ void Tensor::load(const void *src_) {
     }
 }
 
+void Tensor::load(const void *src_, llaisysDataType_t src_dtype) {
+    if (src_dtype == this->dtype()) {
+        return load(src_);
+    }
+    ASSERT(this->isContiguous(), "Tensor: cannot load into a non-contiguous tensor.");
+    ASSERT(!isReadOnly(), "Tensor: cannot load into read-only (file-mapped) storage.");
+
+    if (this->deviceType() == LLAISYS_DEVICE_CPU) {
+        utils::convert(this->data(), this->dtype(), src_, src_dtype, this->numel());
+        return;
+    }
+    // Convert on the host, then copy over
+    std::vector<std::byte> staging(this->numel() * this->elementSize());
+    utils::convert(staging.data(), this->dtype(), src_, src_dtype, this->numel());
+    core::context().setDevice(this->deviceType(), this->deviceId());
+    core::context().runtime().api()->memcpy_sync(this->data(), staging.data(), staging.size(), LLAISYS_MEMCPY_H2D);
+}
+
 tensor_t Tensor::contiguous() const {
-    TO_BE_IMPLEMENTED();
-    return std::shared_ptr<Tensor>(new Tensor(_meta, _storage));
+    // 已经连续时直接返回共享存储的视图，否则用 rearrange 拷贝到新的连续张量
+    if (this->isContiguous()) {
+        return make(_meta, _storage, _offset);
+    }
+    auto out = create(this->shape(), this->dtype(), this->deviceType(), this->deviceId());
+    ops::rearrange(out, make(_meta, _storage, _offset));
+    return out;
 }
 
-tensor_t Tensor::reshape(const std::vector<size_t> &shape) const {
-    TO_BE_IMPLEMENTED();
-    return std::shared_ptr<Tensor>(new Tensor(_meta, _storage));
+// Strides that let `shape` view the same elements as (old_shape, old_strides), or false
+// if some group of merged/split dims is not contiguous in memory.
+static bool view_strides(const tensor_shape_t &old_shape, const tensor_strides_t &old_strides,
+                         const tensor_shape_t &shape, tensor_strides_t &strides) {
+    strides.assign(shape.size(), 0);
+    if (old_shape.empty()) {
+        // 标量：每一维都必须是 1
+        for (size_t i = 0; i < shape.size(); ++i) {
+            strides[i] = 1;
+        }
+        return true;
+    }
+
+    // 从后往前，把旧形状切成若干内存连续的块，每块对应新形状中乘积相同的若干维
+    ptrdiff_t view_d = static_cast<ptrdiff_t>(shape.size()) - 1;
+    ptrdiff_t chunk_base_stride = old_strides.back();
+    size_t tensor_numel = 1;
+    size_t view_numel = 1;
+    for (ptrdiff_t tensor_d = static_cast<ptrdiff_t>(old_shape.size()) - 1; tensor_d >= 0; --tensor_d) {
+        tensor_numel *= old_shape[tensor_d];
+        if (tensor_d == 0
+            || (old_shape[tensor_d - 1] != 1
+                && old_strides[tensor_d - 1] != static_cast<ptrdiff_t>(tensor_numel) * chunk_base_stride)) {
+            while (view_d >= 0 && (view_numel < tensor_numel || shape[view_d] == 1)) {
+                strides[view_d] = static_cast<ptrdiff_t>(view_numel) * chunk_base_stride;
+                view_numel *= shape[view_d];
+                --view_d;
+            }
+            if (view_numel != tensor_numel) {
+                return false;
+            }
+            if (tensor_d > 0) {
+                chunk_base_stride = old_strides[tensor_d - 1];
+                tensor_numel = 1;
+                view_numel = 1;
+            }
+        }
+    }
+    return view_d == -1;
+}
+
+tensor_t Tensor::reshape(const tensor_shape_t &shape) const {
+    size_t new_numel = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    CHECK_ARGUMENT(new_numel == this->numel(), "Tensor::reshape: number of elements must not change.");
+
+    // 能以视图表示时不拷贝（包括切片、置换后仍然分块连续的情况）
+    tensor_strides_t new_strides;
+    if (new_numel > 0 && view_strides(_meta.shape, _meta.strides, shape, new_strides)) {
+        TensorMeta new_meta{_meta.dtype, shape, new_strides};
+        return make(new_meta, _storage, _offset);
+    }
+    return this->contiguous()->view(shape);
 }
 
 tensor_t Tensor::to(llaisysDeviceType_t device_type, int device) const {
-    TO_BE_IMPLEMENTED();
-    return std::shared_ptr<Tensor>(new Tensor(_meta, _storage));
+    if (device < 0) {
+        device = device_type == this->deviceType() ? this->deviceId() : 0;
+    }
+    if (device_type == this->deviceType() && device == this->deviceId()) {
+        return make(_meta, _storage, _offset);
+    }
+
+    // 先在源设备上整理成连续，再整块拷贝
+    auto src = this->contiguous();
+    auto dst = create(this->shape(), this->dtype(), device_type, device);
+    bool src_host = this->deviceType() == LLAISYS_DEVICE_CPU;
+    bool dst_host = device_type == LLAISYS_DEVICE_CPU;
+    llaisysMemcpyKind_t kind = src_host ? (dst_host ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D)
+                                        : (dst_host ? LLAISYS_MEMCPY_D2H : LLAISYS_MEMCPY_D2D);
+    // 由设备一侧的 runtime 执行拷贝
+    if (src_host) {
+        core::context().setDevice(device_type, device);
+    } else {
+        core::context().setDevice(this->deviceType(), this->deviceId());
+    }
+    core::context().runtime().api()->memcpy_sync(dst->data(), src->data(), this->numel() * this->elementSize(), kind);
+    return dst;
 }
 
 } // namespace llaisys
@@ -1,38 +1,43 @@
 #pragma once
 #include "../core/llaisys_core.hpp"
+#include "tensor_meta.hpp"
 
 #include <vector>
 namespace llaisys {
 class Tensor;
 using tensor_t = std::shared_ptr<Tensor>;
 
-struct TensorMeta {
-    llaisysDataType_t dtype;
-    std::vector<size_t> shape;
-    std::vector<ptrdiff_t> strides;
-};
-
 class Tensor {
 private:
     TensorMeta _meta;
     core::storage_t _storage;
     // 用于clice切片，x = x[2:]
     size_t _offset;
-    Tensor(TensorMeta meta, core::storage_t storage, size_t offset = 0);
+
+    // Only Tensor can make one, but std::allocate_shared needs a public constructor.
+    struct Key {
+        explicit Key() = default;
+    };
+    static tensor_t make(TensorMeta meta, core::storage_t storage, size_t offset = 0);
 
 public:
+    Tensor(Key, TensorMeta meta, core::storage_t storage, size_t offset);
+
     static tensor_t create(
-        const std::vector<size_t> &shape,
+        const tensor_shape_t &shape,
         llaisysDataType_t dtype,
         llaisysDeviceType_t device_type = LLAISYS_DEVICE_CPU,
         int device = 0);
+    // A contiguous `shape`/`dtype` tensor over `storage`, starting `offset` bytes in.
+    static tensor_t fromStorage(core::storage_t storage, size_t offset, const tensor_shape_t &shape,
+                                llaisysDataType_t dtype);
     ~Tensor() = default;
     // Info
     std::byte *data();
     const std::byte *data() const;
     size_t ndim() const;
-    const std::vector<size_t> &shape() const;
-    const std::vector<ptrdiff_t> &strides() const;
+    const tensor_shape_t &shape() const;
+    const tensor_strides_t &strides() const;
     llaisysDataType_t dtype() const;
     llaisysDeviceType_t deviceType() const;
     int deviceId() const;
@@ -43,18 +48,25 @@ public:
     void debug() const;
 
     bool isContiguous() const;
+    // Backed by memory that must not be written (e.g. a mapped weight file)
+    bool isReadOnly() const;
 
     // Meta Transform
-    tensor_t permute(const std::vector<size_t> &order) const;
+    tensor_t permute(const tensor_shape_t &order) const;
     tensor_t slice(size_t dim, size_t start, size_t end) const;
-    tensor_t view(const std::vector<size_t> &shape) const;
+    tensor_t view(const tensor_shape_t &shape) const;
+    // A contiguous `shape`/`dtype` tensor over this tensor's storage, starting `offset` bytes
+    // past data(). Used to carve typed buffers out of a byte arena.
+    tensor_t carve(size_t offset, const tensor_shape_t &shape, llaisysDataType_t dtype) const;
 
-    // Load data from host memory
+    // Load data from host memory (not into read-only storage)
     void load(const void *src);
+    // Loads host data stored as src_dtype (F32/F16/BF16), converting it to this tensor's dtype.
+    void load(const void *src, llaisysDataType_t src_dtype);
 
     // Challenging features
     tensor_t contiguous() const;
-    tensor_t reshape(const std::vector<size_t> &shape) const;
+    tensor_t reshape(const tensor_shape_t &shape) const;
     tensor_t to(llaisysDeviceType_t device_type, int device = -1) const;
 };
 
@@ -0,0 +1,20 @@
+#pragma once
+#include "../utils/small_vector.hpp"
+
+#include "llaisys.h"
+
+#include <cstddef>
+
+namespace llaisys {
+// Shapes and strides are kept inline (at most TENSOR_MAX_NDIM dims), so making a view costs
+// no heap allocation beyond the pooled Tensor object itself. CPU kernels take them as is.
+constexpr size_t TENSOR_MAX_NDIM = 8;
+using tensor_shape_t = utils::SmallVector<size_t, TENSOR_MAX_NDIM>;
+using tensor_strides_t = utils::SmallVector<ptrdiff_t, TENSOR_MAX_NDIM>;
+
+struct TensorMeta {
+    llaisysDataType_t dtype;
+    tensor_shape_t shape;
+    tensor_strides_t strides;
+};
+} // namespace llaisys
@@ -1,3 +1,5 @@
 #pragma once
 #include "utils/check.hpp"
+#include "utils/convert.hpp"
+#include "utils/strided.hpp"
 #include "utils/types.hpp"
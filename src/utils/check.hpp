@@ -70,6 +70,17 @@
 #define CHECK_SAME_DTYPE(FIRST, ...) \
     CHECK_SAME(EXCEPTION_DATATYPE_MISMATCH, FIRST, __VA_ARGS__)
 
+// Floating-point tensors may mix F32 / F16 / BF16 where an op supports it.
+#define CHECK_FLOAT_DTYPE(...)                                                 \
+    do {                                                                       \
+        for (const auto &dtype___ : {__VA_ARGS__}) {                           \
+            if (dtype___ != LLAISYS_DTYPE_F32 && dtype___ != LLAISYS_DTYPE_F16 \
+                && dtype___ != LLAISYS_DTYPE_BF16) {                           \
+                EXCEPTION_UNSUPPORTED_DATATYPE(dtype___);                      \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
 #define EXCEPTION_DEVICE_MISMATCH                                                     \
     do {                                                                              \
         std::cerr << "[ERROR] Input tensors must be on the same device!" << std::endl \
@@ -0,0 +1,185 @@
+// immintrin.h must come before llaisys.h: its intrinsics use `__C` as a parameter name.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LLAISYS_CONVERT_X86
+#include <immintrin.h>
+#endif
+
+#include "convert.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace llaisys::utils {
+namespace {
+#ifdef LLAISYS_CONVERT_X86
+// Checked once; the SIMD variants are compiled with target attributes so the
+// library itself does not need -mavx2.
+const bool HAS_AVX2 = __builtin_cpu_supports("avx2");
+const bool HAS_F16C = HAS_AVX2 && __builtin_cpu_supports("f16c");
+const bool HAS_AVX512_BF16 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bf16");
+
+__attribute__((target("avx2"))) void bf16_to_f32_avx2(float *dst, const bf16_t *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m256i w = _mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16);
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(w));
+    }
+    for (; i < n; ++i) {
+        dst[i] = _bf16_to_f32(src[i]);
+    }
+}
+
+__attribute__((target("avx2"))) void f32_to_bf16_avx2(bf16_t *dst, const float *src, size_t n) {
+    const __m256i bias = _mm256_set1_epi32(0x7FFF);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i quiet = _mm256_set1_epi32(0x0040);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(src + i);
+        __m256i bits = _mm256_castps_si256(x);
+        __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), one);
+        __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(bias, lsb)), 16);
+        __m256i nan = _mm256_or_si256(_mm256_srli_epi32(bits, 16), quiet);
+        __m256i isnan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+        __m256i r = _mm256_blendv_epi8(rounded, nan, isnan);
+        // Pack the eight 16-bit results (values fit, so unsigned saturation is a no-op).
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm256_castsi256_si128(packed));
+    }
+    for (; i < n; ++i) {
+        dst[i] = _f32_to_bf16(src[i]);
+    }
+}
+
+__attribute__((target("avx512f,avx512bf16"))) void f32_to_bf16_avx512(bf16_t *dst, const float *src, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256bh r = _mm512_cvtneps_pbh(_mm512_loadu_ps(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), (__m256i)r);
+    }
+    for (; i < n; ++i) {
+        dst[i] = _f32_to_bf16(src[i]);
+    }
+}
+
+__attribute__((target("avx2,f16c"))) void f16_to_f32_f16c(float *dst, const fp16_t *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))));
+    }
+    for (; i < n; ++i) {
+        dst[i] = _f16_to_f32(src[i]);
+    }
+}
+
+__attribute__((target("avx2,f16c"))) void f32_to_f16_f16c(fp16_t *dst, const float *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), h);
+    }
+    for (; i < n; ++i) {
+        dst[i] = _f32_to_f16(src[i]);
+    }
+}
+#endif
+
+template <typename To, typename From>
+void convert_(To *dst, const From *src, size_t n) {
+    if constexpr (std::is_same_v<To, float>) {
+        to_f32(dst, src, n);
+    } else if constexpr (std::is_same_v<From, float>) {
+        from_f32(dst, src, n);
+    } else {
+        // F16 <-> BF16 goes through float in chunks
+        constexpr size_t CHUNK = 256;
+        float buf[CHUNK];
+        for (size_t i = 0; i < n; i += CHUNK) {
+            size_t m = std::min(CHUNK, n - i);
+            to_f32(buf, src + i, m);
+            from_f32(dst + i, buf, m);
+        }
+    }
+}
+
+template <typename To>
+void convert_from_(To *dst, const void *src, llaisysDataType_t src_type, size_t n) {
+    switch (src_type) {
+    case LLAISYS_DTYPE_F32:
+        return convert_(dst, reinterpret_cast<const float *>(src), n);
+    case LLAISYS_DTYPE_F16:
+        return convert_(dst, reinterpret_cast<const fp16_t *>(src), n);
+    case LLAISYS_DTYPE_BF16:
+        return convert_(dst, reinterpret_cast<const bf16_t *>(src), n);
+    default:
+        throw std::invalid_argument("convert: unsupported source type " + std::string(dtype_to_str(src_type)));
+    }
+}
+} // namespace
+
+void bf16_to_f32(float *dst, const bf16_t *src, size_t n) {
+#ifdef LLAISYS_CONVERT_X86
+    if (HAS_AVX2) {
+        return bf16_to_f32_avx2(dst, src, n);
+    }
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = _bf16_to_f32(src[i]);
+    }
+}
+
+void f32_to_bf16(bf16_t *dst, const float *src, size_t n) {
+#ifdef LLAISYS_CONVERT_X86
+    if (HAS_AVX512_BF16) {
+        return f32_to_bf16_avx512(dst, src, n);
+    }
+    if (HAS_AVX2) {
+        return f32_to_bf16_avx2(dst, src, n);
+    }
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = _f32_to_bf16(src[i]);
+    }
+}
+
+void f16_to_f32(float *dst, const fp16_t *src, size_t n) {
+#ifdef LLAISYS_CONVERT_X86
+    if (HAS_F16C) {
+        return f16_to_f32_f16c(dst, src, n);
+    }
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = _f16_to_f32(src[i]);
+    }
+}
+
+void f32_to_f16(fp16_t *dst, const float *src, size_t n) {
+#ifdef LLAISYS_CONVERT_X86
+    if (HAS_F16C) {
+        return f32_to_f16_f16c(dst, src, n);
+    }
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = _f32_to_f16(src[i]);
+    }
+}
+
+void convert(void *dst, llaisysDataType_t dst_type, const void *src, llaisysDataType_t src_type, size_t n) {
+    if (dst_type == src_type) {
+        std::memcpy(dst, src, n * dsize(dst_type));
+        return;
+    }
+    switch (dst_type) {
+    case LLAISYS_DTYPE_F32:
+        return convert_from_(reinterpret_cast<float *>(dst), src, src_type, n);
+    case LLAISYS_DTYPE_F16:
+        return convert_from_(reinterpret_cast<fp16_t *>(dst), src, src_type, n);
+    case LLAISYS_DTYPE_BF16:
+        return convert_from_(reinterpret_cast<bf16_t *>(dst), src, src_type, n);
+    default:
+        throw std::invalid_argument("convert: unsupported target type " + std::string(dtype_to_str(dst_type)));
+    }
+}
+} // namespace llaisys::utils
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <type_traits>
+
+namespace llaisys::utils {
+// Bulk conversions between F32, F16 and BF16 in host memory.
+// They pick AVX2 / F16C / AVX512-BF16 code at runtime when the CPU has it and
+// round to nearest even, like cast<>(); the AVX512-BF16 path flushes denormals.
+void bf16_to_f32(float *dst, const bf16_t *src, size_t n);
+void f32_to_bf16(bf16_t *dst, const float *src, size_t n);
+void f16_to_f32(float *dst, const fp16_t *src, size_t n);
+void f32_to_f16(fp16_t *dst, const float *src, size_t n);
+
+// Converts n elements between any two of F32/F16/BF16 (same type is a copy).
+void convert(void *dst, llaisysDataType_t dst_type, const void *src, llaisysDataType_t src_type, size_t n);
+
+// Returns n elements of src (stored as `type`) as floats: src itself when it is
+// already F32, otherwise converted into buf.
+inline const float *as_f32(const std::byte *src, llaisysDataType_t type, float *buf, size_t n) {
+    if (type == LLAISYS_DTYPE_F32) {
+        return reinterpret_cast<const float *>(src);
+    }
+    convert(buf, LLAISYS_DTYPE_F32, src, type, n);
+    return buf;
+}
+
+// Row helpers for kernels templated on the element type.
+template <typename T>
+void to_f32(float *dst, const T *src, size_t n) {
+    if constexpr (std::is_same_v<T, bf16_t>) {
+        bf16_to_f32(dst, src, n);
+    } else if constexpr (std::is_same_v<T, fp16_t>) {
+        f16_to_f32(dst, src, n);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = static_cast<float>(src[i]);
+        }
+    }
+}
+
+template <typename T>
+void from_f32(T *dst, const float *src, size_t n) {
+    if constexpr (std::is_same_v<T, bf16_t>) {
+        f32_to_bf16(dst, src, n);
+    } else if constexpr (std::is_same_v<T, fp16_t>) {
+        f32_to_f16(dst, src, n);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = static_cast<T>(src[i]);
+        }
+    }
+}
+// Strided variants: element i lives at src[i * stride] / dst[i * stride].
+template <typename T>
+void to_f32(float *dst, const T *src, size_t n, ptrdiff_t stride) {
+    if (stride == 1) {
+        return to_f32(dst, src, n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = cast<float>(src[i * stride]);
+    }
+}
+
+template <typename T>
+void from_f32(T *dst, const float *src, size_t n, ptrdiff_t stride) {
+    if (stride == 1) {
+        return from_f32(dst, src, n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        dst[i * stride] = cast<T>(src[i]);
+    }
+}
+} // namespace llaisys::utils
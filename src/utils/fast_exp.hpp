@@ -0,0 +1,62 @@
+#pragma once
+
+// simd.hpp pulls in immintrin.h, so include this header ahead of any llaisys header.
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace llaisys::utils {
+// exp(x) 的多项式近似（Cephes expf）：x = n * ln2 + r, |r| <= ln2 / 2,
+// exp(r) 用 5 阶多项式，再把 n 加到指数位上。相对误差约 2 ulp。
+// 输入先钳到 [-87.3, 88.0]，保证 2^n 是规格化数，SiLU / softmax 在两端仍然正确。
+constexpr float EXP_HI = 88.0f;
+constexpr float EXP_LO = -87.3365447504f;
+constexpr float LOG2E = 1.44269504088896341f;
+constexpr float LN2_HI = 0.693359375f;
+constexpr float LN2_LO = -2.12194440e-4f;
+constexpr float EXP_P0 = 1.9875691500E-4f;
+constexpr float EXP_P1 = 1.3981999507E-3f;
+constexpr float EXP_P2 = 8.3334519073E-3f;
+constexpr float EXP_P3 = 4.1665795894E-2f;
+constexpr float EXP_P4 = 1.6666665459E-1f;
+constexpr float EXP_P5 = 5.0000001201E-1f;
+
+inline float fast_exp(float x) {
+    x = std::min(std::max(x, EXP_LO), EXP_HI);
+    float n = std::nearbyint(x * LOG2E);
+    float r = x - n * LN2_HI - n * LN2_LO;
+    float p = EXP_P0;
+    p = p * r + EXP_P1;
+    p = p * r + EXP_P2;
+    p = p * r + EXP_P3;
+    p = p * r + EXP_P4;
+    p = p * r + EXP_P5;
+    p = p * r * r + r + 1.0f;
+    int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+#ifdef LLAISYS_X86_SIMD
+LLAISYS_AVX2_FMA inline __m256 fast_exp(__m256 x) {
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(EXP_LO)), _mm256_set1_ps(EXP_HI));
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_HI), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_LO), r);
+    __m256 p = _mm256_set1_ps(EXP_P0);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P1));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P2));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P3));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P4));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P5));
+    p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+    __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+}
+#endif
+
+} // namespace llaisys::utils
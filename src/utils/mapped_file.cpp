@@ -0,0 +1,115 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace llaisys::utils {
+MappedFile::MappedFile(std::string path, int fd, std::byte *data, size_t size)
+    : _path(std::move(path)), _fd(fd), _data(data), _size(size), _unlink_on_close(false) {}
+
+#if !defined(_WIN32)
+static std::byte *map_fd(int fd, size_t size, bool writable) {
+    if (size == 0) {
+        return nullptr;
+    }
+    int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void *addr = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("MappedFile: mmap failed");
+    }
+    return static_cast<std::byte *>(addr);
+}
+
+std::unique_ptr<MappedFile> MappedFile::create(const std::string &path, size_t size) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("MappedFile: cannot create " + path);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("MappedFile: cannot resize " + path);
+    }
+    return std::unique_ptr<MappedFile>(new MappedFile(path, fd, map_fd(fd, size, true), size));
+}
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string &path, bool writable) {
+    int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("MappedFile: cannot stat " + path);
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    return std::unique_ptr<MappedFile>(new MappedFile(path, fd, map_fd(fd, size, writable), size));
+}
+
+MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+        ::munmap(_data, _size);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+    if (_unlink_on_close) {
+        ::unlink(_path.c_str());
+    }
+}
+
+void MappedFile::flushAsync() {
+    if (_data != nullptr) {
+        ::msync(_data, _size, MS_ASYNC);
+    }
+}
+
+void MappedFile::prefetchAsync() {
+    if (_data != nullptr) {
+        ::madvise(_data, _size, MADV_WILLNEED);
+    }
+}
+
+void MappedFile::populate() {
+    if (_data == nullptr) {
+        return;
+    }
+#if !defined(MADV_POPULATE_READ)
+#define MADV_POPULATE_READ 22 // Linux 5.14
+#endif
+    if (::madvise(_data, _size, MADV_POPULATE_READ) == 0) {
+        return;
+    }
+    // Older kernels: touch one byte per page
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    volatile unsigned char sink = 0;
+    for (size_t i = 0; i < _size; i += page) {
+        sink ^= static_cast<unsigned char>(_data[i]);
+    }
+    (void)sink;
+}
+#else
+std::unique_ptr<MappedFile> MappedFile::create(const std::string &, size_t) {
+    throw std::runtime_error("MappedFile: not supported on this platform");
+}
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string &, bool) {
+    throw std::runtime_error("MappedFile: not supported on this platform");
+}
+
+MappedFile::~MappedFile() {}
+
+void MappedFile::flushAsync() {}
+
+void MappedFile::prefetchAsync() {}
+
+void MappedFile::populate() {}
+#endif
+} // namespace llaisys::utils
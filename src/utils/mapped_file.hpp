@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace llaisys::utils {
+// RAII wrapper around a memory-mapped file (POSIX mmap).
+class MappedFile {
+private:
+    std::string _path;
+    int _fd;
+    std::byte *_data;
+    size_t _size;
+    bool _unlink_on_close;
+    MappedFile(std::string path, int fd, std::byte *data, size_t size);
+
+public:
+    // Creates (or truncates) a file of `size` bytes and maps it read-write.
+    static std::unique_ptr<MappedFile> create(const std::string &path, size_t size);
+    // Maps an existing file, read-only unless `writable` is set.
+    static std::unique_ptr<MappedFile> open(const std::string &path, bool writable = false);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    std::byte *data() const { return _data; }
+    size_t size() const { return _size; }
+    const std::string &path() const { return _path; }
+
+    // Starts writeback of dirty pages without waiting for it.
+    void flushAsync();
+    // Asks the kernel to start reading the whole file in (MADV_WILLNEED) without waiting for it.
+    void prefetchAsync();
+    // Reads the whole file in and maps every page before returning. Only read-faults, so a
+    // read-only mapping keeps sharing the page cache (MAP_POPULATE would not on a writable one).
+    void populate();
+    // Removes the file from disk once it is unmapped.
+    void unlinkOnClose() { _unlink_on_close = true; }
+};
+} // namespace llaisys::utils
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace llaisys::utils {
+// Per-thread free list of fixed-size blocks. Blocks come from ::operator new and are kept
+// for reuse when freed (up to MAX_CACHED per thread), so a steady churn of same-sized
+// objects stops reaching malloc. A block may be freed on another thread than the one that
+// allocated it; it simply joins that thread's list.
+template <size_t Size>
+class BlockPool {
+private:
+    static constexpr size_t MAX_CACHED = 4096;
+
+    struct Node {
+        Node *next;
+    };
+    struct List {
+        Node *head = nullptr;
+        size_t cached = 0;
+        ~List() {
+            while (head) {
+                Node *next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+            alive() = false;
+        }
+    };
+    static List &list() {
+        thread_local List instance;
+        return instance;
+    }
+    // Trivially destructible, so still readable once the thread's List is gone.
+    static bool &alive() {
+        thread_local bool instance = true;
+        return instance;
+    }
+
+public:
+    static_assert(Size >= sizeof(Node), "BlockPool: block too small");
+
+    static void *allocate() {
+        if (alive()) {
+            List &l = list();
+            if (l.head) {
+                Node *node = l.head;
+                l.head = node->next;
+                l.cached--;
+                return node;
+            }
+        }
+        return ::operator new(Size);
+    }
+
+    static void deallocate(void *p) {
+        if (!alive() || list().cached >= MAX_CACHED) {
+            return ::operator delete(p);
+        }
+        List &l = list();
+        auto *node = static_cast<Node *>(p);
+        node->next = l.head;
+        l.head = node;
+        l.cached++;
+    }
+};
+
+// Standard allocator over BlockPool, for std::allocate_shared of small hot objects.
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "PoolAllocator: over-aligned type");
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    T *allocate(size_t n) {
+        if (n != 1) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(BlockPool<sizeof(T)>::allocate());
+    }
+
+    void deallocate(T *p, size_t n) {
+        if (n != 1) {
+            return ::operator delete(p);
+        }
+        BlockPool<sizeof(T)>::deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &) const { return false; }
+};
+} // namespace llaisys::utils
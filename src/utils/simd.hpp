@@ -0,0 +1,21 @@
+#pragma once
+
+// immintrin.h must come before llaisys.h: its intrinsics use `__C` as a parameter name,
+// so include this header ahead of any llaisys header.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LLAISYS_X86_SIMD
+#include <immintrin.h>
+// AVX2/FMA variants are compiled with this attribute and chosen at run time with
+// has_avx2_fma(), so the library runs on any x86-64 CPU whatever -march it was built with.
+#define LLAISYS_AVX2_FMA __attribute__((target("avx2,fma")))
+#endif
+
+namespace llaisys::utils {
+#ifdef LLAISYS_X86_SIMD
+// Checked once
+inline bool has_avx2_fma() {
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+#endif
+} // namespace llaisys::utils
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llaisys::utils {
+// Fixed-capacity array stored inline, with the part of the std::vector interface that tensor
+// shapes and strides use. Copying one never touches the heap.
+template <typename T, size_t N>
+class SmallVector {
+private:
+    T _data[N];
+    size_t _size;
+
+    void check_size_(size_t n) const {
+        if (n > N) {
+            throw std::length_error("SmallVector: size " + std::to_string(n) + " exceeds capacity "
+                                    + std::to_string(N));
+        }
+    }
+
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    SmallVector() : _data{}, _size(0) {}
+    explicit SmallVector(size_t n, const T &value = T()) : _data{}, _size(n) {
+        check_size_(n);
+        std::fill(_data, _data + n, value);
+    }
+    SmallVector(std::initializer_list<T> init) : SmallVector(init.begin(), init.end()) {}
+    SmallVector(const std::vector<T> &v) : SmallVector(v.begin(), v.end()) {}
+    template <typename It, typename = decltype(*std::declval<It>())>
+    SmallVector(It first, It last) : _data{}, _size(static_cast<size_t>(std::distance(first, last))) {
+        check_size_(_size);
+        std::copy(first, last, _data);
+    }
+
+    operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    T &operator[](size_t i) { return _data[i]; }
+    const T &operator[](size_t i) const { return _data[i]; }
+    T *data() { return _data; }
+    const T *data() const { return _data; }
+    T &front() { return _data[0]; }
+    const T &front() const { return _data[0]; }
+    T &back() { return _data[_size - 1]; }
+    const T &back() const { return _data[_size - 1]; }
+
+    iterator begin() { return _data; }
+    iterator end() { return _data + _size; }
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    void resize(size_t n, const T &value = T()) {
+        check_size_(n);
+        if (n > _size) {
+            std::fill(_data + _size, _data + n, value);
+        }
+        _size = n;
+    }
+    void assign(size_t n, const T &value) {
+        check_size_(n);
+        std::fill(_data, _data + n, value);
+        _size = n;
+    }
+    void push_back(const T &value) {
+        check_size_(_size + 1);
+        _data[_size++] = value;
+    }
+    void pop_back() { --_size; }
+    iterator erase(iterator pos) {
+        std::move(pos + 1, end(), pos);
+        --_size;
+        return pos;
+    }
+    void clear() { _size = 0; }
+
+    bool operator==(const SmallVector &other) const {
+        return _size == other._size && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(const SmallVector &other) const { return !(*this == other); }
+};
+} // namespace llaisys::utils
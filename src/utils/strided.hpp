@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../tensor/tensor_meta.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace llaisys::utils {
+
+// N same-shape tensors walked as runs along the innermost dimension. Size-1 dims are
+// dropped and adjacent dims that are contiguous in every tensor are merged, so
+// contiguous tensors collapse into a single run with unit inner strides.
+template <size_t N>
+struct StridedRuns {
+    tensor_shape_t outer;                                                // outer dims, outermost first
+    SmallVector<std::array<ptrdiff_t, N>, TENSOR_MAX_NDIM> outer_strides; // per tensor, in elements
+    size_t inner = 1;                                    // run length
+    std::array<ptrdiff_t, N> inner_strides{};            // per tensor, in elements
+
+    size_t count() const {
+        size_t n = 1;
+        for (size_t d : outer) {
+            n *= d;
+        }
+        return n;
+    }
+
+    // Element offsets of run `r` in every tensor
+    std::array<ptrdiff_t, N> offsets(size_t r) const {
+        std::array<ptrdiff_t, N> off{};
+        for (size_t d = outer.size(); d-- > 0;) {
+            size_t i = r % outer[d];
+            r /= outer[d];
+            for (size_t t = 0; t < N; ++t) {
+                off[t] += static_cast<ptrdiff_t>(i) * outer_strides[d][t];
+            }
+        }
+        return off;
+    }
+
+    bool unit_inner() const {
+        for (size_t t = 0; t < N; ++t) {
+            if (inner_strides[t] != 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template <size_t N>
+StridedRuns<N> strided_runs(const tensor_shape_t &shape, const std::array<const tensor_strides_t *, N> &strides) {
+    StridedRuns<N> runs;
+    tensor_shape_t dims;
+    SmallVector<std::array<ptrdiff_t, N>, TENSOR_MAX_NDIM> dim_strides;
+    for (size_t i = 0; i < shape.size(); ++i) {
+        if (shape[i] == 1) {
+            continue;
+        }
+        std::array<ptrdiff_t, N> s;
+        for (size_t t = 0; t < N; ++t) {
+            s[t] = (*strides[t])[i];
+        }
+        bool merge = !dims.empty();
+        for (size_t t = 0; merge && t < N; ++t) {
+            merge = dim_strides.back()[t] == s[t] * static_cast<ptrdiff_t>(shape[i]);
+        }
+        if (merge) {
+            dims.back() *= shape[i];
+            dim_strides.back() = s;
+        } else {
+            dims.push_back(shape[i]);
+            dim_strides.push_back(s);
+        }
+    }
+    if (dims.empty()) {
+        runs.inner_strides.fill(1);
+        return runs;
+    }
+    runs.inner = dims.back();
+    runs.inner_strides = dim_strides.back();
+    dims.pop_back();
+    dim_strides.pop_back();
+    runs.outer = dims;
+    runs.outer_strides = dim_strides;
+    return runs;
+}
+
+} // namespace llaisys::utils
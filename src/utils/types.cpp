@@ -52,11 +52,23 @@ fp16_t _f32_to_f16(float val) {
         // Infinity
         return fp16_t{static_cast<uint16_t>(sign | 0x7C00)};
     } else if (exponent >= -14) { // Normalized case
-        return fp16_t{(uint16_t)(sign | ((exponent + 15) << 10) | (mantissa >> 13))};
-    } else if (exponent >= -24) {
+        // Round to nearest even; a carry out of the mantissa correctly bumps the exponent (up to Inf)
+        uint32_t h = ((exponent + 15) << 10) | (mantissa >> 13);
+        uint32_t rem = mantissa & 0x1FFF;
+        if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) {
+            h++;
+        }
+        return fp16_t{(uint16_t)(sign | h)};
+    } else if (exponent >= -25) {
         mantissa |= 0x800000; // Add implicit leading 1
-        mantissa >>= (-14 - exponent);
-        return fp16_t{(uint16_t)(sign | (mantissa >> 13))};
+        int32_t shift = -1 - exponent; // 13 + (-14 - exponent)
+        uint32_t h = mantissa >> shift;
+        uint32_t rem = mantissa & ((1u << shift) - 1);
+        uint32_t half = 1u << (shift - 1);
+        if (rem > half || (rem == half && (h & 1))) {
+            h++;
+        }
+        return fp16_t{(uint16_t)(sign | h)};
     } else {
         // Too small for subnormal: return signed zero
         return fp16_t{(uint16_t)sign};
@@ -75,6 +87,11 @@ bf16_t _f32_to_bf16(float val) {
     uint32_t bits32;
     std::memcpy(&bits32, &val, sizeof(bits32));
 
+    // NaN: keep it a (quiet) NaN, rounding could carry it into Inf
+    if ((bits32 & 0x7FFFFFFF) > 0x7F800000) {
+        return bf16_t{static_cast<uint16_t>((bits32 >> 16) | 0x0040)};
+    }
+
     const uint32_t rounding_bias = 0x00007FFF + // 0111 1111 1111 1111
                                    ((bits32 >> 16) & 1);
 
@@ -38,6 +38,33 @@ def test_op_add(
         )
 
 
+def test_op_add_strided(
+    shape,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+):
+    print(f"   shape {shape} dtype <{dtype_name}> (permuted / sliced inputs)")
+    # a is a transposed view, b a column slice of a wider tensor
+    a, a_ = random_tensor(shape[::-1], dtype_name, device_name)
+    a, a_ = a.permute(1, 0), a_.permute(1, 0)
+    b, b_ = random_tensor((shape[0], shape[1] + 2), dtype_name, device_name)
+    b, b_ = b[:, 1 : shape[1] + 1], b_.slice(1, 1, shape[1] + 1)
+
+    c, c_ = random_tensor(shape, dtype_name, device_name)
+    torch_add(c, a, b)
+    llaisys.Ops.add(c_, a_, b_)
+    assert check_equal(c_, c, atol=atol, rtol=rtol)
+
+    # Strided output
+    c, c_ = random_tensor(shape[::-1], dtype_name, device_name)
+    c, c_ = c.permute(1, 0), c_.permute(1, 0)
+    torch_add(c, a, b)
+    llaisys.Ops.add(c_, a_, b_)
+    assert check_equal(c_, c, atol=atol, rtol=rtol)
+
+
 if __name__ == "__main__":
     import argparse
 
@@ -56,5 +83,6 @@ if __name__ == "__main__":
     for shape in testShapes:
         for dtype_name, atol, rtol in testDtypePrec:
             test_op_add(shape, dtype_name, atol, rtol, args.device, args.profile)
+            test_op_add_strided(shape, dtype_name, atol, rtol, args.device)
 
     print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,75 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark
+
+
+def torch_add_rms_norm(ans, res, a, b, w, eps):
+    torch.add(a, b, out=res)
+    torch.pow(res, 2, out=ans)
+    mean = torch.mean(ans, dim=-1, keepdim=True)
+    mean.add_(eps)
+    torch.rsqrt(mean, out=mean)
+    torch.mul(res, mean, out=ans)
+    ans.mul_(w)
+
+
+def test_op_add_rms_norm(
+    shape,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   shape {shape} dtype <{dtype_name}>")
+    a, a_ = random_tensor(shape, dtype_name, device_name)
+    b, b_ = random_tensor(shape, dtype_name, device_name)
+    w, w_ = random_tensor((shape[1], ), dtype_name, device_name)
+    eps = 1e-5
+
+    c, c_ = random_tensor(shape, dtype_name, device_name)
+    res, res_ = random_tensor(shape, dtype_name, device_name)
+    torch_add_rms_norm(c, res, a, b, w, eps)
+    llaisys.Ops.add_rms_norm(c_, res_, a_, b_, w_, eps)
+
+    assert check_equal(res_, res, atol=atol, rtol=rtol)
+    assert check_equal(c_, c, atol=atol, rtol=rtol)
+
+    # In-place residual update: a += b
+    llaisys.Ops.add_rms_norm(c_, a_, a_, b_, w_, eps)
+    assert check_equal(a_, res, atol=atol, rtol=rtol)
+    assert check_equal(c_, c, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_add_rms_norm(c, res, a, b, w, eps),
+            lambda: llaisys.Ops.add_rms_norm(c_, res_, a_, b_, w_, eps),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [(1, 4), (512, 4096)]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-5, 1e-5),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.add_rms_norm on {args.device}")
+    for shape in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_add_rms_norm(shape, dtype_name, atol, rtol, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
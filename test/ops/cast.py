@@ -0,0 +1,56 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark
+
+
+def torch_cast(ans, x):
+    ans.copy_(x.to(ans.dtype))
+
+
+def test_op_cast(
+    shape,
+    src_dtype_name="f32",
+    dst_dtype_name="bf16",
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   shape {shape} <{src_dtype_name}> -> <{dst_dtype_name}>")
+    # Values spread over several binades so rounding is exercised
+    x, x_ = random_tensor(shape, src_dtype_name, device_name, scale=200, bias=-100)
+
+    y, y_ = random_tensor(shape, dst_dtype_name, device_name)
+    torch_cast(y, x)
+    llaisys.Ops.cast(y_, x_)
+
+    # Both sides round to nearest even, so the results must be identical
+    assert check_equal(y_, y, strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch_cast(y, x),
+            lambda: llaisys.Ops.cast(y_, x_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [(2, 3), (512, 4096)]
+    testDtypes = ["f32", "f16", "bf16"]
+    print(f"Testing Ops.cast on {args.device}")
+    for shape in testShapes:
+        for src in testDtypes:
+            for dst in testDtypes:
+                test_op_cast(shape, src, dst, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -1,5 +1,6 @@
 import sys
 import os
+import subprocess
 
 parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
 sys.path.insert(0, parent_dir)
@@ -35,6 +36,25 @@ def test_op_embedding(
         )
 
 
+def test_op_embedding_out_of_range(bad_index, vocab, device_name="cpu"):
+    # The op throws, and an exception cannot cross the C API, so the call runs in a child
+    # process that must die with the error message.
+    print(f"   index {bad_index} vocab {vocab}")
+    code = f"""
+import sys
+sys.path.insert(0, {parent_dir!r})
+import llaisys
+from test_utils import random_int_tensor, random_tensor
+embd, embd_ = random_tensor(({vocab}, 8), "f32", {device_name!r})
+idx, idx_ = random_int_tensor((3,), {device_name!r}, low={bad_index}, high={bad_index + 1})
+out, out_ = random_tensor((3, 8), "f32", {device_name!r})
+llaisys.Ops.embedding(out_, idx_, embd_)
+"""
+    result = subprocess.run([sys.executable, "-c", code], capture_output=True, text=True)
+    assert result.returncode != 0, "out-of-range index accepted"
+    assert "out of range" in result.stderr, result.stderr
+
+
 if __name__ == "__main__":
     import argparse
 
@@ -59,4 +79,8 @@ if __name__ == "__main__":
                 idx_shape, embd_shape, dtype_name, args.device, args.profile
             )
 
+    print(f"Testing Ops.embedding rejects out-of-range ids on {args.device}")
+    for bad_index, vocab in [(16, 16), (1000, 16), (-1, 16)]:
+        test_op_embedding_out_of_range(bad_index, vocab, args.device)
+
     print("\033[92mTest passed!\033[0m\n")
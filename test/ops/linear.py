@@ -22,17 +22,20 @@ def test_op_linear(
     rtol=1e-5,
     device_name="cpu",
     profile=False,
+    w_dtype_name=None,
 ):
-    print(f"   out {out_shape}, x {x_shape}, w {w_shape}, bias {use_bias}, dtype <{dtype_name}>")
+    # w_dtype_name: weight/bias dtype when it differs from the activations
+    w_dtype_name = w_dtype_name or dtype_name
+    print(f"   out {out_shape}, x {x_shape}, w {w_shape}, bias {use_bias}, dtype <{dtype_name}>, weight <{w_dtype_name}>")
     x, x_ = random_tensor(x_shape, dtype_name, device_name, scale=0.1)
-    w, w_ = random_tensor(w_shape, dtype_name, device_name, scale=0.01)
+    w, w_ = random_tensor(w_shape, w_dtype_name, device_name, scale=0.01)
 
     bias, bias_ = None, None
     if use_bias:
-        bias, bias_ = random_tensor((w_shape[0],), dtype_name, device_name)
+        bias, bias_ = random_tensor((w_shape[0],), w_dtype_name, device_name)
 
     out, out_ = random_tensor(out_shape, dtype_name, device_name)
-    torch_linear(out, x, w, bias)
+    torch_linear(out, x, w.to(x.dtype), bias.to(x.dtype) if use_bias else None)
     llaisys.Ops.linear(out_, x_, w_, bias_)
 
     assert check_equal(out_, out, atol=atol, rtol=rtol)
@@ -67,4 +70,22 @@ if __name__ == "__main__":
         for dtype_name, atol, rtol in testDtypePrec:
             test_op_linear(*shapes, dtype_name, atol, rtol, args.device, args.profile)
 
+    # Row-strided input and output: column slices of wider tensors
+    for dtype_name, atol, rtol in testDtypePrec:
+        print(f"   strided rows, dtype <{dtype_name}>")
+        x, x_ = random_tensor((5, 12), dtype_name, args.device, scale=0.1)
+        x, x_ = x[:, 4:8], x_.slice(1, 4, 8)
+        w, w_ = random_tensor((3, 4), dtype_name, args.device, scale=0.01)
+        bias, bias_ = random_tensor((3,), dtype_name, args.device)
+        out, out_ = random_tensor((5, 6), dtype_name, args.device)
+        out, out_ = out[:, 3:], out_.slice(1, 3, 6)
+        torch_linear(out, x, w, bias)
+        llaisys.Ops.linear(out_, x_, w_, bias_)
+        assert check_equal(out_, out, atol=atol, rtol=rtol)
+
+    # f32 activations over half-precision weights (Qwen2 fp32 residual mode)
+    for shapes in testShapes:
+        for w_dtype_name in ["f16", "bf16"]:
+            test_op_linear(*shapes, "f32", 1e-5, 1e-5, args.device, w_dtype_name=w_dtype_name)
+
     print("\033[92mTest passed!\033[0m\n")
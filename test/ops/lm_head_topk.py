@@ -0,0 +1,80 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark, zero_tensor
+
+
+def torch_lm_head_topk(out_idx, out_val, lse, hidden, weight):
+    logits = hidden.float() @ weight.float().T
+    torch.topk(logits, out_idx.shape[-1], dim=-1, out=(out_val, out_idx))
+    torch.logsumexp(logits, dim=-1, out=lse)
+
+
+def test_op_lm_head_topk(
+    hidden_shape,
+    vocab,
+    k,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   hidden {hidden_shape}, vocab {vocab}, k {k}, dtype <{dtype_name}>")
+    M, K = hidden_shape
+    hidden, hidden_ = random_tensor(hidden_shape, dtype_name, device_name, scale=0.1)
+    weight, weight_ = random_tensor((vocab, K), dtype_name, device_name, scale=0.1)
+
+    out_idx, out_idx_ = zero_tensor((M, k), "i64", device_name)
+    out_val, out_val_ = zero_tensor((M, k), "f32", device_name)
+    lse, lse_ = zero_tensor((M,), "f32", device_name)
+
+    torch_lm_head_topk(out_idx, out_val, lse, hidden, weight)
+    llaisys.Ops.lm_head_topk(out_idx_, out_val_, lse_, hidden_, weight_)
+
+    # Values are compared rather than indices: near-ties may order differently
+    assert check_equal(out_val_, out_val, atol=atol, rtol=rtol)
+    assert check_equal(lse_, lse, atol=atol, rtol=rtol)
+
+    # Without lse only the selection runs
+    llaisys.Ops.lm_head_topk(out_idx_, out_val_, None, hidden_, weight_)
+    assert check_equal(out_val_, out_val, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_lm_head_topk(out_idx, out_val, lse, hidden, weight),
+            lambda: llaisys.Ops.lm_head_topk(out_idx_, out_val_, None, hidden_, weight_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        ((1, 4), 8, 1),
+        ((1, 1536), 151936, 1),
+        ((3, 1536), 10000, 8),
+    ]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-4, 1e-4),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.lm_head_topk on {args.device}")
+    for hidden_shape, vocab, k in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_lm_head_topk(
+                hidden_shape, vocab, k, dtype_name, atol, rtol, args.device, args.profile
+            )
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -24,14 +24,17 @@ def test_op_rms_norm(
     rtol=1e-5,
     device_name="cpu",
     profile=False,
+    w_dtype_name=None,
 ):
-    print(f"   shape {shape} dtype <{dtype_name}>")
+    # w_dtype_name: weight dtype when it differs from the input/output
+    w_dtype_name = w_dtype_name or dtype_name
+    print(f"   shape {shape} dtype <{dtype_name}> weight <{w_dtype_name}>")
     x, x_ = random_tensor(shape, dtype_name, device_name)
-    w, w_ = random_tensor((shape[1], ), dtype_name, device_name)
+    w, w_ = random_tensor((shape[1], ), w_dtype_name, device_name)
     eps = 1e-5
 
     c, c_ = random_tensor(shape, dtype_name, device_name)
-    torch_rms_norm(c, x, w, eps)
+    torch_rms_norm(c, x, w.to(x.dtype), eps)
     llaisys.Ops.rms_norm(c_, x_, w_, eps)
 
     assert check_equal(c_, c, atol=atol, rtol=rtol)
@@ -63,4 +66,9 @@ if __name__ == "__main__":
         for dtype_name, atol, rtol in testDtypePrec:
             test_op_rms_norm(shape, dtype_name, atol, rtol, args.device, args.profile)
 
+    # f32 input/output with a half-precision weight (Qwen2 fp32 residual mode)
+    for shape in testShapes:
+        for w_dtype_name in ["f16", "bf16"]:
+            test_op_rms_norm(shape, "f32", 1e-5, 1e-5, args.device, w_dtype_name=w_dtype_name)
+
     print("\033[92mTest passed!\033[0m\n")
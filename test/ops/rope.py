@@ -5,7 +5,7 @@ parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
 sys.path.insert(0, parent_dir)
 import llaisys
 import torch
-from test_utils import arrange_tensor, random_tensor, check_equal, benchmark
+from test_utils import arrange_tensor, random_tensor, zero_tensor, check_equal, benchmark
 
 
 def torch_rope(y: torch.Tensor, x: torch.Tensor, pos_ids: torch.Tensor, theta: float):
@@ -59,6 +59,71 @@ def test_op_rope(
         )
 
 
+def test_op_rope_strided(
+    shape,
+    start_end,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+):
+    # Reads heads out of a wider fused buffer and writes into a head-major cache slot
+    print(f"   shape {shape} range {start_end} dtype <{dtype_name}> (strided)")
+    L, H, D = shape
+    fused, fused_ = random_tensor((L, H + 2, D), dtype_name, device_name)
+    x, x_ = fused[:, 1 : H + 1], fused_.slice(1, 1, H + 1)
+    pos_ids, pos_ids_ = arrange_tensor(start_end[0], start_end[1], device_name)
+    theta = 10000.0
+    _, cos_ = zero_tensor((start_end[1], D // 2), "f32", device_name)
+    _, sin_ = zero_tensor((start_end[1], D // 2), "f32", device_name)
+    llaisys.Ops.rope_table(cos_, sin_, theta)
+
+    for name, run in [
+        ("rope", lambda y_: llaisys.Ops.rope(y_, x_, pos_ids_, theta)),
+        ("rope_cached", lambda y_: llaisys.Ops.rope_cached(y_, x_, pos_ids_, cos_, sin_)),
+    ]:
+        cache, cache_ = random_tensor((H, L + 3, D), dtype_name, device_name)
+        y, y_ = cache.permute(1, 0, 2)[1 : L + 1], cache_.permute(1, 0, 2).slice(0, 1, L + 1)
+        torch_rope(y, x, pos_ids, theta)
+        run(y_)
+        assert check_equal(y_, y, atol=atol, rtol=rtol), name
+
+
+def test_op_rope_table(
+    shape,
+    start_end,
+    npos,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+):
+    # The cached path the model uses: tables of `npos` rows, read at positions [start, end)
+    print(f"   shape {shape} range {start_end} table {npos} dtype <{dtype_name}>")
+    theta = 10000.0
+    half = shape[2] // 2
+    cos, cos_ = zero_tensor((npos, half), "f32", device_name)
+    sin, sin_ = zero_tensor((npos, half), "f32", device_name)
+    llaisys.Ops.rope_table(cos_, sin_, theta)
+    i = torch.arange(0, half, dtype=torch.float64)
+    angles = torch.arange(0, npos, dtype=torch.float64).unsqueeze(1) / (theta ** (2 * i / shape[2]))
+    cos[:] = angles.cos().to(torch.float32)
+    sin[:] = angles.sin().to(torch.float32)
+    assert check_equal(cos_, cos, atol=1e-6, rtol=1e-6)
+    assert check_equal(sin_, sin, atol=1e-6, rtol=1e-6)
+
+    x, x_ = random_tensor(shape, dtype_name, device_name)
+    pos_ids, pos_ids_ = arrange_tensor(start_end[0], start_end[1], device_name)
+    y, y_ = random_tensor(shape, dtype_name, device_name)
+    # Reference from the float64 angles: float32 angles drift at positions this large
+    c, s = angles[pos_ids].cos().unsqueeze(1), angles[pos_ids].sin().unsqueeze(1)
+    x_a, x_b = x.double()[..., :half], x.double()[..., half:]
+    y[:] = torch.cat([x_a * c - x_b * s, x_b * c + x_a * s], dim=-1).to(y.dtype)
+    llaisys.Ops.rope_cached(y_, x_, pos_ids_, cos_, sin_)
+
+    assert check_equal(y_, y, atol=atol, rtol=rtol)
+
+
 if __name__ == "__main__":
     import argparse
 
@@ -80,4 +145,21 @@ if __name__ == "__main__":
         for dtype_name, atol, rtol in testDtypePrec:
             test_op_rope(shape, start_end, dtype_name, atol, rtol, args.device, args.profile)
 
+    testStridedShapes = [((2, 1, 4), (0, 2)), ((7, 4, 64), (5, 12))]
+    print(f"Testing Ops.rope on strided tensors on {args.device}")
+    for shape, start_end in testStridedShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_rope_strided(shape, start_end, dtype_name, atol, rtol, args.device)
+
+    # Positions past the model's first 256-row table, as after it has grown
+    testTableShapes = [
+        ((2, 1, 4), (0, 2), 2),
+        ((64, 4, 128), (300, 364), 512),
+        ((1, 4, 128), (1023, 1024), 1024),
+    ]
+    print(f"Testing Ops.rope_cached on {args.device}")
+    for shape, start_end, npos in testTableShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_rope_table(shape, start_end, npos, dtype_name, atol, rtol, args.device)
+
     print("\033[92mTest passed!\033[0m\n")
@@ -61,6 +61,34 @@ def test_op_self_attention(
         )
 
 
+def test_op_self_attention_head_major(
+    qlen,
+    kvlen,
+    nh,
+    nkvh,
+    hd,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+):
+    # K/V read from the first kvlen positions of head-major [nkvh, maxseq, hd] caches
+    print(
+        f"   qlen={qlen} kvlen={kvlen} nh={nh} nkvh={nkvh} hd={hd} dtype <{dtype_name}> (head-major k/v)"
+    )
+    q, q_ = random_tensor((qlen, nh, hd), dtype_name, device_name)
+    k_cache, k_cache_ = random_tensor((nkvh, kvlen + 5, hd), dtype_name, device_name)
+    v_cache, v_cache_ = random_tensor((nkvh, kvlen + 5, hd), dtype_name, device_name)
+    k, k_ = k_cache.permute(1, 0, 2)[:kvlen], k_cache_.permute(1, 0, 2).slice(0, 0, kvlen)
+    v, v_ = v_cache.permute(1, 0, 2)[:kvlen], v_cache_.permute(1, 0, 2).slice(0, 0, kvlen)
+    scale = 1.0 / (hd**0.5)
+
+    attn_val, attn_val_ = random_tensor((qlen, nh, hd), dtype_name, device_name)
+    torch_self_attention(attn_val, q, k, v, scale)
+    llaisys.Ops.self_attention(attn_val_, q_, k_, v_, scale)
+    assert check_equal(attn_val_, attn_val, atol=atol, rtol=rtol)
+
+
 if __name__ == "__main__":
     import argparse
 
@@ -86,4 +114,9 @@ if __name__ == "__main__":
                 *shape, dtype_name, atol, rtol, args.device, args.profile
             )
 
+    print(f"Testing Ops.self_attention on head-major k/v on {args.device}")
+    for shape in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_self_attention_head_major(*shape, dtype_name, atol, rtol, args.device)
+
     print("\033[92mTest passed!\033[0m\n")
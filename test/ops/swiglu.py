@@ -19,9 +19,11 @@ def test_op_swiglu(
     rtol=1e-5,
     device_name="cpu",
     profile=False,
+    scale=None,
+    bias=None,
 ):
     print(f"   shape {shape} dtype <{dtype_name}>")
-    gate, gate_ = random_tensor(shape, dtype_name, device_name)
+    gate, gate_ = random_tensor(shape, dtype_name, device_name, scale=scale, bias=bias)
     up, up_ = random_tensor(shape, dtype_name, device_name)
 
     out, out_ = random_tensor(shape, dtype_name, device_name)
@@ -30,6 +32,10 @@ def test_op_swiglu(
 
     assert check_equal(out_, out, atol=atol, rtol=rtol)
 
+    # In-place, as used by Qwen2: gate = swiglu(gate, up)
+    llaisys.Ops.swiglu(gate_, gate_, up_)
+    assert check_equal(gate_, out, atol=atol, rtol=rtol)
+
     if profile:
         benchmark(
             lambda: torch_swiglu(out, gate, up),
@@ -38,6 +44,25 @@ def test_op_swiglu(
         )
 
 
+def test_op_swiglu_packed(
+    shape,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+):
+    print(f"   shape {shape} dtype <{dtype_name}> (gate/up halves of one tensor)")
+    gate_up, gate_up_ = random_tensor((shape[0], 2 * shape[1]), dtype_name, device_name)
+    gate, gate_ = gate_up[:, : shape[1]], gate_up_.slice(1, 0, shape[1])
+    up, up_ = gate_up[:, shape[1] :], gate_up_.slice(1, shape[1], 2 * shape[1])
+
+    out, out_ = random_tensor(shape, dtype_name, device_name)
+    torch_swiglu(out, gate, up)
+    llaisys.Ops.swiglu(out_, gate_, up_)
+
+    assert check_equal(out_, out, atol=atol, rtol=rtol)
+
+
 if __name__ == "__main__":
     import argparse
 
@@ -56,5 +81,9 @@ if __name__ == "__main__":
     for shape in testShapes:
         for dtype_name, atol, rtol in testDtypePrec:
             test_op_swiglu(shape, dtype_name, atol, rtol, args.device, args.profile)
+            test_op_swiglu_packed(shape, dtype_name, atol, rtol, args.device)
+
+    # The exp approximation over a wide range of gate values, including saturation
+    test_op_swiglu((64, 8960), "f32", 1e-5, 1e-5, args.device, scale=200, bias=-100)
 
     print("\033[92mTest passed!\033[0m\n")
@@ -10,6 +10,7 @@ import time
 import llaisys
 import sys
 import io
+import ctypes
 
 sys.stdout = io.TextIOWrapper(sys.stdout.buffer, encoding="utf-8")
 
@@ -79,6 +80,125 @@ def llaisys_infer(
     return outputs, tokenizer.decode(outputs, skip_special_tokens=True)
 
 
+def test_decode_allocations(model, tokens, device_name="cpu", steps=8):
+    # After the prefill, decode steps run entirely out of the preplanned workspace
+    api = llaisys.RuntimeAPI(llaisys_device(device_name))
+    lib = llaisys.libllaisys.LIB_LLAISYS
+    buf = (ctypes.c_int64 * len(tokens))(*tokens)
+    next_token = lib.llaisysQwen2ModelInfer(model._model, buf, len(tokens), 0)
+    pos = len(tokens)
+    # Buffers with disjoint lifetimes share the arena
+    planned = model.workspace_stats()
+    assert planned.tokens >= len(tokens)
+    assert 0 < planned.bytes < planned.unplanned_bytes, (
+        f"arena {planned.bytes} bytes, buffers {planned.unplanned_bytes} bytes"
+    )
+
+    before = api.allocator_stats()
+    for _ in range(steps):
+        buf = (ctypes.c_int64 * 1)(next_token)
+        next_token = lib.llaisysQwen2ModelInfer(model._model, buf, 1, pos)
+        pos += 1
+    after = api.allocator_stats()
+
+    assert model.workspace_stats().bytes == planned.bytes
+    assert after.hits == before.hits and after.misses == before.misses, (
+        f"decode allocated: {after.hits - before.hits} hits, {after.misses - before.misses} misses"
+    )
+
+
+def test_decode_graph(model, tokens, steps=8):
+    # Replayed decode steps must produce the same tokens as eager ones
+    lib = llaisys.libllaisys.LIB_LLAISYS
+
+    def decode():
+        buf = (ctypes.c_int64 * len(tokens))(*tokens)
+        out = [lib.llaisysQwen2ModelInfer(model._model, buf, len(tokens), 0)]
+        for pos in range(len(tokens), len(tokens) + steps):
+            buf = (ctypes.c_int64 * 1)(out[-1])
+            out.append(lib.llaisysQwen2ModelInfer(model._model, buf, 1, pos))
+        return out
+
+    model.set_decode_graph(False)
+    eager = decode()
+    model.set_decode_graph(True)
+    before = model.decode_graph_stats()
+    replayed = decode()
+    after = model.decode_graph_stats()
+
+    assert replayed == eager, f"graph {replayed} != eager {eager}"
+    assert after.captures == before.captures + 1 and after.replays == before.replays + steps - 1
+    # q/k/v, the two ropes and gate/up do not depend on each other
+    assert 0 < after.depth < after.nodes, f"depth {after.depth} of {after.nodes} nodes"
+
+
+def test_kv_layouts(model, tokens, steps=8):
+    # A head-major KV cache decodes exactly like the token-major default
+    from llaisys.libllaisys.models import KV_LAYOUT_HEAD_MAJOR, KV_LAYOUT_TOKEN_MAJOR
+
+    lib = llaisys.libllaisys.LIB_LLAISYS
+
+    def decode():
+        buf = (ctypes.c_int64 * len(tokens))(*tokens)
+        out = [lib.llaisysQwen2ModelInfer(model._model, buf, len(tokens), 0)]
+        for pos in range(len(tokens), len(tokens) + steps):
+            buf = (ctypes.c_int64 * 1)(out[-1])
+            out.append(lib.llaisysQwen2ModelInfer(model._model, buf, 1, pos))
+        return out
+
+    token_major = decode()
+    model.set_kv_cache_layout(KV_LAYOUT_HEAD_MAJOR)
+    head_major = decode()
+    model.set_kv_cache_layout(KV_LAYOUT_TOKEN_MAJOR)
+
+    assert head_major == token_major, f"head-major {head_major} != token-major {token_major}"
+
+
+def test_weight_mapping(model, device_name="cpu"):
+    # A checkpoint in the model dtype is bound to the file mapping on CPU, not copied
+    stats = model.load_stats
+    assert stats.mapped + stats.copied > 0
+    if device_name == "cpu":
+        assert stats.copied == 0 and stats.mapped_bytes > 0, (
+            f"{stats.copied} weights ({stats.copied_bytes} bytes) copied"
+        )
+
+
+def test_sessions(model, tokens, steps=8, nsession=3):
+    """Sessions over the shared weights decode concurrently and match the default session."""
+    import threading
+
+    def decode(infer):
+        out = [infer(tokens, 0)]
+        for pos in range(len(tokens), len(tokens) + steps):
+            out.append(infer([out[-1]], pos))
+        return out
+
+    lib = llaisys.libllaisys.LIB_LLAISYS
+
+    def default_infer(toks, pos):
+        buf = (ctypes.c_int64 * len(toks))(*toks)
+        return lib.llaisysQwen2ModelInfer(model._model, buf, len(toks), pos)
+
+    expected = decode(default_infer)
+    sessions = [model.create_session() for _ in range(nsession)]
+    results = [None] * nsession
+
+    def work(i):
+        results[i] = decode(sessions[i].infer)
+
+    threads = [threading.Thread(target=work, args=(i,)) for i in range(nsession)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for s in sessions:
+        s.close()
+
+    for i, out in enumerate(results):
+        assert out == expected, f"session {i}: {out} != {expected}"
+
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser()
     parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
@@ -146,4 +266,9 @@ if __name__ == "__main__":
 
     if args.test:
         assert llaisys_tokens == tokens
+        test_weight_mapping(model, args.device)
+        test_decode_allocations(model, tokens[:8], args.device)
+        test_decode_graph(model, tokens[:8])
+        test_kv_layouts(model, tokens[:8])
+        test_sessions(model, tokens[:8])
         print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,456 @@
+import llaisys
+from llaisys.libllaisys import LIB_LLAISYS
+from llaisys.libllaisys.models import LlaisysSamplingParams, LlaisysWeightLoadStats
+from llaisys.libllaisys.models import WEIGHT_PREFETCH_NONE, WEIGHT_PREFETCH_POPULATE
+from llaisys.libllaisys.models import KV_LAYOUT_HEAD_MAJOR
+import argparse
+import ctypes
+import json
+import os
+import struct
+import tempfile
+import numpy as np
+
+
+# Tiny random Qwen2 checkpoints written from numpy, so these tests need no downloaded model
+
+
+def tiny_config(nlayer=2, hidden=64, nh=4, nkvh=2, inter=96, voc=300, tie=False):
+    return {
+        "num_hidden_layers": nlayer,
+        "intermediate_size": inter,
+        "num_attention_heads": nh,
+        "num_key_value_heads": nkvh,
+        "hidden_size": hidden,
+        "vocab_size": voc,
+        "rms_norm_eps": 1e-6,
+        "rope_theta": 10000.0,
+        "eos_token_id": -1,
+        "tie_word_embeddings": tie,
+    }
+
+
+def random_checkpoint(config, seed=0):
+    rng = np.random.default_rng(seed)
+    di, hs, voc = config["hidden_size"], config["intermediate_size"], config["vocab_size"]
+    dh = di // config["num_attention_heads"]
+    kv = config["num_key_value_heads"] * dh
+
+    def w(*shape, scale=0.1):
+        return (rng.standard_normal(shape) * scale).astype(np.float32)
+
+    tensors = {
+        "model.embed_tokens.weight": w(voc, di, scale=1.0),
+        "model.norm.weight": 1.0 + w(di),
+    }
+    if not config["tie_word_embeddings"]:
+        tensors["lm_head.weight"] = w(voc, di)
+    for i in range(config["num_hidden_layers"]):
+        p = f"model.layers.{i}."
+        tensors.update({
+            p + "input_layernorm.weight": 1.0 + w(di),
+            p + "self_attn.q_proj.weight": w(di, di),
+            p + "self_attn.q_proj.bias": w(di),
+            p + "self_attn.k_proj.weight": w(kv, di),
+            p + "self_attn.k_proj.bias": w(kv),
+            p + "self_attn.v_proj.weight": w(kv, di),
+            p + "self_attn.v_proj.bias": w(kv),
+            p + "self_attn.o_proj.weight": w(di, di),
+            p + "post_attention_layernorm.weight": 1.0 + w(di),
+            p + "mlp.gate_proj.weight": w(hs, di),
+            p + "mlp.up_proj.weight": w(hs, di),
+            p + "mlp.down_proj.weight": w(di, hs),
+        })
+    return tensors
+
+
+def to_bf16_bytes(a):
+    bits = np.ascontiguousarray(a, dtype=np.float32).view(np.uint32)
+    return ((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16).astype(np.uint16).tobytes()
+
+
+def write_safetensors(path, tensors, dtype="BF16"):
+    header, blobs, offset = {"__metadata__": {"format": "pt"}}, [], 0
+    for name, a in tensors.items():
+        data = to_bf16_bytes(a) if dtype == "BF16" else a.astype(np.float32).tobytes()
+        header[name] = {"dtype": dtype, "shape": list(a.shape), "data_offsets": [offset, offset + len(data)]}
+        blobs.append(data)
+        offset += len(data)
+    raw = json.dumps(header).encode()
+    raw += b" " * (-len(raw) % 8)
+    with open(path, "wb") as f:
+        f.write(struct.pack("<Q", len(raw)) + raw + b"".join(blobs))
+
+
+def write_model(model_dir, config, tensors):
+    with open(os.path.join(model_dir, "config.json"), "w") as f:
+        json.dump(config, f)
+    write_safetensors(os.path.join(model_dir, "model.safetensors"), tensors)
+
+
+def load_model(model_dir):
+    return llaisys.models.Qwen2(model_dir, prefetch=WEIGHT_PREFETCH_NONE)
+
+
+def greedy(model, prompt, steps):
+    buf = (ctypes.c_int64 * len(prompt))(*prompt)
+    out = [LIB_LLAISYS.llaisysQwen2ModelInfer(model._model, buf, len(prompt), 0)]
+    for pos in range(len(prompt), len(prompt) + steps - 1):
+        buf = (ctypes.c_int64 * 1)(out[-1])
+        out.append(LIB_LLAISYS.llaisysQwen2ModelInfer(model._model, buf, 1, pos))
+    return out
+
+
+def load_safetensors(model, paths, prefetch=WEIGHT_PREFETCH_NONE):
+    arr = (ctypes.c_char_p * len(paths))(*[str(p).encode() for p in paths])
+    stats = LlaisysWeightLoadStats()
+    ret = LIB_LLAISYS.llaisysQwen2ModelLoadSafetensors(model._model, arr, len(paths), prefetch, ctypes.byref(stats))
+    return ret, stats
+
+
+def test_load_errors(tmp):
+    """Malformed or incomplete checkpoints are rejected with -1 and leave the weights as they were."""
+    config = tiny_config()
+    tensors = random_checkpoint(config)
+    write_model(tmp, config, tensors)
+    model = load_model(tmp)
+    prompt = [3, 14, 15, 92]
+    expected = greedy(model, prompt, 6)
+
+    def raw(name, blob):
+        path = os.path.join(tmp, name)
+        with open(path, "wb") as f:
+            f.write(blob)
+        return path
+
+    def header(entries, data=b""):
+        text = json.dumps(entries).encode()
+        return struct.pack("<Q", len(text)) + text + data
+
+    norm = tensors["model.norm.weight"]
+    cases = {
+        "truncated header": raw("a.safetensors", struct.pack("<Q", 5) + b'{"a":'),
+        "header past the end": raw("b.safetensors", struct.pack("<Q", 1000) + b"{}"),
+        "offsets past the data": raw("c.safetensors", header(
+            {"model.norm.weight": {"dtype": "F32", "shape": list(norm.shape), "data_offsets": [0, norm.nbytes]}},
+            b"\0" * 8)),
+        "size not matching the shape": raw("d.safetensors", header(
+            {"model.norm.weight": {"dtype": "F32", "shape": list(norm.shape), "data_offsets": [0, 8]}},
+            b"\0" * 8)),
+        "unsupported dtype": raw("e.safetensors", header(
+            {"model.norm.weight": {"dtype": "I32", "shape": list(norm.shape), "data_offsets": [0, norm.nbytes]}},
+            b"\0" * norm.nbytes)),
+        "missing file": os.path.join(tmp, "missing.safetensors"),
+    }
+    wrong_shape = dict(tensors)
+    wrong_shape["model.norm.weight"] = np.zeros(norm.size + 1, np.float32)
+    write_safetensors(os.path.join(tmp, "f.safetensors"), wrong_shape)
+    cases["wrong shape"] = os.path.join(tmp, "f.safetensors")
+    missing = {k: v for k, v in random_checkpoint(config, seed=1).items() if "layers.1.mlp.up_proj" not in k}
+    write_safetensors(os.path.join(tmp, "g.safetensors"), missing)
+    cases["missing weight"] = os.path.join(tmp, "g.safetensors")
+
+    for what, path in cases.items():
+        ret, _ = load_safetensors(model, [path])
+        assert ret == -1, f"{what}: loaded"
+        assert greedy(model, prompt, 6) == expected, f"{what}: weights changed"
+
+
+def decode(model, tokens, pos, steps):
+    """Feeds `tokens` at `pos` and greedily decodes `steps` tokens from there."""
+    buf = (ctypes.c_int64 * len(tokens))(*tokens)
+    out = [LIB_LLAISYS.llaisysQwen2ModelInfer(model._model, buf, len(tokens), pos)]
+    pos += len(tokens)
+    for _ in range(steps - 1):
+        buf = (ctypes.c_int64 * 1)(out[-1])
+        out.append(LIB_LLAISYS.llaisysQwen2ModelInfer(model._model, buf, 1, pos))
+        pos += 1
+    return out
+
+
+def test_session_snapshot(tmp):
+    """A saved session resumes exactly where it stopped; other snapshots are rejected with -1."""
+    config = tiny_config()
+    write_model(tmp, config, random_checkpoint(config))
+    prompt = [3, 14, 15, 92, 65]
+    expected = greedy(load_model(tmp), prompt, 10)
+
+    model = load_model(tmp)
+    head = decode(model, prompt, 0, 4)
+    pos = len(prompt) + 3
+    path = os.path.join(tmp, "session.bin")
+    model.save_session(path, pos)
+    del model
+
+    resumed = load_model(tmp)
+    assert resumed.load_session(path) == pos
+    assert head + decode(resumed, [head[-1]], pos, 6) == expected
+
+    other_dir = os.path.join(tmp, "other")
+    os.mkdir(other_dir)
+    other_config = tiny_config(nkvh=4)
+    write_model(other_dir, other_config, random_checkpoint(other_config))
+    other = load_model(other_dir)
+    decode(other, prompt, 0, 1)
+    other_path = os.path.join(tmp, "other.bin")
+    other.save_session(other_path, len(prompt))
+
+    with open(path, "rb") as f:
+        blob = f.read()
+    truncated_path = os.path.join(tmp, "truncated.bin")
+    with open(truncated_path, "wb") as f:
+        f.write(blob[:-1])
+    short_path = os.path.join(tmp, "short.bin")
+    with open(short_path, "wb") as f:
+        f.write(blob[:16])
+
+    for what, bad in [("different meta", other_path), ("truncated", truncated_path),
+                      ("shorter than the header", short_path),
+                      ("missing file", os.path.join(tmp, "missing.bin")), ("directory", other_dir)]:
+        assert resumed.load_session(bad) == -1, f"{what}: loaded"
+
+
+def test_kv_swap(tmp):
+    """Swapping the KV cache out mid-decode and back in resumes the same decode."""
+    config = tiny_config()
+    write_model(tmp, config, random_checkpoint(config))
+    prompt = [3, 14, 15, 92, 65]
+    expected = greedy(load_model(tmp), prompt, 10)
+    dh = config["hidden_size"] // config["num_attention_heads"]
+    pos = len(prompt) + 3
+    nbytes = 2 * config["num_hidden_layers"] * pos * config["num_key_value_heads"] * dh * 2
+
+    # Restored in the background by kv_swap_in, or on demand by the next inference
+    for explicit in (True, False):
+        model = load_model(tmp)
+        head = decode(model, prompt, 0, 4)
+        model.kv_swap_out(os.path.join(tmp, "kv.swap"), pos)
+        stats = model.kv_swap_stats()
+        assert (stats.swap_out_count, stats.swap_out_bytes) == (1, nbytes)
+        assert (stats.swap_in_count, stats.swap_in_bytes) == (0, 0)
+        if explicit:
+            model.kv_swap_in()
+        assert head + decode(model, [head[-1]], pos, 6) == expected
+        stats = model.kv_swap_stats()
+        assert (stats.swap_in_count, stats.swap_in_bytes) == (1, nbytes)
+        assert stats.total_swap_out_ms >= 0 and stats.total_swap_in_ms >= 0
+
+
+def test_kv_layout(tmp):
+    """A head-major KV cache decodes, swaps and snapshots like the token-major default."""
+    config = tiny_config()
+    write_model(tmp, config, random_checkpoint(config))
+    prompt = [3, 14, 15, 92, 65]
+    expected = greedy(load_model(tmp), prompt, 10)
+
+    model = load_model(tmp)
+    model.set_kv_cache_layout(KV_LAYOUT_HEAD_MAJOR)
+    assert greedy(model, prompt, 10) == expected
+
+    head = decode(model, prompt, 0, 4)
+    pos = len(prompt) + 3
+    model.kv_swap_out(os.path.join(tmp, "kv.swap"), pos)
+    model.kv_swap_in()
+    assert head + decode(model, [head[-1]], pos, 6) == expected
+
+    # Snapshots are dense, so they load into either layout
+    decode(model, prompt, 0, 4)
+    path = os.path.join(tmp, "session.bin")
+    model.save_session(path, pos)
+    resumed = load_model(tmp)
+    assert resumed.load_session(path) == pos
+    assert head + decode(resumed, [head[-1]], pos, 6) == expected
+
+
+def round_bf16(a):
+    bits = np.frombuffer(to_bf16_bytes(a), np.uint16).astype(np.uint32) << 16
+    return bits.view(np.float32).reshape(np.shape(a))
+
+
+def test_tied_embeddings(tmp):
+    """With tie_word_embeddings the head reads embed_tokens: one buffer, logits = hidden @ embed.T."""
+    config = tiny_config(nlayer=1, tie=True)
+    tensors = {k: np.zeros_like(v) for k, v in random_checkpoint(config).items()}
+    for k, v in tensors.items():
+        if "layernorm" in k or k == "model.norm.weight":
+            v[:] = 1.0
+    # Rows of different lengths, so the best match of a row is often another, longer one
+    rng = np.random.default_rng(0)
+    embed = rng.standard_normal(tensors["model.embed_tokens.weight"].shape) * rng.uniform(0.5, 2.0, (config["vocab_size"], 1))
+    tensors["model.embed_tokens.weight"] = embed = round_bf16(embed.astype(np.float32))
+    assert "lm_head.weight" not in tensors
+    write_model(tmp, config, tensors)
+    model = load_model(tmp)
+
+    get_data = LIB_LLAISYS.tensorGetData
+    assert model.tie_word_embeddings
+    assert get_data(model._weights.in_embed) == get_data(model._weights.out_embed)
+
+    # The layers add nothing, so the hidden state is the normalized embedding of the fed token
+    hidden = embed / np.sqrt((embed.astype(np.float64) ** 2).mean(-1, keepdims=True) + config["rms_norm_eps"])
+    logits = round_bf16(hidden.astype(np.float32)).astype(np.float64) @ embed.T.astype(np.float64)
+    top2 = np.sort(logits, axis=-1)[:, -2:]
+    clear = np.flatnonzero(top2[:, 1] - top2[:, 0] > 0.05 * np.abs(top2[:, 1]))
+    expected = logits.argmax(-1)
+    assert (expected[clear] != clear).any()
+    for t in clear[:64]:
+        assert greedy(model, [int(t)], 1) == [expected[t]], f"token {t}"
+
+
+def fixed_logits_checkpoint(config, logits):
+    """Weights whose next-token logits are `logits` whatever was fed: the layers add nothing,
+    every token embeds to 8 * e_0, which the final norm keeps (sqrt(hidden) = 8), and the head
+    reads dimension 0. The values are exact in BF16."""
+    tensors = {k: np.zeros_like(v) for k, v in random_checkpoint(config).items()}
+    for k, v in tensors.items():
+        if "layernorm" in k or k == "model.norm.weight":
+            v[:] = 1.0
+    tensors["model.embed_tokens.weight"][:, 0] = 8.0
+    tensors["lm_head.weight"][:, 0] = np.asarray(logits, np.float32) / 8.0
+    return tensors
+
+
+def sample(model, tokens, **kwargs):
+    """Feeds `tokens` from position 0, so they are the whole penalty history, and samples."""
+    params = LlaisysSamplingParams(temperature=1.0, top_k=0, top_p=1.0, repetition_penalty=1.0,
+                                   frequency_penalty=0.0, presence_penalty=0.0)
+    for k, v in kwargs.items():
+        setattr(params, k, v)
+    buf = (ctypes.c_int64 * len(tokens))(*tokens)
+    return LIB_LLAISYS.llaisysQwen2ModelInferSampled(model._model, buf, len(tokens), 0, ctypes.byref(params))
+
+
+def test_sampling(tmp):
+    """Seeded draws repeat, truncation keeps only the allowed tokens, and penalties shift the argmax."""
+    logits = np.array([2.0, 1.0, 0.5, 0.0, -1.0, 3.0, 0.25, -2.0], np.float32)
+    config = tiny_config(nlayer=1, voc=len(logits))
+    write_model(tmp, config, fixed_logits_checkpoint(config, logits))
+    model = load_model(tmp)
+    assert greedy(model, [1], 1) == [5]
+
+    def draws(n, seed=None, **kwargs):
+        if seed is not None:
+            model.set_sampling_seed(seed)
+        return [sample(model, [1], **kwargs) for _ in range(n)]
+
+    # Seeded determinism
+    first = draws(64, seed=7)
+    assert draws(64, seed=7) == first
+    assert draws(64, seed=8) != first
+    assert len(set(first)) > 3
+
+    # top_k=1 (at any temperature) and temperature 0 are the argmax
+    assert set(draws(32, seed=1, top_k=1, temperature=5.0)) == {5}
+    assert set(draws(32, seed=1, temperature=0.0)) == {5}
+
+    # Truncation: top-k keeps the k best, top-p the shortest prefix reaching p
+    probs = np.exp(logits - logits.max())
+    probs /= probs.sum()
+    order = np.argsort(-logits)
+    top2 = draws(400, seed=2, top_k=2)
+    assert set(top2) == {5, 0}
+    share = top2.count(5) / len(top2)
+    expected = probs[5] / (probs[5] + probs[0])
+    assert abs(share - expected) < 0.08, f"top-k share {share:.2f}, expected {expected:.2f}"
+    top_p = float(probs[order[0]] + probs[order[1]] + 0.5 * probs[order[2]])
+    assert set(draws(400, seed=3, top_p=top_p)) == set(order[:3].tolist())
+    assert set(draws(400, seed=4, top_k=2, top_p=top_p)) == {5, 0}
+
+    # Penalties over the fed tokens; the argmax (5, logit 3) competes with 0 (logit 2)
+    assert sample(model, [5], temperature=0.0) == 5
+    assert sample(model, [5], temperature=0.0, repetition_penalty=2.0) == 0  # 3 / 2
+    assert sample(model, [5, 5, 5], temperature=0.0, frequency_penalty=0.4) == 0  # 3 - 3 * 0.4
+    assert sample(model, [5], temperature=0.0, frequency_penalty=0.4) == 5  # 3 - 0.4
+    assert sample(model, [5, 5, 5], temperature=0.0, presence_penalty=0.6) == 5  # 3 - 0.6, once
+    assert sample(model, [5, 5, 5], temperature=0.0, presence_penalty=1.5) == 0  # 3 - 1.5
+    # A negative logit is multiplied: token 4 drops to -1 * 4 - 0.9, behind the untouched 7 (-2);
+    # dividing it would leave it ahead. The others sink under four occurrences each.
+    history = [0, 1, 2, 3, 5, 6] * 4 + [4]
+    assert sample(model, history, temperature=0.0, repetition_penalty=4.0, frequency_penalty=0.9) == 7
+
+    # On a real model, top_k=1 sampling decodes exactly like greedy
+    config = tiny_config()
+    write_model(tmp, config, random_checkpoint(config))
+    model = load_model(tmp)
+    prompt = [3, 14, 15, 92]
+    expected = greedy(model, prompt, 8)
+    params = LlaisysSamplingParams(temperature=0.7, top_k=1, top_p=0.9, repetition_penalty=1.0,
+                                   frequency_penalty=0.0, presence_penalty=0.0)
+    model.set_sampling_seed(0)
+    tokens, pos, out = prompt, 0, []
+    for _ in range(8):
+        buf = (ctypes.c_int64 * len(tokens))(*tokens)
+        out.append(LIB_LLAISYS.llaisysQwen2ModelInferSampled(model._model, buf, len(tokens), pos, ctypes.byref(params)))
+        pos += len(tokens)
+        tokens = [out[-1]]
+    assert out == expected
+
+
+def rss():
+    with open("/proc/self/status") as f:
+        fields = dict(line.split(":", 1) for line in f if line.startswith("Rss"))
+    return {k: int(v.split()[0]) * 1024 for k, v in fields.items()}
+
+
+def file_mappings(path):
+    """(mapped, locked) bytes of this process's mappings of `path`."""
+    mapped = locked = 0
+    ours = False
+    with open("/proc/self/smaps") as f:
+        for line in f:
+            fields = line.split()
+            if "-" in fields[0] and ":" not in fields[0]:
+                ours = fields[-1] == path
+            elif ours and fields[0] == "Size:":
+                mapped += int(fields[1]) * 1024
+            elif ours and fields[0] == "Locked:":
+                locked += int(fields[1]) * 1024
+    return mapped, locked
+
+
+def test_load_memory(tmp):
+    """Populating or locking a mapped checkpoint maps the page cache; it does not copy it."""
+    config = tiny_config(hidden=512, nh=8, nkvh=4, inter=2048, voc=8192)
+    tensors = random_checkpoint(config)
+    path = os.path.join(tmp, "model.safetensors")
+    size = sum(a.size for a in tensors.values()) * 2
+
+    def check(what, before, after):
+        anon = after["RssAnon"] - before["RssAnon"]
+        mapped = after["RssFile"] - before["RssFile"]
+        print(f"   {what}: +{anon >> 10} KB anonymous, +{mapped >> 10} KB file-backed")
+        assert anon < size // 4, f"{what} copied the weights ({anon} anonymous bytes)"
+        assert mapped > size // 2, f"{what} left the weights unmapped ({mapped} bytes)"
+
+    write_model(tmp, config, tensors)
+    model = load_model(tmp)
+    before = rss()
+    ret, stats = load_safetensors(model, [path], WEIGHT_PREFETCH_POPULATE)
+    assert ret == 0 and stats.copied == 0
+    check("populate", before, rss())
+
+    model = load_model(tmp)
+    before = rss()
+    if model.lock_weights():
+        check("lock", before, rss())
+        # A reload locks the new mapping and lets go of the one it replaces
+        mapped, locked = file_mappings(path)
+        ret, stats = load_safetensors(model, [path])
+        assert ret == 0 and stats.mapped > 0
+        assert file_mappings(path) == (mapped, locked), f"{file_mappings(path)} after reload, {(mapped, locked)} before"
+    else:
+        print("   lock: skipped (RLIMIT_MEMLOCK)")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu"], type=str)
+    args = parser.parse_args()
+
+    for test in [test_load_errors, test_load_memory, test_session_snapshot, test_kv_swap, test_kv_layout,
+                 test_tied_embeddings, test_sampling]:
+        print(f"Testing {test.__name__}")
+        with tempfile.TemporaryDirectory() as tmp:
+            test(tmp)
+
+    print("\033[92mTest passed!\033[0m\n")
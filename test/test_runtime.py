@@ -2,6 +2,8 @@ import llaisys
 import torch
 from test_utils import *
 import argparse
+import ctypes
+import threading
 
 
 def test_basic_runtime_api(device_name: str = "cpu"):
@@ -53,10 +55,178 @@ def test_memcpy(api, size_bytes: int):
     torch.testing.assert_close(a, b)
 
 
+def test_caching_allocator(device_name: str = "cpu"):
+    api = llaisys.RuntimeAPI(llaisys_device(device_name))
+    if api.get_device_count() == 0:
+        return
+    print("Testing caching allocator...")
+    device = llaisys_device(device_name)
+
+    # A freed tensor's memory is reused by the next same-sized tensor
+    t = llaisys.Tensor((1024, 1024), device=device)
+    before = api.allocator_stats()
+    del t
+    t = llaisys.Tensor((1024, 1024), device=device)
+    after = api.allocator_stats()
+    assert after.hits == before.hits + 1 and after.misses == before.misses
+    assert after.bytes_reserved == before.bytes_reserved
+    assert after.bytes_in_use >= 1024 * 1024 * 4
+
+    # Freed blocks coalesce back into whole segments, which trim returns
+    small = [llaisys.Tensor((1024,), device=device) for _ in range(64)]
+    held = api.allocator_stats()
+    del small
+    del t
+    api.allocator_trim()
+    trimmed = api.allocator_stats()
+    assert trimmed.segments < held.segments
+    assert trimmed.bytes_reserved < held.bytes_reserved
+
+    print("     Passed")
+
+
+def test_stream_events(device_name: str = "cpu"):
+    api = llaisys.RuntimeAPI(llaisys_device(device_name))
+    if api.get_device_count() == 0:
+        return
+    print("Testing streams and events...")
+    size = 16 * 1024 * 1024
+    a = torch.randint(0, 255, (size,), dtype=torch.uint8)
+    b = torch.zeros_like(a)
+    device_a = api.malloc_device(size)
+    copy_stream = api.create_stream()
+    compute_stream = api.create_stream()
+    event = api.create_event()
+
+    # An event never recorded is complete
+    assert api.event_query(event)
+
+    # H2D on one stream, D2H on another ordered after it through the event
+    api.memcpy_async(device_a, a.data_ptr(), size, llaisys.MemcpyKind.H2D, copy_stream)
+    api.event_record(event, copy_stream)
+    api.stream_wait_event(compute_stream, event)
+    api.memcpy_async(b.data_ptr(), device_a, size, llaisys.MemcpyKind.D2H, compute_stream)
+    api.stream_synchronize(compute_stream)
+    assert api.event_query(event)
+    torch.testing.assert_close(a, b)
+
+    # The event and the pending wait keep the source stream alive after it is destroyed
+    b.zero_()
+    api.memcpy_async(device_a, a.data_ptr(), size, llaisys.MemcpyKind.H2D, copy_stream)
+    api.event_record(event, copy_stream)
+    api.stream_wait_event(compute_stream, event)
+    api.destroy_stream(copy_stream)
+    api.memcpy_async(b.data_ptr(), device_a, size, llaisys.MemcpyKind.D2H, compute_stream)
+    api.event_synchronize(event)
+    api.stream_synchronize(compute_stream)
+    torch.testing.assert_close(a, b)
+
+    api.destroy_event(event)
+    api.destroy_stream(compute_stream)
+
+    # Streams created and destroyed on other threads while device_synchronize waits on them
+    device_b = api.malloc_device(size)
+
+    def churn():
+        for _ in range(50):
+            stream = api.create_stream()
+            api.memcpy_async(device_b, device_a, size, llaisys.MemcpyKind.D2D, stream)
+            api.destroy_stream(stream)
+
+    workers = [threading.Thread(target=churn) for _ in range(4)]
+    for w in workers:
+        w.start()
+    while any(w.is_alive() for w in workers):
+        api.device_synchronize()
+    for w in workers:
+        w.join()
+
+    api.free_device(device_b)
+    api.free_device(device_a)
+    print("     Passed")
+
+
+def test_cpu_memory():
+    api = llaisys.RuntimeAPI(llaisys.DeviceType.CPU)
+    print("Testing CPU memory report and locking...")
+    size = 8 << 20
+    base = api.cpu_memory_report()
+    ptr = api.malloc_device(size)
+    # Blocks of 2 MB or more are mapped 2 MB aligned, so they can sit on huge pages
+    assert ptr % (2 << 20) == 0
+    ctypes.memset(ptr, 1, size)
+    report = api.cpu_memory_report()
+    assert report.mapped_bytes == base.mapped_bytes + size
+    assert report.huge_page_bytes <= report.mapped_bytes
+    print(f"     {report.huge_page_bytes >> 20} of {report.mapped_bytes >> 20} MB on huge pages")
+
+    if api.lock_memory(ptr, size):
+        locked = api.cpu_memory_report().locked_bytes
+        assert locked >= base.locked_bytes + size
+        # Locks nest: the overlapping inner lock keeps its 1 MB pinned after the outer unlock
+        assert api.lock_memory(ptr + (1 << 20), 1 << 20)
+        api.unlock_memory(ptr, size)
+        assert api.cpu_memory_report().locked_bytes == locked - size + (1 << 20)
+        api.unlock_memory(ptr + (1 << 20), 1 << 20)
+        assert api.cpu_memory_report().locked_bytes == locked - size
+    else:
+        print("     lock: skipped (RLIMIT_MEMLOCK)")
+
+    api.free_device(ptr)
+    assert api.cpu_memory_report().mapped_bytes == base.mapped_bytes
+    print("     Passed")
+
+
+def test_numa_report():
+    api = llaisys.RuntimeAPI(llaisys.DeviceType.CPU)
+    print("Testing NUMA report...")
+    t = llaisys.Tensor((1024, 1024), device=llaisys.DeviceType.CPU)
+    data = torch.ones((1024, 1024), dtype=torch.float32)
+    t.load(data.data_ptr())  # touch the pages so they are resident somewhere
+    nodes = api.numa_report()
+    # One CPU device per NUMA node, each with CPUs to run on
+    assert len(nodes) == api.get_device_count()
+    assert all(n.ncpu > 0 and n.mem_total_bytes > 0 for n in nodes)
+    assert sum(n.resident_bytes for n in nodes) >= 1024 * 1024 * 4
+    del t
+    print("     Passed")
+
+
+def test_thread_pool():
+    api = llaisys.RuntimeAPI(llaisys.DeviceType.CPU)
+    print("Testing thread pool...")
+    default = api.num_threads()
+    x = torch.rand((16, 512), dtype=torch.float32)
+    w = torch.rand((4096, 512), dtype=torch.float32) - 0.5
+    b = torch.rand((4096,), dtype=torch.float32)
+    expected = torch.nn.functional.linear(x, w, b)
+    x_, w_, b_ = (llaisys.Tensor(t.shape, device=llaisys.DeviceType.CPU) for t in (x, w, b))
+    for src, dst in ((x, x_), (w, w_), (b, b_)):
+        dst.load(src.data_ptr())
+    # More threads than CPUs still splits the rows correctly, whoever steals them
+    for n in (1, 3, 8):
+        api.set_thread_pool(n)
+        assert api.num_threads() == n
+        out = torch.empty((16, 4096), dtype=torch.float32)
+        out_ = llaisys.Tensor(out.shape, device=llaisys.DeviceType.CPU)
+        llaisys.Ops.linear(out_, x_, w_, b_)
+        api.memcpy_sync(out.data_ptr(), out_.data_ptr(), out.numel() * 4, llaisys.MemcpyKind.D2H)
+        assert torch.allclose(out, expected, atol=1e-4, rtol=1e-4)
+    api.set_thread_pool(0)
+    assert api.num_threads() == default
+    print("     Passed")
+
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser()
     parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
     args = parser.parse_args()
     test_basic_runtime_api(args.device)
+    test_caching_allocator(args.device)
+    test_stream_events(args.device)
+    if args.device == "cpu":
+        test_cpu_memory()
+        test_numa_report()
+        test_thread_pool()
     
     print("\033[92mTest passed!\033[0m\n")
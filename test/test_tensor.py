@@ -48,6 +48,31 @@ def test_tensor():
     assert llaisys_tensor.is_contiguous() == torch_tensor.is_contiguous()
     assert check_equal(llaisys_tensor_slice, torch_tensor_slice)
 
+    # Test contiguous
+    print("===Test contiguous===")
+    torch_tensor_cont = torch_tensor_perm.contiguous()
+    llaisys_tensor_cont = llaisys_tensor_perm.contiguous()
+    assert llaisys_tensor_cont.is_contiguous()
+    assert llaisys_tensor_cont.strides() == torch_tensor_cont.stride()
+    assert check_equal(llaisys_tensor_cont, torch_tensor_cont)
+    # Already contiguous: a view of the same storage
+    assert llaisys_tensor.contiguous().data_ptr() == llaisys_tensor.data_ptr()
+
+    # Test reshape
+    print("===Test reshape===")
+    # Splitting a dim of a slice only needs new strides
+    torch_tensor_rs = torch_tensor.permute(1, 0, 2).reshape(2, 2, 3, 5)
+    llaisys_tensor_rs = llaisys_tensor.permute(1, 0, 2).reshape(2, 2, 3, 5)
+    assert llaisys_tensor_rs.shape() == torch_tensor_rs.shape
+    assert llaisys_tensor_rs.strides() == torch_tensor_rs.stride()
+    assert llaisys_tensor_rs.data_ptr() == llaisys_tensor.data_ptr()
+    assert check_equal(llaisys_tensor_rs, torch_tensor_rs)
+    # Merging permuted dims needs a copy
+    torch_tensor_rs = torch_tensor_perm.reshape(5, 12)
+    llaisys_tensor_rs = llaisys_tensor_perm.reshape(5, 12)
+    assert llaisys_tensor_rs.is_contiguous()
+    assert check_equal(llaisys_tensor_rs, torch_tensor_rs)
+
 
 if __name__ == "__main__":
     test_tensor()
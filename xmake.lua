@@ -100,6 +100,9 @@ target("llaisys")
     add_deps("llaisys-models")
 
     add_files("src/llaisys/*.cc")
+    if not is_plat("windows") then
+        add_syslinks("pthread")
+    end
     
     -- 指定安装目录到 build/install，防止权限报错
     set_installdir("build/install")
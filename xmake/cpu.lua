@@ -1,3 +1,9 @@
+option("cpu-native")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Compile CPU kernels with -march=native (the built library then needs this CPU); their AVX2/FMA paths are picked at run time either way")
+option_end()
+
 target("llaisys-device-cpu")
     set_kind("static")
     set_languages("cxx17")
@@ -20,6 +26,9 @@ target("llaisys-ops-cpu")
         add_cxflags("-fPIC", "-Wno-unknown-pragmas")
     end
 
+    if has_config("cpu-native") and not is_plat("windows") then
+        add_cxflags("-march=native")
+    end
     add_files("../src/ops/*/cpu/*.cpp")
 
     on_install(function (target) end)